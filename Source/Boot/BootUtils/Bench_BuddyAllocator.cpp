@@ -0,0 +1,111 @@
+//! @file BootUtils/Bench_BuddyAllocator.cpp
+//! @brief The definition of benchmarks for the BuddyAllocator class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <benchmark/benchmark.h>
+
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "BuddyAllocator.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A buddy allocator initialised from a simulated 64 MB memory map.
+struct BuddyFixture
+{
+    TargetMemoryMap TargetMemory;
+    MemMapEntry Entries[8];
+    MemoryMap Map;
+    BuddyAllocator Allocator;
+
+    BuddyFixture() :
+        TargetMemory(64),
+        Entries {
+            { 0x00, 0x9F000, MemType::UsableRAM, { 0 } },
+            { 0x9F000, 0x1000, MemType::Reserved, { 0 } },
+            { 0x100000, 0x3F00000, MemType::UsableRAM, { 0 } },
+        }
+    {
+        Map.initialise(Entries, 3, std::size(Entries));
+        Allocator.initialise(Map);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Measures allocating and immediately freeing a block of a fixed
+//! order, the worst case for splitting and coalescing.
+void allocateAndFree(benchmark::State &state)
+{
+    BuddyFixture fixture;
+    uint32_t order = static_cast<uint32_t>(state.range(0));
+    uint64_t address = 0;
+
+    for (auto _ : state)
+    {
+        fixture.Allocator.allocate(order, address);
+        fixture.Allocator.free(address, order);
+        benchmark::DoNotOptimize(address);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+//! @brief Measures a mixed sequence of allocations and frees of random
+//! orders, keeping a working set of blocks allocated.
+void randomWorkload(benchmark::State &state)
+{
+    BuddyFixture fixture;
+    std::mt19937 random(0xB0D1E5);
+    std::vector<uint64_t> addresses(1024, UINT64_MAX);
+    std::vector<uint32_t> orders(addresses.size(), 0);
+
+    for (auto _ : state)
+    {
+        size_t slot = random() % addresses.size();
+
+        if (addresses[slot] == UINT64_MAX)
+        {
+            orders[slot] = random() % 6;
+
+            if (fixture.Allocator.allocate(orders[slot], addresses[slot]) == false)
+            {
+                addresses[slot] = UINT64_MAX;
+            }
+        }
+        else
+        {
+            fixture.Allocator.free(addresses[slot], orders[slot]);
+            addresses[slot] = UINT64_MAX;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // Anonymous namespace
+
+BENCHMARK(allocateAndFree)->Arg(0)->Arg(4)->Arg(10);
+BENCHMARK(randomWorkload);
+
+////////////////////////////////////////////////////////////////////////////////
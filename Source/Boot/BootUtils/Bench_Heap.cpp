@@ -0,0 +1,169 @@
+//! @file BootUtils/Bench_Heap.cpp
+//! @brief The definition of benchmarks comparing the Heap class with the
+//! host run-time library.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+#include "Bench_Workloads.hpp"
+#include "Heap.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "SlabPool.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A heap initialised from a simulated 64 MB memory map with a
+//! general purpose pool of 16 MB.
+struct HeapFixture
+{
+    TargetMemoryMap TargetMemory;
+    MemMapEntry Entries[8];
+    MemoryMap Map;
+    Heap Allocator;
+
+    HeapFixture() :
+        TargetMemory(64),
+        Entries {
+            { 0x00, 0x9F000, MemType::UsableRAM, { 0 } },
+            { 0x9F000, 0x1000, MemType::Reserved, { 0 } },
+            { 0x100000, 0x3F00000, MemType::UsableRAM, { 0 } },
+        }
+    {
+        Map.initialise(Entries, 3, std::size(Entries));
+        Allocator.initialise(Map);
+        Allocator.createPool(0x1000000);
+    }
+};
+
+//! @brief Replays traces through the general purpose pool of the heap.
+struct PoolReplay
+{
+    Heap &Target;
+
+    PoolReplay(Heap &heap) : Target(heap) { }
+
+    void *allocate(size_t size) { return Target.allocateBlock(size); }
+    void free(void *block, size_t) { Target.freeBlock(block); }
+};
+
+//! @brief Replays traces through size classes layered on the heap.
+struct SizeClassReplay
+{
+    SizeClassAllocator Classes;
+
+    SizeClassReplay(Heap &heap) { Classes.initialise(heap); }
+
+    void *allocate(size_t size) { return Classes.allocate(size); }
+    void free(void *block, size_t size) { Classes.free(block, size); }
+};
+
+//! @brief Replays traces through the host run-time library as a baseline.
+struct MallocReplay
+{
+    MallocReplay(Heap &) { }
+
+    void *allocate(size_t size) { return std::malloc(size); }
+    void free(void *block, size_t) { std::free(block); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Replays an allocation trace once.
+template<typename TReplay>
+void replayTrace(TReplay &replay, const std::vector<AllocationStep> &trace,
+                 std::vector<void *> &slots, std::vector<uint32_t> &sizes)
+{
+    for (const AllocationStep &step : trace)
+    {
+        if (step.Size == 0)
+        {
+            replay.free(slots[step.Slot], sizes[step.Slot]);
+            slots[step.Slot] = nullptr;
+        }
+        else
+        {
+            slots[step.Slot] = replay.allocate(step.Size);
+            sizes[step.Slot] = step.Size;
+            benchmark::DoNotOptimize(slots[step.Slot]);
+        }
+    }
+}
+
+//! @brief Measures bump allocation from the heap arena, releasing
+//! everything to a marker after each batch.
+//! @details The argument is the largest block to allocate.
+void arenaAllocate(benchmark::State &state)
+{
+    HeapFixture fixture;
+    std::vector<AllocationStep> trace =
+        createAllocationTrace(1024, 1024, 8, static_cast<uint32_t>(state.range(0)));
+    Heap::Marker start = fixture.Allocator.mark();
+    size_t allocations = 0;
+
+    for (auto _ : state)
+    {
+        for (const AllocationStep &step : trace)
+        {
+            if (step.Size != 0)
+            {
+                benchmark::DoNotOptimize(fixture.Allocator.allocate(step.Size));
+                ++allocations;
+            }
+        }
+
+        fixture.Allocator.release(start);
+    }
+
+    state.SetItemsProcessed(allocations);
+}
+
+//! @brief Measures replaying an allocation trace through an allocator.
+//! @details Arguments are the smallest and largest block to allocate.
+template<typename TReplay>
+void allocationTrace(benchmark::State &state)
+{
+    HeapFixture fixture;
+    std::vector<AllocationStep> trace =
+        createAllocationTrace(16384, 256, static_cast<uint32_t>(state.range(0)),
+                              static_cast<uint32_t>(state.range(1)));
+    std::vector<void *> slots(256, nullptr);
+    std::vector<uint32_t> sizes(slots.size(), 0);
+    TReplay replay(fixture.Allocator);
+
+    for (auto _ : state)
+    {
+        replayTrace(replay, trace, slots, sizes);
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+} // Anonymous namespace
+
+BENCHMARK(arenaAllocate)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(allocationTrace, PoolReplay)->Args({ 8, 128 })->Args({ 16, 4096 });
+BENCHMARK_TEMPLATE(allocationTrace, SizeClassReplay)->Args({ 8, 128 })->Args({ 16, 4096 });
+BENCHMARK_TEMPLATE(allocationTrace, MallocReplay)->Args({ 8, 128 })->Args({ 16, 4096 });
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,118 @@
+//! @file BootUtils/Bench_MemoryMap.cpp
+//! @brief The definition of benchmarks for the MemoryMap class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Bench_Workloads.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+//! @brief The size of the simulated physical memory.
+constexpr size_t RamSizeInMb = 64;
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Measures consolidating a raw memory map, including the cost of
+//! copying the raw entries before each pass.
+//! @details Arguments are the layout of the map and the count of entries.
+void initialiseMemoryMap(benchmark::State &state)
+{
+    TargetMemoryMap targetMemory(RamSizeInMb);
+    MapLayout layout = static_cast<MapLayout>(state.range(0));
+    size_t count = static_cast<size_t>(state.range(1));
+    std::vector<MemMapEntry> source = createMemoryMap(layout, count,
+                                                      static_cast<uint64_t>(RamSizeInMb) << 20);
+
+    // Ensure there is usable RAM to fall back on for scratch space.
+    source.push_back({ 0x00, 0x9F000, MemType::UsableRAM, { 0 } });
+
+    std::vector<MemMapEntry> entries(source.size() * 2);
+    MemoryMap memoryMap;
+
+    for (auto _ : state)
+    {
+        std::copy(source.begin(), source.end(), entries.begin());
+
+        if (memoryMap.initialise(entries.data(), source.size(), entries.size()) == false)
+        {
+            state.SkipWithError("Failed to initialise memory map.");
+            break;
+        }
+
+        benchmark::DoNotOptimize(memoryMap.getRegionCount());
+    }
+
+    state.SetLabel(getLayoutName(layout));
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+
+//! @brief Measures looking up the region containing random addresses.
+//! @details The argument is the count of entries in the map.
+void findRegion(benchmark::State &state)
+{
+    TargetMemoryMap targetMemory(RamSizeInMb);
+    size_t count = static_cast<size_t>(state.range(0));
+    std::vector<MemMapEntry> entries = createMemoryMap(MapLayout::Random, count,
+                                                       static_cast<uint64_t>(RamSizeInMb) << 20);
+    entries.resize(count * 2);
+
+    MemoryMap memoryMap;
+    uint64_t address = 0;
+
+    if (memoryMap.initialise(entries.data(), count, entries.size()) == false)
+    {
+        state.SkipWithError("Failed to initialise memory map.");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        // Step through memory with a stride co-prime to the region size.
+        address = (address + 0x12345) % (static_cast<uint64_t>(RamSizeInMb) << 20);
+        benchmark::DoNotOptimize(memoryMap.findRegion(address));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+//! @brief Generates the arguments for each combination of layout and size.
+void applyLayouts(benchmark::internal::Benchmark *benchmark)
+{
+    for (MapLayout layout : { MapLayout::Random, MapLayout::Sorted,
+                              MapLayout::Reversed, MapLayout::Overlapping })
+    {
+        for (int64_t count : { 8, 64, 1024 })
+        {
+            benchmark->Args({ static_cast<int64_t>(layout), count });
+        }
+    }
+}
+
+} // Anonymous namespace
+
+BENCHMARK(initialiseMemoryMap)->Apply(applyLayouts);
+BENCHMARK(findRegion)->Arg(8)->Arg(64)->Arg(1024);
+
+////////////////////////////////////////////////////////////////////////////////
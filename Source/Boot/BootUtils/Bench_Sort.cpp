@@ -0,0 +1,111 @@
+//! @file BootUtils/Bench_Sort.cpp
+//! @brief The definition of benchmarks comparing Collection::sort() with the
+//! standard library.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Bench_Workloads.hpp"
+#include "CollectionTools.hpp"
+#include "Loader.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Orders memory map entries by base address, then size.
+struct EntryComparer
+{
+    int operator()(const MemMapEntry &lhs, const MemMapEntry &rhs) const
+    {
+        if (lhs.BaseAddress != rhs.BaseAddress)
+            return (lhs.BaseAddress < rhs.BaseAddress) ? -1 : 1;
+
+        if (lhs.Size != rhs.Size)
+            return (lhs.Size < rhs.Size) ? -1 : 1;
+
+        return 0;
+    }
+};
+
+//! @brief Sorts entries using the boot-time merge sort.
+struct BootSort
+{
+    static void sort(std::vector<MemMapEntry> &entries)
+    {
+        Collection::sort(entries.data(), entries.size(), EntryComparer());
+    }
+};
+
+//! @brief Sorts entries using the standard library as a baseline.
+struct StdStableSort
+{
+    static void sort(std::vector<MemMapEntry> &entries)
+    {
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const MemMapEntry &lhs, const MemMapEntry &rhs) {
+                             return EntryComparer()(lhs, rhs) < 0;
+                         });
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Measures sorting a memory map, including the cost of copying the
+//! unsorted entries before each sort.
+//! @details Arguments are the layout of the map and the count of entries.
+template<typename TSorter>
+void sortMemoryMap(benchmark::State &state)
+{
+    MapLayout layout = static_cast<MapLayout>(state.range(0));
+    size_t count = static_cast<size_t>(state.range(1));
+    const std::vector<MemMapEntry> source = createMemoryMap(layout, count, 1ull << 32);
+    std::vector<MemMapEntry> entries;
+
+    for (auto _ : state)
+    {
+        entries = source;
+        TSorter::sort(entries);
+        benchmark::DoNotOptimize(entries.data());
+    }
+
+    state.SetLabel(getLayoutName(layout));
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * sizeof(MemMapEntry));
+}
+
+//! @brief Generates the arguments for each combination of layout and size.
+void applyLayouts(benchmark::internal::Benchmark *benchmark)
+{
+    for (MapLayout layout : { MapLayout::Random, MapLayout::Sorted,
+                              MapLayout::Reversed, MapLayout::Overlapping })
+    {
+        for (int64_t count : { 16, 256, 4096 })
+        {
+            benchmark->Args({ static_cast<int64_t>(layout), count });
+        }
+    }
+}
+
+} // Anonymous namespace
+
+BENCHMARK_TEMPLATE(sortMemoryMap, BootSort)->Apply(applyLayouts);
+BENCHMARK_TEMPLATE(sortMemoryMap, StdStableSort)->Apply(applyLayouts);
+
+////////////////////////////////////////////////////////////////////////////////
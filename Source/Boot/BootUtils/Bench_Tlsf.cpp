@@ -0,0 +1,122 @@
+//! @file BootUtils/Bench_Tlsf.cpp
+//! @brief The definition of benchmarks for the Tlsf class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Tlsf.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A TLSF allocator managing a 16 MB pool.
+struct TlsfFixture
+{
+    std::vector<uint64_t> Memory;
+    Tlsf *Allocator;
+
+    TlsfFixture() :
+        Memory(0x200000),
+        Allocator(Tlsf::create(Memory.data(), Memory.size() * sizeof(uint64_t)))
+    {
+    }
+};
+
+//! @brief Forwards allocations to the host run-time library for comparison.
+struct HostAllocator
+{
+    static void *allocate(void *, size_t size) { return std::malloc(size); }
+    static void free(void *, void *block) { std::free(block); }
+};
+
+//! @brief Forwards allocations to a TLSF allocator.
+struct TlsfAllocator
+{
+    static void *allocate(void *context, size_t size)
+    {
+        return static_cast<Tlsf *>(context)->allocate(size);
+    }
+
+    static void free(void *context, void *block)
+    {
+        static_cast<Tlsf *>(context)->free(block);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Measures allocating and immediately freeing a block of fixed size.
+template<typename TAllocator>
+void allocateAndFree(benchmark::State &state)
+{
+    TlsfFixture fixture;
+    size_t size = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        void *block = TAllocator::allocate(fixture.Allocator, size);
+        benchmark::DoNotOptimize(block);
+        TAllocator::free(fixture.Allocator, block);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+//! @brief Measures a mixed sequence of allocations and frees of random
+//! sizes, keeping a working set of blocks allocated.
+template<typename TAllocator>
+void randomWorkload(benchmark::State &state)
+{
+    TlsfFixture fixture;
+    std::mt19937 random(0x7151F);
+    std::vector<void *> blocks(1024, nullptr);
+
+    for (auto _ : state)
+    {
+        size_t slot = random() % blocks.size();
+
+        if (blocks[slot] == nullptr)
+        {
+            blocks[slot] = TAllocator::allocate(fixture.Allocator, 16 + (random() % 4096));
+        }
+        else
+        {
+            TAllocator::free(fixture.Allocator, blocks[slot]);
+            blocks[slot] = nullptr;
+        }
+    }
+
+    for (void *block : blocks)
+    {
+        TAllocator::free(fixture.Allocator, block);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // Anonymous namespace
+
+BENCHMARK_TEMPLATE(allocateAndFree, TlsfAllocator)->Arg(24)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(allocateAndFree, HostAllocator)->Arg(24)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(randomWorkload, TlsfAllocator);
+BENCHMARK_TEMPLATE(randomWorkload, HostAllocator);
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,151 @@
+//! @file BootUtils/Bench_Workloads.cpp
+//! @brief The definition of generators of synthetic workloads shared by
+//! BootUtils benchmarks.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <iterator>
+#include <random>
+
+#include "Bench_Workloads.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+//! @brief The seed used for all workloads so that runs are comparable.
+constexpr uint32_t WorkloadSeed = 0xE820;
+
+//! @brief The memory types scattered through generated maps.
+const MemType RegionTypes[] = {
+    MemType::UsableRAM, MemType::UsableRAM, MemType::UsableRAM,
+    MemType::Reserved, MemType::AcpiReclaimable, MemType::AcpiNvs,
+    MemType::BadMemory,
+};
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Gets a label describing a memory map layout.
+const char *getLayoutName(MapLayout layout)
+{
+    switch (layout)
+    {
+    case MapLayout::Random: return "random";
+    case MapLayout::Sorted: return "sorted";
+    case MapLayout::Reversed: return "reversed";
+    case MapLayout::Overlapping: return "overlapping";
+    }
+
+    return "unknown";
+}
+
+//! @brief Generates an E820-style memory map.
+//! @param[in] layout The order and overlap of the entries.
+//! @param[in] count The count of entries to generate.
+//! @param[in] ramSize The count of bytes of physical memory the entries
+//! should describe.
+//! @return The generated entries.
+std::vector<MemMapEntry> createMemoryMap(MapLayout layout, size_t count,
+                                         uint64_t ramSize)
+{
+    std::mt19937_64 random(WorkloadSeed);
+    std::vector<MemMapEntry> entries(count);
+    uint64_t regionSize = (ramSize / count) & ~static_cast<uint64_t>(0xFFF);
+
+    if (regionSize == 0)
+    {
+        regionSize = 0x1000;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        MemMapEntry &entry = entries[i];
+
+        entry.Type = RegionTypes[random() % std::size(RegionTypes)];
+        entry.Padding[0] = entry.Padding[1] = entry.Padding[2] = 0;
+
+        if (layout == MapLayout::Overlapping)
+        {
+            // Pick regions of up to 16 slots anywhere in memory.
+            entry.BaseAddress = (random() % count) * regionSize;
+            entry.Size = (1 + (random() % 16)) * regionSize;
+        }
+        else
+        {
+            entry.BaseAddress = i * regionSize;
+            entry.Size = regionSize;
+        }
+    }
+
+    if (layout == MapLayout::Random)
+    {
+        std::shuffle(entries.begin(), entries.end(), random);
+    }
+    else if (layout == MapLayout::Reversed)
+    {
+        std::reverse(entries.begin(), entries.end());
+    }
+
+    return entries;
+}
+
+//! @brief Generates a trace of interleaved allocations and frees.
+//! @param[in] stepCount The count of steps in the trace.
+//! @param[in] slotCount The count of blocks which can be live at once.
+//! @param[in] minSize The smallest block to allocate.
+//! @param[in] maxSize The largest block to allocate.
+//! @return The generated trace, which frees every block it allocates.
+std::vector<AllocationStep> createAllocationTrace(size_t stepCount, size_t slotCount,
+                                                  uint32_t minSize, uint32_t maxSize)
+{
+    std::mt19937 random(WorkloadSeed);
+    std::vector<bool> isLive(slotCount, false);
+    std::vector<AllocationStep> trace;
+
+    trace.reserve(stepCount + slotCount);
+
+    for (size_t i = 0; i < stepCount; ++i)
+    {
+        uint32_t slot = static_cast<uint32_t>(random() % slotCount);
+
+        if (isLive[slot])
+        {
+            trace.push_back({ slot, 0 });
+        }
+        else
+        {
+            uint32_t size = minSize + static_cast<uint32_t>(random() % (maxSize - minSize + 1));
+            trace.push_back({ slot, size });
+        }
+
+        isLive[slot] = !isLive[slot];
+    }
+
+    // Free anything left so that the trace can be repeated.
+    for (uint32_t slot = 0; slot < slotCount; ++slot)
+    {
+        if (isLive[slot])
+        {
+            trace.push_back({ slot, 0 });
+        }
+    }
+
+    return trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
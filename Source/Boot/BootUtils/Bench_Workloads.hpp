@@ -0,0 +1,64 @@
+//! @file BootUtils/Bench_Workloads.hpp
+//! @brief The declaration of generators of synthetic workloads shared by
+//! BootUtils benchmarks.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_BENCH_WORKLOADS_HPP__
+#define __BOOT_UTILS_BENCH_WORKLOADS_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "Loader.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Describes the order of the entries in a generated memory map.
+enum class MapLayout : int64_t
+{
+    //! @brief Disjoint regions in a random order.
+    Random,
+
+    //! @brief Disjoint regions in ascending address order.
+    Sorted,
+
+    //! @brief Disjoint regions in descending address order.
+    Reversed,
+
+    //! @brief Regions of mixed types overlapping each other heavily, as
+    //! produced by firmware which reports the same memory several times.
+    Overlapping,
+};
+
+//! @brief A single step in a trace of allocations and frees.
+struct AllocationStep
+{
+    //! @brief The index of the slot holding the block allocated or freed.
+    uint32_t Slot;
+
+    //! @brief The count of bytes to allocate or 0 to free the block in Slot.
+    uint32_t Size;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+const char *getLayoutName(MapLayout layout);
+std::vector<MemMapEntry> createMemoryMap(MapLayout layout, size_t count,
+                                         uint64_t ramSize);
+std::vector<AllocationStep> createAllocationTrace(size_t stepCount, size_t slotCount,
+                                                  uint32_t minSize, uint32_t maxSize);
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,125 @@
+//! @file BootUtils/BitTools.hpp
+//! @brief The declaration of functions which manipulate individual bits in
+//! machine words.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_BIT_TOOLS_HPP__
+#define __BOOT_UTILS_BIT_TOOLS_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace Bits {
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Gets the index of the least significant set bit in a word.
+//! @param[in] value The word to examine, which must not be 0.
+//! @return The 0-based index of the lowest set bit.
+inline uint32_t countTrailingZeros(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, value);
+
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+//! @brief Gets the index of the least significant set bit in a word.
+//! @param[in] value The word to examine, which must not be 0.
+//! @return The 0-based index of the lowest set bit.
+//! @note On 32-bit targets the word is scanned in halves to avoid calling
+//! run-time library helpers which aren't available to the loader.
+inline uint32_t countTrailingZeros(uint64_t value)
+{
+#if defined(_MSC_VER) || (UINTPTR_MAX == UINT32_MAX)
+    uint32_t lowWord = static_cast<uint32_t>(value);
+
+    return (lowWord != 0) ? countTrailingZeros(lowWord) :
+                            32 + countTrailingZeros(static_cast<uint32_t>(value >> 32));
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+//! @brief Gets the index of the most significant set bit in a word.
+//! @param[in] value The word to examine, which must not be 0.
+//! @return The 0-based index of the highest set bit.
+inline uint32_t getHighestSetBit(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanReverse(&index, value);
+
+    return static_cast<uint32_t>(index);
+#else
+    return 31u - static_cast<uint32_t>(__builtin_clz(value));
+#endif
+}
+
+//! @brief Gets the index of the most significant set bit in a word.
+//! @param[in] value The word to examine, which must not be 0.
+//! @return The 0-based index of the highest set bit.
+inline uint32_t getHighestSetBit(uint64_t value)
+{
+#if defined(_MSC_VER) || (UINTPTR_MAX == UINT32_MAX)
+    uint32_t highWord = static_cast<uint32_t>(value >> 32);
+
+    return (highWord != 0) ? 32 + getHighestSetBit(highWord) :
+                             getHighestSetBit(static_cast<uint32_t>(value));
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+}
+
+//! @brief Counts the set bits in a word.
+//! @param[in] value The word to examine.
+//! @return The count of bits set in \p value.
+//! @note A portable implementation is used so that the result doesn't rely on
+//! instructions or run-time library support the processor may lack.
+inline uint32_t countSetBits(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    value = (value + (value >> 4)) & 0x0F0F0F0Fu;
+
+    return (value * 0x01010101u) >> 24;
+}
+
+//! @brief Counts the set bits in a word.
+//! @param[in] value The word to examine.
+//! @return The count of bits set in \p value.
+inline uint32_t countSetBits(uint64_t value)
+{
+    return countSetBits(static_cast<uint32_t>(value)) +
+           countSetBits(static_cast<uint32_t>(value >> 32));
+}
+
+//! @brief Determines if a value is a non-zero power of 2.
+template<typename T> constexpr bool isPowerOf2(T value)
+{
+    return (value != 0) && ((value & (value - 1)) == 0);
+}
+
+} // namespace Bits
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,400 @@
+//! @file BootUtils/BuddyAllocator.cpp
+//! @brief The definition of an object which allocates physically contiguous
+//! power of 2 sized blocks of memory at boot time.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "BitTools.hpp"
+#include "BuddyAllocator.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+constexpr size_t BitsPerWord = sizeof(uint32_t) * 8;
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// BuddyAllocator Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Constructs an allocator which has no memory to allocate.
+BuddyAllocator::BuddyAllocator() :
+    _freeBits(nullptr),
+    _pageCount(0),
+    _freeSize(0),
+    _nonEmptyOrders(0)
+{
+    for (uint32_t order = 0; order < OrderCount; ++order)
+    {
+        _bitmapOffsets[order] = 0;
+        _freeLists[order] = NoBlock;
+        _freeCounts[order] = 0;
+    }
+}
+
+//! @brief Gets the total count of bytes available for allocation.
+uint64_t BuddyAllocator::getFreeSize() const { return _freeSize; }
+
+//! @brief Gets the count of free blocks of a specific order.
+//! @param[in] order The order of the blocks to count, the block size being
+//! MinBlockSize * 2^order.
+size_t BuddyAllocator::getFreeBlockCount(uint32_t order) const
+{
+    return (order < OrderCount) ? _freeCounts[order] : 0;
+}
+
+//! @brief Calculates the order of the smallest block which can hold a
+//! specified count of bytes.
+//! @param[in] size The count of bytes required.
+//! @param[out] order Receives the order of the block required.
+//! @retval true The order was calculated.
+//! @retval false The size was larger than the biggest block.
+bool BuddyAllocator::getOrderForSize(uint64_t size, uint32_t &order)
+{
+    if (size <= MinBlockSize)
+    {
+        order = 0;
+        return true;
+    }
+
+    uint32_t sizePow2 = Bits::getHighestSetBit(size - 1) + 1;
+
+    if ((sizePow2 - MinBlockSizePow2) >= OrderCount)
+        return false;
+
+    order = sizePow2 - MinBlockSizePow2;
+
+    return true;
+}
+
+//! @brief Divides the addressable usable RAM in a consolidated memory map
+//! into the largest naturally aligned free blocks possible.
+//! @param[in] memoryMap The memory map to take usable RAM from. The memory
+//! used to hold the bitmap of free blocks is reserved within it.
+//! @retval true The allocator was initialised.
+//! @retval false There was no addressable block of usable RAM large enough
+//! to hold the bitmap or the block could not be reserved.
+bool BuddyAllocator::initialise(MemoryMap &memoryMap)
+{
+    const MemMapEntry *regions = memoryMap.getRegions();
+    size_t regionCount = memoryMap.getRegionCount();
+    uint64_t topAddr = 0;
+
+    for (size_t i = 0; i < regionCount; ++i)
+    {
+        if ((regions[i].Type == MemType::UsableRAM) &&
+            memoryMap.isRegionAccessable(i))
+        {
+            uint64_t end = regions[i].BaseAddress + regions[i].Size;
+
+            if (end > topAddr)
+            {
+                topAddr = end;
+            }
+        }
+    }
+
+    size_t pageCount = static_cast<size_t>(topAddr >> MinBlockSizePow2);
+
+    if (pageCount == 0)
+        return false;
+
+    // Lay out a bitmap for each order end-to-end.
+    size_t wordCount = 0;
+
+    for (uint32_t order = 0; order < OrderCount; ++order)
+    {
+        _bitmapOffsets[order] = wordCount;
+        wordCount += ((pageCount >> order) / BitsPerWord) + 1;
+    }
+
+    uint64_t reservedSize = (static_cast<uint64_t>(wordCount) * sizeof(uint32_t) +
+                             MinBlockSize - 1) & ~static_cast<uint64_t>(MinBlockSize - 1);
+    uint64_t bitmapAddr = 0;
+    bool hasLocation = false;
+
+    // Place the bitmap at the top of the highest block of addressable usable
+    // RAM which can hold it, leaving low memory free for legacy devices.
+    for (size_t i = regionCount; (hasLocation == false) && (i > 0); --i)
+    {
+        const MemMapEntry &region = regions[i - 1];
+
+        if ((region.Type != MemType::UsableRAM) ||
+            (memoryMap.isRegionAccessable(i - 1) == false))
+        {
+            continue;
+        }
+
+        uint64_t end = (region.BaseAddress + region.Size) &
+                       ~static_cast<uint64_t>(MinBlockSize - 1);
+
+        if ((end >= reservedSize) && ((end - reservedSize) >= region.BaseAddress))
+        {
+            bitmapAddr = end - reservedSize;
+            hasLocation = true;
+        }
+    }
+
+    if ((hasLocation == false) ||
+        (memoryMap.reserve(bitmapAddr, reservedSize, MemType::UsableAfterBoot) == false))
+    {
+        return false;
+    }
+
+    _freeBits = getAddress<uint32_t>(bitmapAddr);
+    _pageCount = pageCount;
+    _freeSize = 0;
+    _nonEmptyOrders = 0;
+
+    for (size_t i = 0; i < wordCount; ++i)
+    {
+        _freeBits[i] = 0;
+    }
+
+    for (uint32_t order = 0; order < OrderCount; ++order)
+    {
+        _freeLists[order] = NoBlock;
+        _freeCounts[order] = 0;
+    }
+
+    // Split each region of usable RAM into maximal aligned blocks, the map
+    // no longer includes the bitmap itself.
+    regions = memoryMap.getRegions();
+    regionCount = memoryMap.getRegionCount();
+
+    for (size_t i = 0; i < regionCount; ++i)
+    {
+        const MemMapEntry &region = regions[i];
+
+        if ((region.Type != MemType::UsableRAM) ||
+            (memoryMap.isRegionAccessable(i) == false))
+        {
+            continue;
+        }
+
+        size_t page = static_cast<size_t>((region.BaseAddress + MinBlockSize - 1) >>
+                                          MinBlockSizePow2);
+        size_t endPage = static_cast<size_t>((region.BaseAddress + region.Size) >>
+                                             MinBlockSizePow2);
+
+        while (page < endPage)
+        {
+            // The block is limited by the alignment of its start and the
+            // space remaining in the region.
+            uint32_t order = OrderCount - 1;
+
+            if (page != 0)
+            {
+                uint32_t alignment = Bits::countTrailingZeros(static_cast<uint64_t>(page));
+
+                if (alignment < order)
+                {
+                    order = alignment;
+                }
+            }
+
+            uint32_t fit = Bits::getHighestSetBit(static_cast<uint64_t>(endPage - page));
+
+            if (fit < order)
+            {
+                order = fit;
+            }
+
+            free(static_cast<uint64_t>(page) << MinBlockSizePow2, order);
+            page += static_cast<size_t>(1) << order;
+        }
+    }
+
+    return true;
+}
+
+//! @brief Allocates a naturally aligned block of 2^order pages.
+//! @param[in] order The order of the block to allocate.
+//! @param[out] address Receives the physical address of the block.
+//! @retval true The block was allocated.
+//! @retval false No block of the required order or larger was free.
+bool BuddyAllocator::allocate(uint32_t order, uint64_t &address)
+{
+    if (order >= OrderCount)
+        return false;
+
+    // Find the smallest order with a free block which is large enough.
+    uint32_t candidates = _nonEmptyOrders & ~((1u << order) - 1);
+
+    if (candidates == 0)
+        return false;
+
+    uint32_t currentOrder = Bits::countTrailingZeros(candidates);
+    size_t page = _freeLists[currentOrder];
+
+    removeBlock(currentOrder, page);
+
+    // Return the upper halves of the block to the free lists until it is
+    // the size required.
+    while (currentOrder > order)
+    {
+        --currentOrder;
+        pushBlock(currentOrder, page + (static_cast<size_t>(1) << currentOrder));
+    }
+
+    address = static_cast<uint64_t>(page) << MinBlockSizePow2;
+
+    return true;
+}
+
+//! @brief Returns a block to the allocator, merging it with its buddy
+//! where possible.
+//! @param[in] address The physical address of the block.
+//! @param[in] order The order the block was allocated with.
+//! @note Blocks which are misaligned, out of range or already free are
+//! ignored.
+void BuddyAllocator::free(uint64_t address, uint32_t order)
+{
+    uint64_t firstPage = address >> MinBlockSizePow2;
+
+    if ((order >= OrderCount) || (firstPage >= _pageCount))
+        return;
+
+    size_t page = static_cast<size_t>(firstPage);
+    size_t blockSize = static_cast<size_t>(1) << order;
+
+    if (((page & (blockSize - 1)) != 0) || (blockSize > (_pageCount - page)))
+        return;
+
+    // Ignore the block if it is already part of a free block.
+    for (uint32_t freeOrder = order; freeOrder < OrderCount; ++freeOrder)
+    {
+        size_t freePage = page & ~((static_cast<size_t>(1) << freeOrder) - 1);
+
+        if (isBlockFree(freeOrder, freePage))
+            return;
+    }
+
+    while ((order + 1) < OrderCount)
+    {
+        blockSize = static_cast<size_t>(1) << order;
+        size_t buddy = page ^ blockSize;
+
+        if ((buddy >= _pageCount) || (blockSize > (_pageCount - buddy)) ||
+            (isBlockFree(order, buddy) == false))
+            break;
+
+        removeBlock(order, buddy);
+        page &= ~blockSize;
+        ++order;
+    }
+
+    pushBlock(order, page);
+}
+
+//! @brief Gets the header of a free block.
+//! @param[in] page The index of the first page in the block.
+BuddyAllocator::FreeBlock &BuddyAllocator::getBlock(size_t page) const
+{
+    return *getAddress<FreeBlock>(static_cast<uint64_t>(page) << MinBlockSizePow2);
+}
+
+//! @brief Determines whether a block of a specific order is on a free list.
+//! @param[in] order The order of the block.
+//! @param[in] page The index of the first page in the block.
+bool BuddyAllocator::isBlockFree(uint32_t order, size_t page) const
+{
+    size_t index = page >> order;
+    size_t word = _bitmapOffsets[order] + (index / BitsPerWord);
+
+    return (_freeBits[word] & (1u << (index % BitsPerWord))) != 0;
+}
+
+//! @brief Marks a block of a specific order as being free or not.
+//! @param[in] order The order of the block.
+//! @param[in] page The index of the first page in the block.
+//! @param[in] isFree True if the block is on a free list.
+void BuddyAllocator::setBlockFree(uint32_t order, size_t page, bool isFree)
+{
+    size_t index = page >> order;
+    uint32_t &word = _freeBits[_bitmapOffsets[order] + (index / BitsPerWord)];
+    uint32_t mask = 1u << (index % BitsPerWord);
+
+    word = isFree ? (word | mask) : (word & ~mask);
+}
+
+//! @brief Adds a block to the head of the free list for its order.
+//! @param[in] order The order of the block.
+//! @param[in] page The index of the first page in the block.
+void BuddyAllocator::pushBlock(uint32_t order, size_t page)
+{
+    FreeBlock &block = getBlock(page);
+    size_t head = _freeLists[order];
+
+    block.Next = head;
+    block.Prev = NoBlock;
+
+    if (head != NoBlock)
+    {
+        getBlock(head).Prev = page;
+    }
+
+    _freeLists[order] = page;
+    ++_freeCounts[order];
+    _nonEmptyOrders |= 1u << order;
+    _freeSize += static_cast<uint64_t>(MinBlockSize) << order;
+    setBlockFree(order, page, true);
+}
+
+//! @brief Removes a block from the free list for its order.
+//! @param[in] order The order of the block.
+//! @param[in] page The index of the first page in the block.
+void BuddyAllocator::removeBlock(uint32_t order, size_t page)
+{
+    const FreeBlock &block = getBlock(page);
+
+    if (block.Prev == NoBlock)
+    {
+        _freeLists[order] = block.Next;
+    }
+    else
+    {
+        getBlock(block.Prev).Next = block.Next;
+    }
+
+    if (block.Next != NoBlock)
+    {
+        getBlock(block.Next).Prev = block.Prev;
+    }
+
+    if (--_freeCounts[order] == 0)
+    {
+        _nonEmptyOrders &= ~(1u << order);
+    }
+
+    _freeSize -= static_cast<uint64_t>(MinBlockSize) << order;
+    setBlockFree(order, page, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,106 @@
+//! @file BootUtils/BuddyAllocator.hpp
+//! @brief The declaration of an object which allocates physically contiguous
+//! power of 2 sized blocks of memory at boot time.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_BUDDY_ALLOCATOR_HPP__
+#define __BOOT_UTILS_BUDDY_ALLOCATOR_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+class MemoryMap;
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A binary buddy allocator which hands out physically contiguous,
+//! naturally aligned blocks of 2^n pages from the usable RAM in the memory map.
+//! @details
+//! Free blocks of each order are kept on an intrusive doubly linked list
+//! stored in the free memory itself. A bitmap per order records which blocks
+//! are free so that a block's buddy can be found and coalesced when it is
+//! freed. Both allocation and freeing run in O(log N) time.
+class BuddyAllocator
+{
+public:
+    // Public Constants
+    //! @brief The size of the smallest block expressed as a power of 2.
+    static constexpr uint32_t MinBlockSizePow2 = 12;
+
+    //! @brief The count of bytes in the smallest block, a single page.
+    static constexpr uint32_t MinBlockSize = 1u << MinBlockSizePow2;
+
+    //! @brief The count of block sizes managed, the largest being 128 MB.
+    static constexpr uint32_t OrderCount = 16;
+
+    // Construction/Destruction
+    BuddyAllocator();
+    ~BuddyAllocator() = default;
+
+    // Accessors
+    uint64_t getFreeSize() const;
+    size_t getFreeBlockCount(uint32_t order) const;
+    static bool getOrderForSize(uint64_t size, uint32_t &order);
+
+    // Operations
+    bool initialise(MemoryMap &memoryMap);
+    bool allocate(uint32_t order, uint64_t &address);
+    void free(uint64_t address, uint32_t order);
+
+private:
+    // Internal Types
+    //! @brief The header written into each free block to link it into the
+    //! free list for its order.
+    struct FreeBlock
+    {
+        size_t Next;
+        size_t Prev;
+    };
+
+    // Internal Constants
+    //! @brief A page index used to mark the end of a free list.
+    static constexpr size_t NoBlock = SIZE_MAX;
+
+    // Internal Functions
+    FreeBlock &getBlock(size_t page) const;
+    bool isBlockFree(uint32_t order, size_t page) const;
+    void setBlockFree(uint32_t order, size_t page, bool isFree);
+    void pushBlock(uint32_t order, size_t page);
+    void removeBlock(uint32_t order, size_t page);
+
+    // Internal Fields
+    uint32_t *_freeBits;
+    size_t _pageCount;
+    uint64_t _freeSize;
+    uint32_t _nonEmptyOrders;
+    size_t _bitmapOffsets[OrderCount];
+    size_t _freeLists[OrderCount];
+    size_t _freeCounts[OrderCount];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
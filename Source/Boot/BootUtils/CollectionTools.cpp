@@ -23,6 +23,40 @@ namespace {
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data Types
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief Provides indexed access to an array of items whose type is only
+//! known at runtime through an IItemTraits implementation.
+class ErasedSequence
+{
+public:
+    // Construction/Destruction
+    ErasedSequence(const IItemTraits *itemTraits, const IComparer *comp,
+                   void *items) :
+        _items(static_cast<uint8_t *>(items)),
+        _stride(itemTraits->getItemSize()),
+        _itemTraits(itemTraits),
+        _comparer(comp)
+    {
+    }
+
+    // Operations
+    int compare(size_t lhs, size_t rhs) const
+    {
+        return _comparer->compare(_items + (lhs * _stride),
+                                  _items + (rhs * _stride));
+    }
+
+    void swap(size_t lhs, size_t rhs) const
+    {
+        _itemTraits->swap(_items + (lhs * _stride),
+                          _items + (rhs * _stride));
+    }
+private:
+    // Internal Fields
+    uint8_t *_items;
+    size_t _stride;
+    const IItemTraits *_itemTraits;
+    const IComparer *_comparer;
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data
@@ -34,13 +68,15 @@ namespace {
 
 } // Anonymous namespace
 
-////////////////////////////////////////////////////////////////////////////////
-// Xxx Member Definitions
-////////////////////////////////////////////////////////////////////////////////
-
 ////////////////////////////////////////////////////////////////////////////////
 // Global Function Definitions
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief Sorts an array of items whose type is only known at runtime.
+//! @param[in] itemTraits An object describing the size of each item and how
+//! to exchange two of them.
+//! @param[in] comp The object used to compare items.
+//! @param[in] items The array of items to sort in-place.
+//! @param[in] count The count of items in \p items.
 void sort(const IItemTraits *itemTraits,
           const IComparer *comp,
           void *items, size_t count)
@@ -48,66 +84,9 @@ void sort(const IItemTraits *itemTraits,
     if (count < 2)
         return;
 
-    auto lhsItems = static_cast<uint8_t *>(items);
-    size_t stride = itemTraits->getItemSize();
+    ErasedSequence sequence(itemTraits, comp, items);
 
-    // Divide the items roughly into halves.
-    size_t lowerCount = count / 2;
-
-    // Recursively sort the two halves.
-    sort(itemTraits, comp, items, lowerCount);
-    sort(itemTraits, comp,
-         lhsItems + (stride * lowerCount),
-         count - lowerCount);
-
-    // Merge the sorted items in-place.
-    auto rhsItems = lhsItems + (stride * lowerCount);
-    auto lastLhs = rhsItems - stride;
-
-    // All the left items should appear before all right right items.
-    if (comp->compare(lastLhs, rhsItems) <= 0)
-        return;
-
-    auto end = lhsItems + (stride * count);
-
-    while (lhsItems < rhsItems)
-    {
-        int diff = comp->compare(lhsItems, rhsItems);
-
-        if (diff < 0)
-        {
-            // The left item is already in the right place.
-            lhsItems += stride;
-        }
-        else if (diff > 0)
-        {
-            // The item on the right needs to go first.
-            itemTraits->swap(lhsItems, rhsItems);
-            lhsItems += stride;
-
-            // But the item at the head of the right list
-            // might be larger than the one after.
-            for (auto rhsNext = rhsItems + stride;
-                 rhsNext != end;
-                 rhsNext += stride)
-            {
-                auto rhsPrev = rhsNext - stride;
-                int rhsDiff = comp->compare(rhsPrev, rhsNext);
-
-                if (rhsDiff > 0)
-                {
-                    // The next item is less, shuffle the previous
-                    // item down.
-                    itemTraits->swap(rhsPrev, rhsNext);
-                }
-                else
-                {
-                    // The next item is greater or equal, so stop.
-                    break;
-                }
-            }
-        }
-    }
+    Detail::mergeSort(sequence, count);
 }
 
 } // namespace Collection
@@ -65,6 +65,28 @@ void sort(const IItemTraits *itemTraits,
 ////////////////////////////////////////////////////////////////////////////////
 // Templates
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief A function object which compares two items using the less-than
+//! operator, returning a value compatible with IComparer::compare().
+template<typename TItem>
+struct LessThan
+{
+    int operator()(const TItem &lhs, const TItem &rhs) const
+    {
+        int diff = 0;
+
+        if (lhs < rhs)
+        {
+            diff = -1;
+        }
+        else if (rhs < lhs)
+        {
+            diff = 1;
+        }
+
+        return diff;
+    }
+};
+
 template <typename TItem>
 class LessThanComparer : public IComparer
 {
@@ -82,18 +104,7 @@ public:
         auto lhsValue = static_cast<ItemPtr>(lhs);
         auto rhsValue = static_cast<ItemPtr>(rhs);
 
-        int diff = 0;
-
-        if (*lhsValue < *rhsValue)
-        {
-            diff = -1;
-        }
-        else if (*rhsValue < *lhsValue)
-        {
-            diff = 1;
-        }
-
-        return diff;
+        return LessThan<TItem>()(*lhsValue, *rhsValue);
     }
 };
 
@@ -121,6 +132,497 @@ public:
     }
 };
 
+namespace Detail {
+
+//! @brief Provides indexed access to an array of items of a type known at
+//! compile time so that comparisons and moves can be inlined.
+template<typename TItem, typename TCompare>
+class TypedSequence
+{
+public:
+    // Construction/Destruction
+    TypedSequence(TItem *items, const TCompare &compare) :
+        _items(items),
+        _compare(compare)
+    {
+    }
+
+    // Operations
+    int compare(size_t lhs, size_t rhs) const
+    {
+        return _compare(_items[lhs], _items[rhs]);
+    }
+
+    void swap(size_t lhs, size_t rhs) const
+    {
+        TItem temp(_items[lhs]);
+        _items[lhs] = _items[rhs];
+        _items[rhs] = temp;
+    }
+private:
+    // Internal Fields
+    TItem *_items;
+    TCompare _compare;
+};
+
+//! @brief The minimum length of a run of items to merge, shorter natural
+//! runs are extended using an insertion sort.
+constexpr size_t MinRunLength = 16;
+
+//! @brief The maximum count of pending runs which the merge sort can track.
+//! @details Pending run lengths grow at least as fast as the Fibonacci
+//! sequence, so 12 entries per byte of address space is ample.
+constexpr size_t MaxPendingRuns = sizeof(size_t) * 12;
+
+//! @brief Sorts a short run of items in a sequence using a stable insertion
+//! sort.
+//! @param[in] items The sequence of items to sort.
+//! @param[in] first The index of the first item in the run to sort.
+//! @param[in] sorted The index of the first item after a prefix of the run
+//! which is already in order.
+//! @param[in] last The index of the item after the last in the run to sort.
+template<typename TSequence>
+void insertionSort(const TSequence &items, size_t first, size_t sorted,
+                   size_t last)
+{
+    for (size_t i = (sorted > first) ? sorted : first + 1; i < last; ++i)
+    {
+        for (size_t j = i; (j > first) && (items.compare(j - 1, j) > 0); --j)
+        {
+            items.swap(j - 1, j);
+        }
+    }
+}
+
+//! @brief Exchanges two equally sized, non-overlapping runs of items.
+//! @param[in] items The sequence containing the items.
+//! @param[in] lhs The index of the first item in the first run.
+//! @param[in] rhs The index of the first item in the second run.
+//! @param[in] count The count of items in each run.
+template<typename TSequence>
+void swapRange(const TSequence &items, size_t lhs, size_t rhs, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        items.swap(lhs + i, rhs + i);
+    }
+}
+
+//! @brief Exchanges two adjacent runs of items of possibly different lengths
+//! using successive block swaps.
+//! @param[in] items The sequence containing the items.
+//! @param[in] first The index of the first item in the first run.
+//! @param[in] middle The index of the first item in the second run.
+//! @param[in] last The index of the item after the end of the second run.
+template<typename TSequence>
+void rotate(const TSequence &items, size_t first, size_t middle, size_t last)
+{
+    size_t lhsCount = middle - first;
+    size_t rhsCount = last - middle;
+
+    while (lhsCount != rhsCount)
+    {
+        if (lhsCount > rhsCount)
+        {
+            swapRange(items, middle - lhsCount, middle, rhsCount);
+            lhsCount -= rhsCount;
+        }
+        else
+        {
+            swapRange(items, middle - lhsCount,
+                      middle + rhsCount - lhsCount, lhsCount);
+            rhsCount -= lhsCount;
+        }
+    }
+
+    swapRange(items, middle - lhsCount, middle, lhsCount);
+}
+
+//! @brief Merges two adjacent sorted runs of items in-place and in a stable
+//! manner using the SymMerge algorithm (Kim & Kutzner, 2004).
+//! @param[in] items The sequence containing the items.
+//! @param[in] first The index of the first item in the first run.
+//! @param[in] middle The index of the first item in the second run.
+//! @param[in] last The index of the item after the end of the second run.
+//! @details Each merge performs O(m log(n/m + 1)) comparisons where m is the
+//! length of the shorter run, and needs no storage other than a recursion
+//! depth of O(log n).
+template<typename TSequence>
+void symMerge(const TSequence &items, size_t first, size_t middle, size_t last)
+{
+    if ((middle - first) == 1)
+    {
+        // Binary search for the first item on the right which is not less
+        // than the single item on the left, then rotate that item into place.
+        size_t lower = middle;
+        size_t upper = last;
+
+        while (lower < upper)
+        {
+            size_t pivot = lower + ((upper - lower) / 2);
+
+            if (items.compare(pivot, first) < 0)
+            {
+                lower = pivot + 1;
+            }
+            else
+            {
+                upper = pivot;
+            }
+        }
+
+        for (size_t i = first; i + 1 < lower; ++i)
+        {
+            items.swap(i, i + 1);
+        }
+    }
+    else if ((last - middle) == 1)
+    {
+        // Binary search for the first item on the left which is greater
+        // than the single item on the right and rotate the item into place.
+        size_t lower = first;
+        size_t upper = middle;
+
+        while (lower < upper)
+        {
+            size_t pivot = lower + ((upper - lower) / 2);
+
+            if (items.compare(middle, pivot) >= 0)
+            {
+                lower = pivot + 1;
+            }
+            else
+            {
+                upper = pivot;
+            }
+        }
+
+        for (size_t i = middle; i > lower; --i)
+        {
+            items.swap(i, i - 1);
+        }
+    }
+    else
+    {
+        size_t centre = first + ((last - first) / 2);
+        size_t bound = centre + middle;
+        size_t start;
+        size_t limit;
+
+        if (middle > centre)
+        {
+            start = bound - last;
+            limit = centre;
+        }
+        else
+        {
+            start = first;
+            limit = middle;
+        }
+
+        // Find the point at which the two runs should be symmetrically split.
+        size_t pivotBase = bound - 1;
+
+        while (start < limit)
+        {
+            size_t pivot = start + ((limit - start) / 2);
+
+            if (items.compare(pivotBase - pivot, pivot) >= 0)
+            {
+                start = pivot + 1;
+            }
+            else
+            {
+                limit = pivot;
+            }
+        }
+
+        size_t end = bound - start;
+
+        if ((start < middle) && (middle < end))
+        {
+            rotate(items, start, middle, end);
+        }
+
+        if ((first < start) && (start < centre))
+        {
+            symMerge(items, first, start, centre);
+        }
+
+        if ((centre < end) && (end < last))
+        {
+            symMerge(items, centre, end, last);
+        }
+    }
+}
+
+//! @brief Reverses the order of a run of items.
+//! @param[in] items The sequence containing the items.
+//! @param[in] first The index of the first item in the run.
+//! @param[in] last The index of the item after the end of the run.
+template<typename TSequence>
+void reverse(const TSequence &items, size_t first, size_t last)
+{
+    while ((first + 1) < last)
+    {
+        items.swap(first++, --last);
+    }
+}
+
+//! @brief Finds the end of the natural run of items beginning at a specified
+//! position, reversing the run if it is strictly descending.
+//! @param[in] items The sequence containing the items.
+//! @param[in] first The index of the first item in the run.
+//! @param[in] count The count of items in the sequence.
+//! @return The index of the item after the end of the now ascending run.
+template<typename TSequence>
+size_t findRun(const TSequence &items, size_t first, size_t count)
+{
+    size_t last = first + 1;
+
+    if (last < count)
+    {
+        if (items.compare(first, last) > 0)
+        {
+            // Only strictly descending runs can be reversed without
+            // upsetting the order of equal items.
+            do
+            {
+                ++last;
+            } while ((last < count) && (items.compare(last - 1, last) > 0));
+
+            reverse(items, first, last);
+        }
+        else
+        {
+            do
+            {
+                ++last;
+            } while ((last < count) && (items.compare(last - 1, last) <= 0));
+        }
+    }
+
+    return last;
+}
+
+//! @brief Merges a pending run with the one which follows it and removes the
+//! second from the set of pending runs.
+//! @param[in] items The sequence containing the items.
+//! @param[in] runStarts The array of indices of the first item of each
+//! pending run.
+//! @param[in,out] runCount The count of pending runs in \p runStarts.
+//! @param[in] index The index of the first of the two runs to merge.
+//! @param[in] end The index of the item after the end of the last pending run.
+template<typename TSequence>
+void mergeRuns(const TSequence &items, size_t *runStarts, size_t &runCount,
+               size_t index, size_t end)
+{
+    size_t first = runStarts[index];
+    size_t middle = runStarts[index + 1];
+    size_t last = ((index + 2) < runCount) ? runStarts[index + 2] : end;
+
+    // Skip runs which are already in order.
+    if (items.compare(middle - 1, middle) > 0)
+    {
+        symMerge(items, first, middle, last);
+    }
+
+    for (size_t i = index + 1; (i + 1) < runCount; ++i)
+    {
+        runStarts[i] = runStarts[i + 1];
+    }
+
+    --runCount;
+}
+
+//! @brief Sorts the items in a sequence using a stable, in-place adaptive
+//! merge sort.
+//! @tparam TSequence The type of an object providing compare(size_t, size_t)
+//! and swap(size_t, size_t) operations on items by index.
+//! @param[in] items The sequence of items to sort.
+//! @param[in] count The count of items in the sequence.
+//! @details Natural ascending and strictly descending runs are detected and
+//! merged in the manner of Timsort, so input which is already in order is
+//! sorted with n - 1 comparisons. Otherwise the sort performs O(n log n)
+//! comparisons and O(n log^2 n) item exchanges in the worst case and
+//! allocates no memory.
+template<typename TSequence>
+void mergeSort(const TSequence &items, size_t count)
+{
+    if (count < 2)
+        return;
+
+    size_t runStarts[MaxPendingRuns];
+    size_t runCount = 0;
+    size_t first = 0;
+
+    while (first < count)
+    {
+        size_t last = findRun(items, first, count);
+
+        if ((last - first) < MinRunLength)
+        {
+            // Extend short runs to a minimum length.
+            size_t forcedLast = ((count - first) > MinRunLength) ?
+                                    first + MinRunLength : count;
+
+            insertionSort(items, first, last, forcedLast);
+            last = forcedLast;
+        }
+
+        if (runCount == MaxPendingRuns)
+        {
+            // Should never happen, but ensure there is space for a new run.
+            mergeRuns(items, runStarts, runCount, runCount - 2, first);
+        }
+
+        runStarts[runCount++] = first;
+        first = last;
+
+        // Merge pending runs until their lengths decrease by at least as
+        // much as the Fibonacci sequence from the bottom of the stack.
+        while (runCount > 1)
+        {
+            size_t n = runCount - 2;
+            size_t topLength = first - runStarts[n + 1];
+            size_t nextLength = runStarts[n + 1] - runStarts[n];
+
+            if (((n > 0) &&
+                 ((runStarts[n] - runStarts[n - 1]) <= (nextLength + topLength))) ||
+                ((n > 1) &&
+                 ((runStarts[n - 1] - runStarts[n - 2]) <=
+                    (runStarts[n] - runStarts[n - 1]) + nextLength)))
+            {
+                // Merge the middle run with the smaller of its neighbours.
+                if ((runStarts[n] - runStarts[n - 1]) < topLength)
+                {
+                    --n;
+                }
+            }
+            else if (nextLength > topLength)
+            {
+                // The invariant holds.
+                break;
+            }
+
+            mergeRuns(items, runStarts, runCount, n, first);
+        }
+    }
+
+    // Merge all remaining runs.
+    while (runCount > 1)
+    {
+        mergeRuns(items, runStarts, runCount, runCount - 2, count);
+    }
+}
+
+} // namespace Detail
+
+//! @brief Sorts an array of items of a type known at compile time.
+//! @tparam TItem The data type of the items to sort.
+//! @tparam TCompare The type of a function object which compares two items
+//! returning a negative, zero or positive value in the same manner as
+//! IComparer::compare().
+//! @param[in] items The array of items to sort in-place.
+//! @param[in] count The count of elements in \p items.
+//! @param[in] compare The object used to compare items.
+template<typename TItem, typename TCompare = LessThan<TItem>>
+void sort(TItem *items, size_t count, const TCompare &compare = TCompare())
+{
+    Detail::TypedSequence<TItem, TCompare> sequence(items, compare);
+
+    Detail::mergeSort(sequence, count);
+}
+
+//! @brief Sorts an array of items on an unsigned integer key using a stable
+//! least-significant-digit radix sort.
+//! @tparam TItem The data type of the items to sort.
+//! @tparam TGetKey The type of a function object which returns an unsigned
+//! integer key when passed a const reference to an item.
+//! @param[in] items The array of items to sort in-place.
+//! @param[in] count The count of elements in \p items.
+//! @param[in] scratch An array of at least \p count items used as temporary
+//! storage, it must not overlap \p items.
+//! @param[in] getKey The object used to extract keys from items.
+//! @details The sort makes one pass over the items per byte of the key in
+//! which the keys actually differ, so it runs in O(n) time. Items with equal
+//! keys keep their relative order, so keys wider than a single integer can be
+//! sorted on by sorting on the least significant part first.
+template<typename TItem, typename TGetKey>
+void radixSort(TItem *items, size_t count, TItem *scratch, const TGetKey &getKey)
+{
+    using Key = decltype(getKey(*items));
+
+    static_assert(static_cast<Key>(~static_cast<Key>(0)) > static_cast<Key>(0),
+                  "Radix sort keys must be unsigned integers.");
+
+    if (count < 2)
+        return;
+
+    // Find the bits which actually vary between keys so that passes over
+    // bytes which are the same in every key can be skipped.
+    Key commonBits = getKey(items[0]);
+    Key anyBits = commonBits;
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        Key key = getKey(items[i]);
+        commonBits &= key;
+        anyBits |= key;
+    }
+
+    const Key varyingBits = commonBits ^ anyBits;
+    TItem *source = items;
+    TItem *target = scratch;
+    uint32_t offsets[256];
+
+    for (size_t shift = 0; shift < (sizeof(Key) * 8); shift += 8)
+    {
+        if (((varyingBits >> shift) & 0xFF) == 0)
+            continue;
+
+        // Count the items with each value of the current digit.
+        for (size_t i = 0; i < 256; ++i)
+        {
+            offsets[i] = 0;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++offsets[(getKey(source[i]) >> shift) & 0xFF];
+        }
+
+        // Convert the counts into the offset of the first item of each value.
+        uint32_t total = 0;
+
+        for (size_t i = 0; i < 256; ++i)
+        {
+            uint32_t digitCount = offsets[i];
+            offsets[i] = total;
+            total += digitCount;
+        }
+
+        // Distribute the items in order.
+        for (size_t i = 0; i < count; ++i)
+        {
+            target[offsets[(getKey(source[i]) >> shift) & 0xFF]++] = source[i];
+        }
+
+        TItem *temp = source;
+        source = target;
+        target = temp;
+    }
+
+    if (source != items)
+    {
+        // Copy the results from the scratch array.
+        for (size_t i = 0; i < count; ++i)
+        {
+            items[i] = source[i];
+        }
+    }
+}
+
 } // namespace Collection
 
 
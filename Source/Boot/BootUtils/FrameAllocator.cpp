@@ -0,0 +1,384 @@
+//! @file BootUtils/FrameAllocator.cpp
+//! @brief The definition of an object which allocates physical page frames
+//! at boot time.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "BitTools.hpp"
+#include "FrameAllocator.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// FrameAllocator Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Constructs an allocator which has no frames to allocate.
+FrameAllocator::FrameAllocator() :
+    _bitmap(nullptr),
+    _bitmapAddr(0),
+    _wordCount(0),
+    _frameCount(0),
+    _freeFrameCount(0),
+    _searchHint(0)
+{
+}
+
+//! @brief Gets the count of frames described by the bitmap, including those
+//! which are not available for allocation.
+size_t FrameAllocator::getFrameCount() const { return _frameCount; }
+
+//! @brief Gets the count of frames currently available for allocation.
+size_t FrameAllocator::getFreeFrameCount() const { return _freeFrameCount; }
+
+//! @brief Determines if the frame containing a physical address is free.
+//! @param[in] address The physical address to query.
+//! @retval true The frame is available for allocation.
+//! @retval false The frame is allocated or not usable RAM.
+bool FrameAllocator::isFrameFree(uint64_t address) const
+{
+    uint64_t frame = address >> FrameSizePow2;
+
+    if (frame >= _frameCount)
+        return false;
+
+    size_t index = static_cast<size_t>(frame);
+
+    return (_bitmap[index / WordBits] & (Word(1) << (index % WordBits))) != 0;
+}
+
+//! @brief Describes the bitmap so that it can be adopted by the kernel as-is.
+//! @param[out] info Receives the location and extent of the bitmap.
+//! @note The memory holding the bitmap is marked as usable after boot in the
+//! memory map, so the kernel must adopt the bitmap before reusing it.
+void FrameAllocator::getBitmapInfo(FrameBitmap &info) const
+{
+    info.BitmapAddress = _bitmapAddr;
+    info.BitmapSize = static_cast<uint32_t>(_wordCount * sizeof(Word));
+    info.FrameCount = static_cast<uint32_t>(_frameCount);
+    info.FreeFrameCount = static_cast<uint32_t>(_freeFrameCount);
+}
+
+//! @brief Builds the bitmap of free frames from the usable RAM in a
+//! consolidated memory map.
+//! @param[in] memoryMap The memory map to take usable RAM from. The memory
+//! used to hold the bitmap is reserved within it.
+//! @retval true The bitmap was created.
+//! @retval false There was no addressable block of usable RAM large enough
+//! to hold the bitmap or the block could not be reserved.
+bool FrameAllocator::initialise(MemoryMap &memoryMap)
+{
+    const MemMapEntry *regions = memoryMap.getRegions();
+    size_t regionCount = memoryMap.getRegionCount();
+    uint64_t topAddr = 0;
+
+    for (size_t i = 0; i < regionCount; ++i)
+    {
+        if (regions[i].Type == MemType::UsableRAM)
+        {
+            uint64_t end = regions[i].BaseAddress + regions[i].Size;
+
+            if (end > topAddr)
+            {
+                topAddr = end;
+            }
+        }
+    }
+
+    uint64_t frameCount = topAddr >> FrameSizePow2;
+
+    if ((frameCount == 0) || (frameCount > (SIZE_MAX - WordBits)))
+        return false;
+
+    size_t wordCount = (static_cast<size_t>(frameCount) + WordBits - 1) / WordBits;
+    uint64_t bitmapSize = static_cast<uint64_t>(wordCount) * sizeof(Word);
+    uint64_t reservedSize = (bitmapSize + FrameSize - 1) & ~static_cast<uint64_t>(FrameSize - 1);
+    uint64_t bitmapAddr = 0;
+    bool hasLocation = false;
+
+    // Place the bitmap at the top of the highest block of addressable usable
+    // RAM which can hold it, leaving low memory free for legacy devices.
+    for (size_t i = regionCount; (hasLocation == false) && (i > 0); --i)
+    {
+        const MemMapEntry &region = regions[i - 1];
+
+        if ((region.Type != MemType::UsableRAM) ||
+            (memoryMap.isRegionAccessable(i - 1) == false))
+        {
+            continue;
+        }
+
+        uint64_t end = (region.BaseAddress + region.Size) &
+                       ~static_cast<uint64_t>(FrameSize - 1);
+
+        if ((end >= reservedSize) && ((end - reservedSize) >= region.BaseAddress))
+        {
+            bitmapAddr = end - reservedSize;
+            hasLocation = true;
+        }
+    }
+
+    if ((hasLocation == false) ||
+        (memoryMap.reserve(bitmapAddr, reservedSize, MemType::UsableAfterBoot) == false))
+    {
+        return false;
+    }
+
+    _bitmap = getAddress<Word>(bitmapAddr);
+    _bitmapAddr = bitmapAddr;
+    _wordCount = wordCount;
+    _frameCount = static_cast<size_t>(frameCount);
+    _freeFrameCount = 0;
+    _searchHint = 0;
+
+    for (size_t i = 0; i < wordCount; ++i)
+    {
+        _bitmap[i] = 0;
+    }
+
+    // Mark the whole frames of usable RAM as free, the map no longer
+    // includes the bitmap itself.
+    regions = memoryMap.getRegions();
+    regionCount = memoryMap.getRegionCount();
+
+    for (size_t i = 0; i < regionCount; ++i)
+    {
+        const MemMapEntry &region = regions[i];
+
+        if (region.Type != MemType::UsableRAM)
+            continue;
+
+        uint64_t first = (region.BaseAddress + FrameSize - 1) >> FrameSizePow2;
+        uint64_t last = (region.BaseAddress + region.Size) >> FrameSizePow2;
+
+        if (last > first)
+        {
+            setFrames(static_cast<size_t>(first),
+                      static_cast<size_t>(last - first), true);
+        }
+    }
+
+    return true;
+}
+
+//! @brief Allocates a single frame, the lowest one available.
+//! @param[out] address Receives the physical address of the frame.
+//! @retval true A frame was allocated.
+//! @retval false There were no free frames.
+bool FrameAllocator::allocate(uint64_t &address)
+{
+    size_t frame = findNextFree(_searchHint * WordBits);
+
+    if (frame >= _frameCount)
+        return false;
+
+    setFrames(frame, 1, false);
+    address = static_cast<uint64_t>(frame) << FrameSizePow2;
+
+    return true;
+}
+
+//! @brief Allocates a physically contiguous run of frames.
+//! @param[in] count The count of frames to allocate.
+//! @param[in] alignment The power of 2 boundary, in bytes, which the run must
+//! start on, e.g. 4 MB for a large page mapping.
+//! @param[out] address Receives the physical address of the first frame.
+//! @retval true The frames were allocated.
+//! @retval false The parameters were invalid or no suitable run of frames
+//! was available.
+bool FrameAllocator::allocate(size_t count, uint64_t alignment, uint64_t &address)
+{
+    if ((count == 0) || (Bits::isPowerOf2(alignment) == false))
+        return false;
+
+    uint64_t alignmentInFrames = alignment >> FrameSizePow2;
+
+    if (alignmentInFrames > _frameCount)
+        return false;
+
+    size_t alignMask = (alignmentInFrames > 1) ?
+                            static_cast<size_t>(alignmentInFrames - 1) : 0;
+    size_t start = findNextFree(_searchHint * WordBits);
+
+    while (start < _frameCount)
+    {
+        start = (start + alignMask) & ~alignMask;
+
+        if ((start >= _frameCount) || ((_frameCount - start) < count))
+            return false;
+
+        size_t used = findNextUsed(start, start + count);
+
+        if (used == (start + count))
+        {
+            setFrames(start, count, false);
+            address = static_cast<uint64_t>(start) << FrameSizePow2;
+
+            return true;
+        }
+
+        // Skip past the allocated frame which interrupted the run.
+        start = findNextFree(used + 1);
+    }
+
+    return false;
+}
+
+//! @brief Returns a run of frames to the allocator.
+//! @param[in] address The physical address of the first frame.
+//! @param[in] count The count of consecutive frames to free.
+void FrameAllocator::free(uint64_t address, size_t count)
+{
+    uint64_t frame = address >> FrameSizePow2;
+
+    if ((frame >= _frameCount) || (count == 0))
+        return;
+
+    size_t first = static_cast<size_t>(frame);
+
+    if (count > (_frameCount - first))
+    {
+        count = _frameCount - first;
+    }
+
+    setFrames(first, count, true);
+}
+
+//! @brief Finds the first free frame at or after a specified frame.
+//! @param[in] frame The index of the frame to start searching from.
+//! @return The index of the free frame or the count of frames if there were
+//! none.
+size_t FrameAllocator::findNextFree(size_t frame) const
+{
+    if (frame >= _frameCount)
+        return _frameCount;
+
+    size_t index = frame / WordBits;
+    Word bits = _bitmap[index] & (~Word(0) << (frame % WordBits));
+
+    while (bits == 0)
+    {
+        if (++index >= _wordCount)
+            return _frameCount;
+
+        bits = _bitmap[index];
+    }
+
+    size_t found = (index * WordBits) + Bits::countTrailingZeros(bits);
+
+    return (found < _frameCount) ? found : _frameCount;
+}
+
+//! @brief Finds the first allocated frame within a range of frames.
+//! @param[in] frame The index of the frame to start searching from.
+//! @param[in] limit The index of the frame after the last one to search.
+//! @return The index of the allocated frame or \p limit if all were free.
+size_t FrameAllocator::findNextUsed(size_t frame, size_t limit) const
+{
+    if (frame >= limit)
+        return limit;
+
+    size_t index = frame / WordBits;
+    Word bits = ~_bitmap[index] & (~Word(0) << (frame % WordBits));
+
+    while (bits == 0)
+    {
+        if ((++index * WordBits) >= limit)
+            return limit;
+
+        bits = ~_bitmap[index];
+    }
+
+    size_t found = (index * WordBits) + Bits::countTrailingZeros(bits);
+
+    return (found < limit) ? found : limit;
+}
+
+//! @brief Marks a run of frames as free or allocated.
+//! @param[in] first The index of the first frame to update.
+//! @param[in] count The count of frames to update.
+//! @param[in] isFree True to mark the frames as free, false to mark them as
+//! allocated.
+void FrameAllocator::setFrames(size_t first, size_t count, bool isFree)
+{
+    size_t index = first / WordBits;
+    size_t bit = first % WordBits;
+
+    while (count > 0)
+    {
+        size_t runLength = WordBits - bit;
+
+        if (runLength > count)
+        {
+            runLength = count;
+        }
+
+        Word mask = (runLength == WordBits) ? ~Word(0) :
+                                              ((Word(1) << runLength) - 1) << bit;
+        Word &word = _bitmap[index];
+
+        if (isFree)
+        {
+            _freeFrameCount += Bits::countSetBits(mask & ~word);
+            word |= mask;
+        }
+        else
+        {
+            _freeFrameCount -= Bits::countSetBits(mask & word);
+            word &= ~mask;
+        }
+
+        count -= runLength;
+        bit = 0;
+        ++index;
+    }
+
+    // Keep the search hint at the lowest word which might have a free frame.
+    size_t firstIndex = first / WordBits;
+
+    if (isFree)
+    {
+        if (firstIndex < _searchHint)
+        {
+            _searchHint = firstIndex;
+        }
+    }
+    else if ((firstIndex == _searchHint) && (_bitmap[firstIndex] == 0))
+    {
+        while ((_searchHint < _wordCount) && (_bitmap[_searchHint] == 0))
+        {
+            ++_searchHint;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
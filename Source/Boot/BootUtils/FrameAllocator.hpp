@@ -0,0 +1,92 @@
+//! @file BootUtils/FrameAllocator.hpp
+//! @brief The declaration of an object which allocates physical page frames
+//! at boot time.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_FRAME_ALLOCATOR_HPP__
+#define __BOOT_UTILS_FRAME_ALLOCATOR_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+class MemoryMap;
+struct FrameBitmap;
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which allocates 4 KB physical page frames using a bitmap
+//! built from the usable RAM described by the memory map.
+class FrameAllocator
+{
+public:
+    // Public Constants
+    //! @brief The size of a page frame expressed as a power of 2.
+    static constexpr uint32_t FrameSizePow2 = 12;
+
+    //! @brief The count of bytes in a page frame.
+    static constexpr uint32_t FrameSize = 1u << FrameSizePow2;
+
+    // Construction/Destruction
+    FrameAllocator();
+    ~FrameAllocator() = default;
+
+    // Accessors
+    size_t getFrameCount() const;
+    size_t getFreeFrameCount() const;
+    bool isFrameFree(uint64_t address) const;
+    void getBitmapInfo(FrameBitmap &info) const;
+
+    // Operations
+    bool initialise(MemoryMap &memoryMap);
+    bool allocate(uint64_t &address);
+    bool allocate(size_t count, uint64_t alignment, uint64_t &address);
+    void free(uint64_t address, size_t count = 1);
+
+private:
+    // Internal Types
+    //! @brief The type of word the bitmap is scanned in.
+    using Word = uintptr_t;
+
+    // Internal Constants
+    static constexpr size_t WordBits = sizeof(Word) * 8;
+
+    // Internal Functions
+    size_t findNextFree(size_t frame) const;
+    size_t findNextUsed(size_t frame, size_t limit) const;
+    void setFrames(size_t first, size_t count, bool isFree);
+
+    // Internal Fields
+    Word *_bitmap;
+    uint64_t _bitmapAddr;
+    size_t _wordCount;
+    size_t _frameCount;
+    size_t _freeFrameCount;
+    size_t _searchHint;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -11,7 +11,11 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Header File Includes
 ////////////////////////////////////////////////////////////////////////////////
+#include "BitTools.hpp"
 #include "Heap.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "Tlsf.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Macro Definitions
@@ -25,20 +29,436 @@ namespace {
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief The granularity with which heap memory is reserved in the memory map.
+constexpr uint64_t PageSize = 0x1000;
 
 ////////////////////////////////////////////////////////////////////////////////
 // Local Functions
 ////////////////////////////////////////////////////////////////////////////////
+#ifdef BOOT_HEAP_STATS
+//! @brief Gets the HeapStats bucket which counts blocks of a specific size.
+uint32_t getStatsBucket(size_t size)
+{
+    if (size <= 16)
+        return 0;
+
+    uint32_t bucket = Bits::getHighestSetBit(size - 1) - 3;
+
+    return (bucket < HeapStatsBucketCount) ? bucket : HeapStatsBucketCount - 1;
+}
+
+//! @brief Clamps a size to fit in a 32-bit statistics field.
+uint32_t toStatsValue(size_t value)
+{
+    uint32_t clamped = static_cast<uint32_t>(value);
+
+    return (clamped == value) ? clamped : UINT32_MAX;
+}
+
+//! @brief Writes a null-terminated string to a text sink.
+void writeText(TextSinkFn sink, const char *text)
+{
+    size_t length = 0;
+
+    while (text[length] != '\0')
+    {
+        ++length;
+    }
+
+    sink(text, length);
+}
+
+//! @brief Writes an unsigned value to a text sink in decimal.
+void writeDecimal(TextSinkFn sink, uint32_t value)
+{
+    char digits[10];
+    size_t count = 0;
+
+    do
+    {
+        digits[sizeof(digits) - ++count] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    sink(digits + sizeof(digits) - count, count);
+}
+
+//! @brief Writes a labelled value and a new line to a text sink.
+void writeValue(TextSinkFn sink, const char *label, uint32_t value, const char *units)
+{
+    writeText(sink, label);
+    writeDecimal(sink, value);
+    writeText(sink, units);
+}
+#endif
 
 } // Anonymous namespace
 
 ////////////////////////////////////////////////////////////////////////////////
-// Xxx Member Definitions
+// Heap Member Definitions
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief Constructs a heap which has no memory to allocate.
+Heap::Heap() :
+    _base(nullptr),
+    _baseAddr(0),
+    _capacity(0),
+    _offset(0),
+    _pool(nullptr),
+    _poolSize(0)
+{
+#ifdef BOOT_HEAP_STATS
+    for (uint32_t i = 0; i < HeapStatsBucketCount; ++i)
+    {
+        _allocationCounts[i] = 0;
+        _freeCounts[i] = 0;
+    }
+
+    _bytesInUse = 0;
+    _peakBytesInUse = 0;
+#endif
+}
+
+//! @brief Gets the physical address of the start of the heap.
+uint64_t Heap::getBaseAddress() const { return _baseAddr; }
+
+//! @brief Gets the total count of bytes the heap can allocate.
+size_t Heap::getCapacity() const { return _capacity; }
+
+//! @brief Gets the count of bytes currently allocated, including padding.
+size_t Heap::getUsedSize() const { return _offset; }
+
+//! @brief Gets the count of bytes set aside for the general purpose pool.
+size_t Heap::getPoolSize() const { return _poolSize; }
+
+//! @brief Gets the count of bytes in free blocks in the general purpose pool.
+size_t Heap::getPoolFreeSize() const
+{
+    return (_pool == nullptr) ? 0 : _pool->getFreeSize();
+}
+
+//! @brief Takes a snapshot of the allocation statistics of the heap.
+//! @param[out] stats Receives the statistics.
+//! @retval true The statistics were returned.
+//! @retval false Statistics are not being collected, BOOT_HEAP_STATS was not
+//! defined when the heap was compiled.
+bool Heap::getStats(HeapStats &stats) const
+{
+#ifdef BOOT_HEAP_STATS
+    for (uint32_t i = 0; i < HeapStatsBucketCount; ++i)
+    {
+        stats.AllocationCounts[i] = _allocationCounts[i];
+        stats.FreeCounts[i] = _freeCounts[i];
+    }
+
+    size_t freeSize = getPoolFreeSize();
+    size_t largestFree = (_pool == nullptr) ? 0 : _pool->getLargestFreeSize();
+
+    stats.BytesInUse = toStatsValue(_bytesInUse);
+    stats.PeakBytesInUse = toStatsValue(_peakBytesInUse);
+    stats.PoolSize = toStatsValue(_poolSize);
+    stats.PoolFreeSize = toStatsValue(freeSize);
+    stats.LargestFreeBlock = toStatsValue(largestFree);
+
+    // Scale to kilobytes to keep the product within 32 bits, the loader
+    // can't rely on 64-bit division.
+    uint32_t freeKb = static_cast<uint32_t>(freeSize >> 10);
+    uint32_t largestKb = static_cast<uint32_t>(largestFree >> 10);
+
+    stats.FragmentationPerMille = (freeKb == 0) ? 0 :
+                                  ((freeKb - largestKb) * 1000) / freeKb;
+
+    return true;
+#else
+    (void)stats;
+    return false;
+#endif
+}
+
+//! @brief Carves the heap from the largest block of addressable usable RAM.
+//! @param[in] memoryMap The memory map to take RAM from. The whole of the
+//! heap is reserved within it until commit() is called.
+//! @param[in] maxSize The maximum count of bytes to take for the heap.
+//! @retval true The heap was initialised.
+//! @retval false There was no addressable usable RAM or it couldn't be
+//! reserved.
+bool Heap::initialise(MemoryMap &memoryMap, size_t maxSize)
+{
+    const MemMapEntry *regions = memoryMap.getRegions();
+    size_t regionCount = memoryMap.getRegionCount();
+    uint64_t bestBase = 0;
+    uint64_t bestSize = 0;
+
+    for (size_t i = 0; i < regionCount; ++i)
+    {
+        const MemMapEntry &region = regions[i];
+
+        if ((region.Type != MemType::UsableRAM) ||
+            (memoryMap.isRegionAccessable(i) == false))
+        {
+            continue;
+        }
+
+        // Only use whole pages so that the heap can be reserved exactly.
+        uint64_t base = (region.BaseAddress + PageSize - 1) & ~(PageSize - 1);
+        uint64_t end = (region.BaseAddress + region.Size) & ~(PageSize - 1);
+
+        if ((end > base) && ((end - base) > bestSize))
+        {
+            bestBase = base;
+            bestSize = end - base;
+        }
+    }
+
+    uint64_t limit = static_cast<uint64_t>(maxSize) & ~(PageSize - 1);
+
+    if (bestSize > limit)
+    {
+        bestSize = limit;
+    }
+
+    if ((bestSize == 0) ||
+        (memoryMap.reserve(bestBase, bestSize, MemType::UsableAfterBoot) == false))
+    {
+        return false;
+    }
+
+    _base = getAddress<uint8_t>(bestBase);
+    _baseAddr = bestBase;
+    _capacity = static_cast<size_t>(bestSize);
+    _offset = 0;
+    _pool = nullptr;
+    _poolSize = 0;
+
+    return true;
+}
+
+//! @brief Allocates a block of memory from the heap.
+//! @param[in] size The count of bytes to allocate.
+//! @param[in] alignment The power of 2 boundary the block must start on.
+//! @return A pointer to the new block or nullptr if there was not enough
+//! space remaining or the alignment was invalid.
+//! @note Allocation runs in O(1) time.
+void *Heap::allocate(size_t size, size_t alignment)
+{
+    if ((_base == nullptr) || (Bits::isPowerOf2(alignment) == false))
+        return nullptr;
+
+    // Align the address rather than the offset, the base of the heap is only
+    // aligned to a page.
+    uintptr_t current = reinterpret_cast<uintptr_t>(_base) + _offset;
+    uintptr_t aligned = (current + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    size_t start = _offset + static_cast<size_t>(aligned - current);
+
+    if ((aligned < current) || (start > _capacity) || (size > (_capacity - start)))
+        return nullptr;
+
+    HEAP_STATS_ONLY(recordAllocation(size, (start + size) - _offset));
+    _offset = start + size;
+
+    return _base + start;
+}
+
+//! @brief Records the current position in the heap.
+//! @return A marker which can be passed to release() to free all blocks
+//! allocated after this point.
+Heap::Marker Heap::mark() const { return _offset; }
+
+//! @brief Frees all blocks allocated since a position in the heap was
+//! recorded.
+//! @param[in] position A marker previously returned by mark(). Markers
+//! beyond the current position are ignored.
+void Heap::release(Marker position)
+{
+    if (position < _offset)
+    {
+        HEAP_STATS_ONLY(_bytesInUse -= _offset - position);
+        _offset = position;
+    }
+}
+
+//! @brief Returns the unused part of the heap to the memory map, leaving the
+//! memory allocated so far reserved so that it survives until after boot.
+//! The general purpose pool, if any, remains reserved and usable.
+//! @param[in] memoryMap The memory map the heap was initialised from.
+//! @retval true The unused memory was released.
+//! @retval false The memory map could not be updated.
+//! @note No further allocations can be made once the heap is committed.
+bool Heap::commit(MemoryMap &memoryMap)
+{
+    if (_base == nullptr)
+        return false;
+
+    uint64_t usedSize = (static_cast<uint64_t>(_offset) + PageSize - 1) & ~(PageSize - 1);
+    bool isOK = true;
+
+    if (usedSize < _capacity)
+    {
+        // The pool starts on a page boundary at _capacity, so stays reserved.
+        isOK = memoryMap.release(_baseAddr + usedSize, _capacity - usedSize);
+    }
+
+    if (isOK)
+    {
+        _capacity = _offset;
+    }
+
+    return isOK;
+}
+
+//! @brief Sets aside memory at the top of the heap for blocks which can be
+//! freed individually.
+//! @param[in] size The count of bytes to set aside, rounded up to a page.
+//! @retval true The pool was created.
+//! @retval false A pool already exists or there was not enough unallocated
+//! space remaining in the heap.
+bool Heap::createPool(size_t size)
+{
+    if ((_base == nullptr) || (_pool != nullptr) || (size == 0))
+        return false;
+
+    uint64_t poolSize = (static_cast<uint64_t>(size) + PageSize - 1) & ~(PageSize - 1);
+    uint64_t poolBase = static_cast<uint64_t>(_capacity) & ~(PageSize - 1);
+
+    if ((poolSize > poolBase) || ((poolBase - poolSize) < _offset))
+        return false;
+
+    poolBase -= poolSize;
+
+    Tlsf *pool = Tlsf::create(_base + poolBase, static_cast<size_t>(poolSize));
+
+    if (pool == nullptr)
+        return false;
+
+    _pool = pool;
+    _poolSize = static_cast<size_t>(poolSize);
+    _capacity = static_cast<size_t>(poolBase);
+
+    return true;
+}
+
+//! @brief Allocates a block from the general purpose pool.
+//! @param[in] size The count of bytes required.
+//! @return A pointer to a block aligned to the native word size or nullptr
+//! if there was no pool or no free block large enough.
+//! @note Allocation runs in O(1) time.
+void *Heap::allocateBlock(size_t size)
+{
+    void *block = (_pool == nullptr) ? nullptr : _pool->allocate(size);
+
+    // Count pool blocks by their actual size, as they will be when freed.
+    HEAP_STATS_ONLY(if (block != nullptr) recordAllocation(Tlsf::getBlockSize(block),
+                                                           Tlsf::getBlockSize(block)));
+
+    return block;
+}
+
+//! @brief Returns a block to the general purpose pool.
+//! @param[in] block A block returned by allocateBlock() or reallocateBlock(),
+//! or nullptr.
+void Heap::freeBlock(void *block)
+{
+    if ((_pool != nullptr) && (block != nullptr))
+    {
+        HEAP_STATS_ONLY(recordFree(Tlsf::getBlockSize(block)));
+        _pool->free(block);
+    }
+}
+
+//! @brief Resizes a block allocated from the general purpose pool.
+//! @param[in] block The block to resize or nullptr to allocate a new one.
+//! @param[in] size The new count of bytes required.
+//! @return A pointer to the resized block, which may have moved, or nullptr
+//! if it couldn't be resized, in which case the original is left intact.
+void *Heap::reallocateBlock(void *block, size_t size)
+{
+    if (_pool == nullptr)
+        return nullptr;
+
+#ifdef BOOT_HEAP_STATS
+    // Account for a reallocation as a free followed by an allocation.
+    size_t oldSize = Tlsf::getBlockSize(block);
+    void *newBlock = _pool->reallocate(block, size);
+
+    if ((newBlock != nullptr) || (size == 0))
+    {
+        if (block != nullptr)
+        {
+            recordFree(oldSize);
+        }
+
+        if (newBlock != nullptr)
+        {
+            recordAllocation(Tlsf::getBlockSize(newBlock), Tlsf::getBlockSize(newBlock));
+        }
+    }
+
+    return newBlock;
+#else
+    return _pool->reallocate(block, size);
+#endif
+}
+
+#ifdef BOOT_HEAP_STATS
+//! @brief Updates the statistics after a block is allocated.
+//! @param[in] size The count of bytes requested.
+//! @param[in] bytesUsed The count of bytes consumed, including padding.
+void Heap::recordAllocation(size_t size, size_t bytesUsed)
+{
+    ++_allocationCounts[getStatsBucket(size)];
+    _bytesInUse += bytesUsed;
+
+    if (_bytesInUse > _peakBytesInUse)
+    {
+        _peakBytesInUse = _bytesInUse;
+    }
+}
+
+//! @brief Updates the statistics after a block is freed.
+//! @param[in] bytesUsed The count of bytes the block consumed.
+void Heap::recordFree(size_t bytesUsed)
+{
+    ++_freeCounts[getStatsBucket(bytesUsed)];
+    _bytesInUse -= bytesUsed;
+}
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 // Global Function Definitions
 ////////////////////////////////////////////////////////////////////////////////
+#ifdef BOOT_HEAP_STATS
+//! @brief Writes a snapshot of heap statistics to a diagnostic output as
+//! human-readable text.
+//! @param[in] stats The statistics to write.
+//! @param[in] sink The function which receives the text.
+void dumpHeapStats(const HeapStats &stats, TextSinkFn sink)
+{
+    if (sink == nullptr)
+        return;
 
-////////////////////////////////////////////////////////////////////////////////
+    writeValue(sink, "Heap: in use ", stats.BytesInUse, " bytes");
+    writeValue(sink, ", peak ", stats.PeakBytesInUse, " bytes\n");
+    writeValue(sink, "Pool: size ", stats.PoolSize, " bytes");
+    writeValue(sink, ", free ", stats.PoolFreeSize, " bytes");
+    writeValue(sink, ", largest free ", stats.LargestFreeBlock, " bytes");
+    writeValue(sink, ", fragmentation ", stats.FragmentationPerMille, "/1000\n");
 
+    uint32_t bucketSize = 16;
+
+    for (uint32_t i = 0; i < HeapStatsBucketCount; ++i, bucketSize <<= 1)
+    {
+        if (i + 1 < HeapStatsBucketCount)
+        {
+            writeValue(sink, "  <= ", bucketSize, ": ");
+        }
+        else
+        {
+            writeValue(sink, "  >  ", bucketSize >> 1, ": ");
+        }
+
+        writeValue(sink, "", stats.AllocationCounts[i], " allocated");
+        writeValue(sink, ", ", stats.FreeCounts[i], " freed\n");
+    }
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
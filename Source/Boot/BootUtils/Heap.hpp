@@ -14,40 +14,108 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Dependent Header Files
 ////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Loader.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Macro Definitions
 ////////////////////////////////////////////////////////////////////////////////
+#ifdef BOOT_HEAP_STATS
+//! @brief Compiles a statement only when heap statistics are being collected.
+#define HEAP_STATS_ONLY(statement) statement
+#else
+#define HEAP_STATS_ONLY(statement)
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 // Data Type Declarations
 ////////////////////////////////////////////////////////////////////////////////
+class MemoryMap;
+class Tlsf;
+
+//! @brief A pointer to a function which writes text to a diagnostic output.
+//! @param[in] text The characters to write, not necessarily null-terminated.
+//! @param[in] length The count of characters in \p text.
+using TextSinkFn = void (*)(const char *text, size_t length);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class Declarations
 ////////////////////////////////////////////////////////////////////////////////
 //! @brief A simple memory and slow allocation system used at boot time.
+//! @details
+//! The heap is an arena carved from the largest block of addressable usable
+//! RAM. Memory is allocated by advancing a pointer and can only be freed in
+//! bulk by returning to a position previously recorded with mark().
+//!
+//! Memory which needs to be freed individually, in any order, can be taken
+//! from a general purpose pool created at the top of the arena with
+//! createPool() and allocated with allocateBlock().
 class Heap
 {
 public:
+    // Public Types
+    //! @brief A position in the heap which can be returned to.
+    using Marker = size_t;
+
+    // Public Constants
+    //! @brief The alignment of allocations when none is specified.
+    static constexpr size_t DefaultAlignment = sizeof(uint64_t);
+
     // Construction/Destruction
+    Heap();
+    ~Heap() = default;
 
     // Accessors
+    uint64_t getBaseAddress() const;
+    size_t getCapacity() const;
+    size_t getUsedSize() const;
+    size_t getPoolSize() const;
+    size_t getPoolFreeSize() const;
+    bool getStats(HeapStats &stats) const;
 
     // Operations
+    bool initialise(MemoryMap &memoryMap, size_t maxSize = SIZE_MAX);
+    void *allocate(size_t size, size_t alignment = DefaultAlignment);
+    Marker mark() const;
+    void release(Marker position);
+    bool commit(MemoryMap &memoryMap);
 
-    // Overrides
-private:
-    // Internal Types
+    bool createPool(size_t size);
+    void *allocateBlock(size_t size);
+    void freeBlock(void *block);
+    void *reallocateBlock(void *block, size_t size);
 
+private:
     // Internal Functions
+#ifdef BOOT_HEAP_STATS
+    void recordAllocation(size_t size, size_t bytesUsed);
+    void recordFree(size_t bytesUsed);
+#endif
 
     // Internal Fields
+    uint8_t *_base;
+    uint64_t _baseAddr;
+    size_t _capacity;
+    size_t _offset;
+    Tlsf *_pool;
+    size_t _poolSize;
+
+#ifdef BOOT_HEAP_STATS
+    uint32_t _allocationCounts[HeapStatsBucketCount];
+    uint32_t _freeCounts[HeapStatsBucketCount];
+    size_t _bytesInUse;
+    size_t _peakBytesInUse;
+#endif
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 // Function Declarations
 ////////////////////////////////////////////////////////////////////////////////
+#ifdef BOOT_HEAP_STATS
+void dumpHeapStats(const HeapStats &stats, TextSinkFn sink);
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 // Templates
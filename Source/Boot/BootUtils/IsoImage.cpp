@@ -0,0 +1,583 @@
+//! @file BootUtils/IsoImage.cpp
+//! @brief The definition of an object which finds and reads files on an
+//! ISO9660 volume on the boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "Heap.hpp"
+#include "IsoImage.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+//! @brief The size of a volume descriptor, which is always one 2 KB sector
+//! of the volume whatever its logical block size.
+constexpr uint8_t DescriptorSizePow2 = 11;
+constexpr size_t DescriptorSize = static_cast<size_t>(1) << DescriptorSizePow2;
+
+//! @brief The smallest logical block size the standard allows.
+constexpr uint8_t MinBlockSizePow2 = 9;
+
+constexpr uint8_t PrimaryVolumeDescriptorType = 1;
+constexpr uint8_t VolumeDescriptorVersion = 1;
+constexpr char StandardIdentifier[] = "CD001";
+
+// Offsets of fields within the primary volume descriptor.
+constexpr size_t PvdTypeOffset = 0;
+constexpr size_t PvdIdentifierOffset = 1;
+constexpr size_t PvdVersionOffset = 6;
+constexpr size_t PvdVolumeSpaceSizeOffset = 80;
+constexpr size_t PvdLogicalBlockSizeOffset = 128;
+constexpr size_t PvdRootRecordOffset = 156;
+
+// Offsets of fields within a directory record.
+constexpr size_t RecordLengthOffset = 0;
+constexpr size_t RecordExtAttrLengthOffset = 1;
+constexpr size_t RecordExtentOffset = 2;
+constexpr size_t RecordDataLengthOffset = 10;
+constexpr size_t RecordFlagsOffset = 25;
+constexpr size_t RecordNameLengthOffset = 32;
+constexpr size_t RecordNameOffset = 33;
+
+//! @brief The largest directory read, which stops a corrupt size
+//! overflowing the size of the allocation which holds it.
+constexpr uint32_t MaxDirectorySize = 0x1000000;
+
+//! @brief The size of a directory record with a 1 character name.
+constexpr uint32_t MinRecordLength = 34;
+
+constexpr uint8_t RecordFlagDirectory = 0x02;
+constexpr uint8_t RecordFlagAssociated = 0x04;
+constexpr uint8_t RecordFlagMultiExtent = 0x80;
+
+//! @brief The names which identify the records of a directory and its parent.
+constexpr uint8_t SelfRecordName = 0x00;
+constexpr uint8_t ParentRecordName = 0x01;
+
+constexpr uint32_t FnvOffsetBasis = 0x811C9DC5;
+constexpr uint32_t FnvPrime = 0x01000193;
+
+//! @brief A multiplier which spreads directory extents across the hash table.
+constexpr uint32_t GoldenRatio32 = 0x9E3779B1;
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Reads a little-endian 16-bit field of a both-byte-order pair.
+uint16_t readLittleEndian16(const uint8_t *bytes)
+{
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+//! @brief Reads a little-endian 32-bit field of a both-byte-order pair.
+uint32_t readLittleEndian32(const uint8_t *bytes)
+{
+    return static_cast<uint32_t>(bytes[0]) |
+           (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) |
+           (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+//! @brief Folds an ASCII letter to upper case, as ISO9660 names are.
+char toUpper(char ch)
+{
+    return ((ch >= 'a') && (ch <= 'z')) ? static_cast<char>(ch - ('a' - 'A')) : ch;
+}
+
+//! @brief Calculates the length of a file name without its ';' version
+//! suffix or the '.' recorded when a file has no extension.
+size_t getBaseNameLength(const char *name, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (name[i] == ';')
+        {
+            length = i;
+            break;
+        }
+    }
+
+    if ((length > 1) && (name[length - 1] == '.'))
+    {
+        --length;
+    }
+
+    return length;
+}
+
+//! @brief Calculates the FNV-1a hash of a name with letters folded to upper
+//! case.
+uint32_t hashName(const char *name, size_t length)
+{
+    uint32_t hash = FnvOffsetBasis;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ static_cast<uint8_t>(toUpper(name[i]))) * FnvPrime;
+    }
+
+    return hash;
+}
+
+//! @brief Compares two names ignoring the case of letters.
+bool areNamesEqual(const char *lhs, const char *rhs, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (toUpper(lhs[i]) != toUpper(rhs[i]))
+            return false;
+    }
+
+    return true;
+}
+
+//! @brief Gets the name of a directory record.
+const char *getRecordName(const uint8_t *record)
+{
+    return reinterpret_cast<const char *>(record + RecordNameOffset);
+}
+
+//! @brief Gets the length of the name of a directory record without its
+//! version suffix.
+size_t getRecordNameLength(const uint8_t *record)
+{
+    return getBaseNameLength(getRecordName(record), record[RecordNameLengthOffset]);
+}
+
+//! @brief Calculates the count of power of 2 sized units needed to hold a
+//! count of bytes.
+uint32_t getUnitCount(uint32_t byteCount, uint8_t unitSizePow2)
+{
+    uint32_t mask = (1u << unitSizePow2) - 1;
+
+    return (byteCount >> unitSizePow2) + (((byteCount & mask) != 0) ? 1 : 0);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// IsoImage Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Constructs an object which must be initialised before use.
+IsoImage::IsoImage() :
+    _heap(nullptr),
+    _reader(nullptr),
+    _buckets(nullptr),
+    _directories(nullptr),
+    _bucketMask(0),
+    _rootBlock(0),
+    _rootSize(0),
+    _volumeBlockCount(0),
+    _directoryCount(0),
+    _directorySectorsRead(0),
+    _sectorSizePow2(0),
+    _blockSizePow2(0)
+{
+}
+
+//! @brief Determines whether a volume was found.
+bool IsoImage::isValid() const { return _reader != nullptr; }
+
+//! @brief Gets the size of the logical blocks of the volume in bytes.
+uint32_t IsoImage::getBlockSize() const
+{
+    return isValid() ? (1u << _blockSizePow2) : 0;
+}
+
+//! @brief Gets the count of logical blocks in the volume.
+uint32_t IsoImage::getVolumeBlockCount() const { return _volumeBlockCount; }
+
+//! @brief Gets the count of directories read so far.
+uint32_t IsoImage::getDirectoryCount() const { return _directoryCount; }
+
+//! @brief Gets the count of boot device sectors read to fetch directories.
+uint32_t IsoImage::getDirectorySectorsRead() const { return _directorySectorsRead; }
+
+//! @brief Gets the count of boot device sectors which readFile() fills.
+//! @details
+//! The buffer passed to readFile() must be large enough to hold this many
+//! sectors, not just the size of the file.
+uint32_t IsoImage::getSectorCount(const IsoFileInfo &file) const
+{
+    return getUnitCount(file.Size, _sectorSizePow2);
+}
+
+//! @brief Finds the primary volume descriptor of the volume on the boot
+//! device and prepares to resolve paths.
+//! @param[in] heap The heap to allocate the directory cache from.
+//! @param[in] device The boot device, whose BootSector field gives the
+//! sector holding the primary volume descriptor.
+//! @param[in] bucketCount The count of buckets in the hash table of names,
+//! rounded up to a power of 2.
+//! @retval true The volume is ready to use.
+//! @retval false There was no usable volume, the object was already
+//! initialised or there was not enough memory.
+bool IsoImage::initialise(Heap &heap, const BootDeviceInfo &device, uint32_t bucketCount)
+{
+    if ((_reader != nullptr) || (device.ReadBootSectors == nullptr) ||
+        (device.SectorSizePow2 > DescriptorSizePow2) ||
+        (bucketCount == 0) || (bucketCount > 0x80000000u))
+    {
+        return false;
+    }
+
+    // Read the descriptor into temporary memory.
+    Heap::Marker marker = heap.mark();
+    uint8_t *descriptor = static_cast<uint8_t *>(heap.allocate(DescriptorSize));
+    uint32_t descriptorSectors = 1u << (DescriptorSizePow2 - device.SectorSizePow2);
+
+    if ((descriptor == nullptr) ||
+        (device.ReadBootSectors(descriptor, device.BootSector,
+                                descriptorSectors) != descriptorSectors))
+    {
+        heap.release(marker);
+        return false;
+    }
+
+    bool isPrimary = (descriptor[PvdTypeOffset] == PrimaryVolumeDescriptorType) &&
+                     (descriptor[PvdVersionOffset] == VolumeDescriptorVersion);
+
+    for (size_t i = 0; isPrimary && (i < sizeof(StandardIdentifier) - 1); ++i)
+    {
+        isPrimary = descriptor[PvdIdentifierOffset + i] ==
+                    static_cast<uint8_t>(StandardIdentifier[i]);
+    }
+
+    uint32_t blockSize = readLittleEndian16(descriptor + PvdLogicalBlockSizeOffset);
+    uint8_t blockSizePow2 = MinBlockSizePow2;
+
+    while ((blockSizePow2 < DescriptorSizePow2) && ((1u << blockSizePow2) != blockSize))
+    {
+        ++blockSizePow2;
+    }
+
+    const uint8_t *root = descriptor + PvdRootRecordOffset;
+    uint32_t rootBlock = readLittleEndian32(root + RecordExtentOffset) +
+                         root[RecordExtAttrLengthOffset];
+    uint32_t rootSize = readLittleEndian32(root + RecordDataLengthOffset);
+    uint32_t volumeBlockCount = readLittleEndian32(descriptor + PvdVolumeSpaceSizeOffset);
+    bool isRootDirectory = (root[RecordFlagsOffset] & RecordFlagDirectory) != 0;
+
+    heap.release(marker);
+
+    // Sectors can't be split, so a block must hold whole sectors.
+    if ((isPrimary == false) || (isRootDirectory == false) || (rootSize == 0) ||
+        ((1u << blockSizePow2) != blockSize) ||
+        (blockSizePow2 < device.SectorSizePow2))
+    {
+        return false;
+    }
+
+    uint32_t roundedCount = 1;
+
+    while (roundedCount < bucketCount)
+    {
+        roundedCount <<= 1;
+    }
+
+    Entry **buckets = static_cast<Entry **>(
+        heap.allocate(sizeof(Entry *) * roundedCount, alignof(Entry *)));
+
+    if (buckets == nullptr)
+        return false;
+
+    for (uint32_t i = 0; i < roundedCount; ++i)
+    {
+        buckets[i] = nullptr;
+    }
+
+    _heap = &heap;
+    _reader = device.ReadBootSectors;
+    _buckets = buckets;
+    _bucketMask = roundedCount - 1;
+    _rootBlock = rootBlock;
+    _rootSize = rootSize;
+    _volumeBlockCount = volumeBlockCount;
+    _sectorSizePow2 = device.SectorSizePow2;
+    _blockSizePow2 = blockSizePow2;
+
+    return true;
+}
+
+//! @brief Finds a file or directory by path.
+//! @param[in] path The null-terminated path of the file relative to the
+//! root directory, with components separated by '/'. Letters can be in
+//! either case and version suffixes are optional.
+//! @param[out] file Receives the location of the file if it was found.
+//! @retval true The file was found.
+//! @retval false The file doesn't exist, a component of the path wasn't a
+//! directory or a directory couldn't be read.
+bool IsoImage::findFile(const char *path, IsoFileInfo &file)
+{
+    if ((isValid() == false) || (path == nullptr))
+        return false;
+
+    uint32_t block = _rootBlock;
+    uint32_t size = _rootSize;
+    bool isDirectory = true;
+
+    while (*path != '\0')
+    {
+        if (*path == '/')
+        {
+            ++path;
+            continue;
+        }
+
+        size_t length = 0;
+
+        while ((path[length] != '\0') && (path[length] != '/'))
+        {
+            ++length;
+        }
+
+        const char *name = path;
+        path += length;
+
+        if ((length == 1) && (name[0] == '.'))
+            continue;
+
+        if (isDirectory == false)
+            return false;
+
+        const Directory *directory = getDirectory(block, size);
+
+        if (directory == nullptr)
+            return false;
+
+        const uint8_t *record = findRecord(directory, name, getBaseNameLength(name, length));
+
+        if ((record == nullptr) || (record[RecordFlagsOffset] & RecordFlagMultiExtent))
+            return false;
+
+        block = readLittleEndian32(record + RecordExtentOffset) +
+                record[RecordExtAttrLengthOffset];
+        size = readLittleEndian32(record + RecordDataLengthOffset);
+        isDirectory = (record[RecordFlagsOffset] & RecordFlagDirectory) != 0;
+    }
+
+    file.StartSector = getBlockSector(block);
+    file.Size = size;
+    file.IsDirectory = isDirectory;
+
+    return true;
+}
+
+//! @brief Reads the whole of a file with a single call to the boot device.
+//! @param[in] file The location of the file, as returned by findFile().
+//! @param[in] destination The memory to receive the file, which must be
+//! large enough for the count of sectors given by getSectorCount().
+//! @return The count of bytes of the file read, which is only less than its
+//! size if the boot device failed.
+uint32_t IsoImage::readFile(const IsoFileInfo &file, void *destination)
+{
+    uint32_t sectorCount = getSectorCount(file);
+
+    if ((isValid() == false) || (sectorCount == 0))
+        return 0;
+
+    uint32_t sectorsRead = _reader(destination, file.StartSector, sectorCount);
+
+    if (sectorsRead >= sectorCount)
+        return file.Size;
+
+    return sectorsRead << _sectorSizePow2;
+}
+
+//! @brief Gets the boot device sector holding the start of a logical block.
+uint64_t IsoImage::getBlockSector(uint32_t block) const
+{
+    return static_cast<uint64_t>(block) << (_blockSizePow2 - _sectorSizePow2);
+}
+
+//! @brief Gets the hash table bucket holding a name within a directory.
+uint32_t IsoImage::getBucket(const Directory *directory, uint32_t hash) const
+{
+    return (hash + (directory->ExtentBlock * GoldenRatio32)) & _bucketMask;
+}
+
+//! @brief Gets the next valid record of a directory.
+//! @param[in] directory The directory to scan.
+//! @param[in,out] offset The offset of the record to start from, updated
+//! to the offset following the record returned.
+//! @return The record or nullptr if there are no more.
+const uint8_t *IsoImage::getNextRecord(const Directory *directory, uint32_t &offset) const
+{
+    const uint32_t blockMask = (1u << _blockSizePow2) - 1;
+
+    while ((offset < directory->Size) &&
+           ((directory->Size - offset) > RecordNameOffset))
+    {
+        const uint8_t *record = directory->Records + offset;
+        uint32_t length = record[RecordLengthOffset];
+
+        if (length == 0)
+        {
+            // Records don't cross blocks, so the rest of this one is padding.
+            offset = (offset | blockMask) + 1;
+            continue;
+        }
+
+        if ((length < MinRecordLength) || (length > (directory->Size - offset)) ||
+            ((RecordNameOffset + record[RecordNameLengthOffset]) > length))
+        {
+            // The directory is corrupt, so ignore the rest of it.
+            break;
+        }
+
+        offset += length;
+
+        return record;
+    }
+
+    offset = directory->Size;
+
+    return nullptr;
+}
+
+//! @brief Gets a directory from the cache, reading and indexing it if this
+//! is the first time it has been used.
+//! @param[in] extentBlock The logical block holding the directory.
+//! @param[in] size The size of the directory in bytes.
+//! @return The directory or nullptr if it couldn't be read.
+IsoImage::Directory *IsoImage::getDirectory(uint32_t extentBlock, uint32_t size)
+{
+    for (Directory *directory = _directories; directory != nullptr;
+         directory = directory->Next)
+    {
+        if (directory->ExtentBlock == extentBlock)
+            return directory;
+    }
+
+    if (size > MaxDirectorySize)
+        return nullptr;
+
+    // Read the entire directory in one call.
+    uint32_t sectorCount = getUnitCount(size, _sectorSizePow2);
+    Heap::Marker marker = _heap->mark();
+    Directory *directory = static_cast<Directory *>(
+        _heap->allocate(sizeof(Directory), alignof(Directory)));
+    uint8_t *records = static_cast<uint8_t *>(
+        _heap->allocate(static_cast<size_t>(sectorCount) << _sectorSizePow2));
+
+    if ((sectorCount == 0) || (directory == nullptr) || (records == nullptr))
+    {
+        _heap->release(marker);
+        return nullptr;
+    }
+
+    uint32_t sectorsRead = _reader(records, getBlockSector(extentBlock), sectorCount);
+    _directorySectorsRead += sectorsRead;
+
+    if (sectorsRead < sectorCount)
+    {
+        _heap->release(marker);
+        return nullptr;
+    }
+
+    directory->ExtentBlock = extentBlock;
+    directory->Size = size;
+    directory->Records = records;
+
+    // Count the named records so that their entries can be allocated at once.
+    uint32_t entryCount = 0;
+    uint32_t offset = 0;
+
+    while (getNextRecord(directory, offset) != nullptr)
+    {
+        ++entryCount;
+    }
+
+    Entry *entries = static_cast<Entry *>(
+        _heap->allocate(sizeof(Entry) * entryCount, alignof(Entry)));
+
+    if ((entries == nullptr) && (entryCount > 0))
+    {
+        _heap->release(marker);
+        return nullptr;
+    }
+
+    offset = 0;
+    bool isContinuation = false;
+
+    for (const uint8_t *record = getNextRecord(directory, offset); record != nullptr;
+         record = getNextRecord(directory, offset))
+    {
+        uint8_t flags = record[RecordFlagsOffset];
+        uint8_t nameLength = record[RecordNameLengthOffset];
+        uint8_t firstChar = record[RecordNameOffset];
+        bool isIndexed = (isContinuation == false) &&
+                         ((flags & RecordFlagAssociated) == 0) &&
+                         ((nameLength != 1) ||
+                          ((firstChar != SelfRecordName) && (firstChar != ParentRecordName)));
+
+        // Only the first record of a file in several extents is indexed, so
+        // that the file is found and rejected rather than read in part.
+        isContinuation = (flags & RecordFlagMultiExtent) != 0;
+
+        if (isIndexed == false)
+            continue;
+
+        Entry &entry = *entries++;
+        uint32_t bucket;
+
+        entry.Parent = directory;
+        entry.Record = record;
+        entry.Hash = hashName(getRecordName(record), getRecordNameLength(record));
+        bucket = getBucket(directory, entry.Hash);
+        entry.Next = _buckets[bucket];
+        _buckets[bucket] = &entry;
+    }
+
+    directory->Next = _directories;
+    _directories = directory;
+    ++_directoryCount;
+
+    return directory;
+}
+
+//! @brief Looks up a name in the records of a directory.
+//! @param[in] directory The directory, which must already be indexed.
+//! @param[in] name The name without its version suffix.
+//! @param[in] nameLength The count of characters in \p name.
+//! @return The directory record or nullptr if it wasn't found.
+const uint8_t *IsoImage::findRecord(const Directory *directory, const char *name,
+                                    size_t nameLength) const
+{
+    uint32_t hash = hashName(name, nameLength);
+
+    for (const Entry *entry = _buckets[getBucket(directory, hash)];
+         entry != nullptr; entry = entry->Next)
+    {
+        if ((entry->Hash == hash) && (entry->Parent == directory) &&
+            (getRecordNameLength(entry->Record) == nameLength) &&
+            areNamesEqual(getRecordName(entry->Record), name, nameLength))
+        {
+            return entry->Record;
+        }
+    }
+
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
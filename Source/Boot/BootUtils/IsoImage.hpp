@@ -0,0 +1,139 @@
+//! @file BootUtils/IsoImage.hpp
+//! @brief The declaration of an object which finds and reads files on an
+//! ISO9660 volume on the boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_ISO_IMAGE_HPP__
+#define __BOOT_UTILS_ISO_IMAGE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Loader.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+class Heap;
+
+//! @brief Describes a file or directory found on an ISO9660 volume.
+struct IsoFileInfo
+{
+    //! @brief The boot device sector holding the first byte of the file.
+    uint64_t StartSector;
+
+    //! @brief The size of the file in bytes.
+    uint32_t Size;
+
+    //! @brief True if the entry is a directory rather than a file.
+    bool IsDirectory;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which resolves paths on the ISO9660 volume holding the
+//! boot loader and reads the files they refer to.
+//! @details
+//! Each directory is read in full with a single call to the boot device the
+//! first time a path passes through it and its extent is kept for the rest
+//! of the boot, so no directory sector is read twice. The records of every
+//! directory read are indexed in a hash table keyed on the directory and the
+//! name, with the version suffix removed and letters folded to upper case,
+//! so that a lookup doesn't scan the directory.
+//!
+//! Only the primary volume descriptor is used, so Joliet and Rock Ridge
+//! names are not visible. Files recorded in more than one extent are not
+//! supported.
+class IsoImage
+{
+public:
+    // Public Constants
+    //! @brief The count of hash table buckets used unless one is specified.
+    static constexpr uint32_t DefaultBucketCount = 256;
+
+    // Construction/Destruction
+    IsoImage();
+    IsoImage(const IsoImage &) = delete;
+    IsoImage &operator=(const IsoImage &) = delete;
+    ~IsoImage() = default;
+
+    // Accessors
+    bool isValid() const;
+    uint32_t getBlockSize() const;
+    uint32_t getVolumeBlockCount() const;
+    uint32_t getDirectoryCount() const;
+    uint32_t getDirectorySectorsRead() const;
+    uint32_t getSectorCount(const IsoFileInfo &file) const;
+
+    // Operations
+    bool initialise(Heap &heap, const BootDeviceInfo &device,
+                    uint32_t bucketCount = DefaultBucketCount);
+    bool findFile(const char *path, IsoFileInfo &file);
+    uint32_t readFile(const IsoFileInfo &file, void *destination);
+
+private:
+    // Internal Types
+    //! @brief The records of a directory read from the volume.
+    struct Directory
+    {
+        uint32_t ExtentBlock;
+        uint32_t Size;
+        const uint8_t *Records;
+        Directory *Next;
+    };
+
+    //! @brief An entry in the hash table of directory records.
+    struct Entry
+    {
+        const Directory *Parent;
+        const uint8_t *Record;
+        uint32_t Hash;
+        Entry *Next;
+    };
+
+    // Internal Functions
+    uint64_t getBlockSector(uint32_t block) const;
+    uint32_t getBucket(const Directory *directory, uint32_t hash) const;
+    const uint8_t *getNextRecord(const Directory *directory, uint32_t &offset) const;
+    Directory *getDirectory(uint32_t extentBlock, uint32_t size);
+    const uint8_t *findRecord(const Directory *directory, const char *name,
+                              size_t nameLength) const;
+
+    // Internal Fields
+    Heap *_heap;
+    ReadBootSectorsFn _reader;
+    Entry **_buckets;
+    Directory *_directories;
+    uint32_t _bucketMask;
+    uint32_t _rootBlock;
+    uint32_t _rootSize;
+    uint32_t _volumeBlockCount;
+    uint32_t _directoryCount;
+    uint32_t _directorySectorsRead;
+    uint8_t _sectorSizePow2;
+    uint8_t _blockSizePow2;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -26,46 +26,58 @@ namespace {
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data Types
 ////////////////////////////////////////////////////////////////////////////////
-using MemMapItemTraits = Collection::ItemTraits<MemMapEntry>;
-
-class MemMapItemComparer : public Collection::IComparer
+//! @brief A function object which orders memory map entries by base address
+//! and then by size, largest first.
+struct MemMapItemComparer
 {
-public:
-    // Public Types
-    using ItemPtr = const MemMapEntry *;
-
-    // Construction/Destruction
-    MemMapItemComparer() = default;
-    virtual ~MemMapItemComparer() = default;
-
-    // Overrides
-    virtual int compare(const void *lhs, const void *rhs) const override
+    int operator()(const MemMapEntry &lhs, const MemMapEntry &rhs) const
     {
         int diff = 0;
 
-        const auto lhsEntry = static_cast<ItemPtr>(lhs);
-        const auto rhsEntry = static_cast<ItemPtr>(rhs);
-
-        if (lhsEntry->BaseAddress == rhsEntry->BaseAddress)
+        if (lhs.BaseAddress == rhs.BaseAddress)
         {
-            if (lhsEntry->Size != rhsEntry->Size)
+            if (lhs.Size != rhs.Size)
             {
-                diff = (lhsEntry->Size > rhsEntry->Size) ? -1 : 1;
+                // Order biggest blocks first when two have the same start address.
+                diff = (lhs.Size > rhs.Size) ? -1 : 1;
             }
         }
         else
         {
-            // Order biggest blocks first when two have the same start address.
-            diff = (lhsEntry->BaseAddress < rhsEntry->BaseAddress) ? -1 : 1;
+            diff = (lhs.BaseAddress < rhs.BaseAddress) ? -1 : 1;
         }
 
         return diff;
     }
 };
 
+//! @brief A function object which extracts the base address of a memory map
+//! entry to be used as a radix sort key.
+struct MemMapBaseKey
+{
+    uint64_t operator()(const MemMapEntry &entry) const
+    {
+        return entry.BaseAddress;
+    }
+};
+
+//! @brief A function object which extracts a radix sort key from a memory
+//! map entry which orders entries largest first.
+struct MemMapInverseSizeKey
+{
+    uint64_t operator()(const MemMapEntry &entry) const
+    {
+        return ~entry.Size;
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief The count of memory map entries above which a radix sort will be
+//! used in preference to a comparison sort, if scratch memory is available.
+constexpr size_t RadixSortThreshold = 64;
+
 #ifdef TEST_BUILD
 struct SimulatedMemoryMap
 {
@@ -74,6 +86,10 @@ struct SimulatedMemoryMap
 };
 
 thread_local SimulatedMemoryMap SimulatedMemory = { 0, 0 };
+
+//! @brief The count of steps taken by memory map sweeps, so that tests can
+//! verify the work done grows linearly with the count of entries.
+thread_local size_t SweepStepCount = 0;
 #endif
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -132,116 +148,443 @@ MemType combineMemoryTypes(MemType lhs, MemType rhs)
     return combinedType;
 }
 
-//! @brief Processes a memory map of possibly overlapping regions into
-//! a set of unique regions in address order.
-//! @param[in,out] entries The array specifying the memory map and to receive
-//! the new memory map entries.
-//! @param[in] count The count of entries in \p entries.
-//! @param[in] tempArray A pointer to an array which can be used as
-//! temporary storage during processing, assumed to be large enough.
-//! @return The new size of the \p entries array or 0 if there was a problem.
-//! @note It is assumed that there is enough space at the end of the \p entries
-//! to accommodate any further array elements.
-size_t consolidateMemoryMap(MemMapEntry *entries, size_t count,
-                            MemMapEntry *tempArray)
+//! @brief Calculates the type of a region after it has been reserved or
+//! released.
+//! @param[in] current The existing type of the region.
+//! @param[in] type The type of memory being reserved.
+//! @param[in] isRelease True to revert types assigned by Helix to usable RAM
+//! rather than reserving memory as \p type.
+//! @return The new type of the region.
+MemType getUpdatedMemoryType(MemType current, MemType type, bool isRelease)
 {
-    size_t consolidatedEntryCount = 0;
+    if (isRelease)
+    {
+        return ((current >= MemType::UsableAfterBoot) && (current < MemType::Max)) ?
+            MemType::UsableRAM : current;
+    }
+
+    return combineMemoryTypes(current, type);
+}
+
+//! @brief Finds a block of directly addressable RAM which no memory map
+//! entry other than usable RAM overlaps, without sorting the entries first.
+//! @param[in] entries The unsorted array of memory map entries to search.
+//! @param[in] count The count of elements in \p entries.
+//! @param[in] minSize The minimum size of the block required, in bytes.
+//! @param[out] baseAddr Receives the physical base address of the block,
+//! aligned to the size of a memory map entry's largest field.
+//! @retval true A suitable block was found.
+//! @retval false No block of at least \p minSize bytes could be found.
+//! @note The search runs in O(n) time, but is conservative. It starts with the
+//! largest usable region and shrinks it, keeping the larger part around each
+//! overlapping entry.
+bool findUnsortedScratchBlock(const MemMapEntry *entries, size_t count,
+                              uint64_t minSize, uint64_t &baseAddr)
+{
+    const MemMapEntry *largest = nullptr;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const MemMapEntry &region = entries[i];
+
+        if ((region.Type == MemType::UsableRAM) &&
+            isDirectlyAddressable(region) &&
+            ((largest == nullptr) || (region.Size > largest->Size)))
+        {
+            largest = &region;
+        }
+    }
 
-    if (count > 0)
+    if (largest == nullptr)
+        return false;
+
+    // Align the start of the block so that it can be accessed as an array.
+    constexpr uint64_t Alignment = sizeof(uint64_t);
+    uint64_t blockStart = (largest->BaseAddress + Alignment - 1) & ~(Alignment - 1);
+    uint64_t blockEnd = largest->BaseAddress + largest->Size;
+
+    for (size_t i = 0; (i < count) && (blockStart < blockEnd); ++i)
     {
-        // Copy the first region into the target array before processing
-        // the rest.
-        consolidatedEntryCount = 1;
-        *tempArray = *entries;
+        const MemMapEntry &region = entries[i];
+        uint64_t regionEnd = region.BaseAddress + region.Size;
+
+        if ((region.Type == MemType::UsableRAM) ||
+            (regionEnd <= blockStart) ||
+            (region.BaseAddress >= blockEnd))
+        {
+            // The region doesn't restrict the block.
+            continue;
+        }
 
-        for (size_t i = 1; i < count; ++i)
+        uint64_t lowerSize = (region.BaseAddress > blockStart) ?
+                                region.BaseAddress - blockStart : 0;
+        uint64_t upperSize = (regionEnd < blockEnd) ? blockEnd - regionEnd : 0;
+
+        if (lowerSize >= upperSize)
         {
-            MemMapEntry &prev = tempArray[consolidatedEntryCount - 1];
-            const MemMapEntry &current = entries[i];
+            blockEnd = blockStart + lowerSize;
+        }
+        else
+        {
+            blockStart = (regionEnd + Alignment - 1) & ~(Alignment - 1);
+        }
+    }
+
+    if ((blockStart >= blockEnd) || ((blockEnd - blockStart) < minSize))
+        return false;
+
+    MemMapEntry block;
+    block.BaseAddress = blockStart;
+    block.Size = minSize;
+    block.Type = MemType::UsableRAM;
+
+    if (isDirectlyAddressable(block) == false)
+        return false;
+
+    baseAddr = blockStart;
+
+    return true;
+}
+
+//! @brief Sorts memory map entries by base address and then by size with
+//! the largest entries first.
+//! @param[in] entries The array of entries to sort.
+//! @param[in] count The count of elements in \p entries.
+void sortMemoryMap(MemMapEntry *entries, size_t count)
+{
+    uint64_t scratchAddr = 0;
+
+    if ((count > RadixSortThreshold) &&
+        findUnsortedScratchBlock(entries, count,
+                                 count * sizeof(MemMapEntry), scratchAddr))
+    {
+        // Sort on the least significant key first, then the most significant
+        // key, relying on the stability of the sort.
+        MemMapEntry *scratch = getAddress<MemMapEntry>(scratchAddr);
+
+        Collection::radixSort(entries, count, scratch, MemMapInverseSizeKey());
+        Collection::radixSort(entries, count, scratch, MemMapBaseKey());
+    }
+    else
+    {
+        Collection::sort(entries, count, MemMapItemComparer());
+    }
+}
+
+//! @brief An object which sweeps through a sorted memory map of possibly
+//! overlapping entries, producing a sequence of distinct regions in address
+//! order.
+//! @details
+//! The sweep keeps the furthest end address of each type of memory which
+//! covers the current position. Since entries are visited in base address
+//! order, that is all that is needed to know the combined type of memory at
+//! any point, so the sweep needs no storage proportional to the count of
+//! entries and each boundary is visited once.
+class MemoryMapSweep
+{
+public:
+    // Construction/Destruction
+    MemoryMapSweep(const MemMapEntry *entries, size_t count) :
+        _entries(entries),
+        _count(count),
+        _nextEntry(0),
+        _position(0),
+        _activeCount(0),
+        _hasPending(false),
+        _hasFailed(false)
+    {
+        _pending.BaseAddress = 0;
+        _pending.Size = 0;
+        _pending.Type = MemType::Unknown;
+    }
+
+    // Accessors
+    //! @brief Determines if the sweep had to stop because too many
+    //! distinct types of memory overlapped.
+    bool hasFailed() const { return _hasFailed; }
+
+    //! @brief Gets the count of entries which the sweep has read so far.
+    size_t getConsumedCount() const { return _nextEntry; }
+
+    // Operations
+    //! @brief Gets the next distinct region of memory, merging adjacent
+    //! regions of the same type.
+    //! @param[out] region Receives the region definition.
+    //! @retval true A region was returned.
+    //! @retval false There were no further regions.
+    bool next(MemMapEntry &region)
+    {
+        if ((_hasPending == false) && (nextSegment(_pending) == false))
+            return false;
 
-            uint64_t prevEnd = prev.BaseAddress + prev.Size;
-            uint64_t currentEnd = current.BaseAddress + current.Size;
-            uint64_t delta = current.BaseAddress - prev.BaseAddress;
+        region = _pending;
+        _hasPending = false;
 
-            if (current.BaseAddress < prevEnd)
+        while (nextSegment(_pending))
+        {
+            if ((_pending.BaseAddress == (region.BaseAddress + region.Size)) &&
+                (_pending.Type == region.Type))
             {
-                // The entries overlap, split entries accordingly.
-                if (delta > 0)
+                region.Size += _pending.Size;
+            }
+            else
+            {
+                _hasPending = true;
+                break;
+            }
+        }
+
+        return true;
+    }
+private:
+    // Internal Types
+    struct ActiveType
+    {
+        uint64_t End;
+        MemType Type;
+    };
+
+    // Internal Constants
+    static constexpr size_t MaxActiveTypes = 16;
+
+    // Internal Functions
+    //! @brief Records a unit of work performed by the sweep in test builds.
+    static void countStep()
+    {
+#ifdef TEST_BUILD
+        ++SweepStepCount;
+#endif
+    }
+
+    //! @brief Records that a type of memory covers the current position up
+    //! to a specified end address.
+    void activate(MemType type, uint64_t end)
+    {
+        for (size_t i = 0; i < _activeCount; ++i)
+        {
+            countStep();
+
+            if (_active[i].Type == type)
+            {
+                if (end > _active[i].End)
                 {
-                    // Create a copy of the first block to restrict it's size.
-                    MemMapEntry &next = tempArray[consolidatedEntryCount++];
-                    next = prev;
-                    prev.Size = delta;
-                    next.BaseAddress += delta;
-                    next.Size -= delta;
+                    _active[i].End = end;
                 }
 
-                // Now deal with blocks with the same base address.
-                if (currentEnd == prevEnd)
-                {
-                    // The blocks wholly overlap.
-                    MemMapEntry &next = tempArray[consolidatedEntryCount - 1];
+                return;
+            }
+        }
+
+        if (_activeCount < MaxActiveTypes)
+        {
+            _active[_activeCount].End = end;
+            _active[_activeCount].Type = type;
+            ++_activeCount;
+        }
+        else
+        {
+            _hasFailed = true;
+        }
+    }
 
-                    next.Type = combineMemoryTypes(next.Type, current.Type);
+    //! @brief Removes types of memory which end at or before the current
+    //! position.
+    void deactivate()
+    {
+        size_t j = 0;
+
+        for (size_t i = 0; i < _activeCount; ++i)
+        {
+            countStep();
+
+            if (_active[i].End > _position)
+            {
+                _active[j++] = _active[i];
+            }
+        }
+
+        _activeCount = j;
+    }
+
+    //! @brief Gets the next run of memory with a uniform combined type,
+    //! without merging it with adjacent runs of the same type.
+    bool nextSegment(MemMapEntry &segment)
+    {
+        while (_hasFailed == false)
+        {
+            deactivate();
+
+            if (_activeCount == 0)
+            {
+                // Skip any gap in the memory map.
+                if (_nextEntry == _count)
+                    return false;
+
+                if (_entries[_nextEntry].BaseAddress > _position)
+                {
+                    _position = _entries[_nextEntry].BaseAddress;
                 }
-                else if (currentEnd < prevEnd)
+            }
+
+            // Add all entries which start at the current position.
+            while ((_nextEntry < _count) &&
+                   (_entries[_nextEntry].BaseAddress <= _position))
+            {
+                const MemMapEntry &entry = _entries[_nextEntry++];
+                countStep();
+
+                uint64_t end = entry.BaseAddress + entry.Size;
+
+                if (end > _position)
                 {
-                    // Create a shared entry followed by the rest of the
-                    // previous entry.
-                    MemMapEntry &shared = tempArray[consolidatedEntryCount - 1];
-                    MemMapEntry &next = tempArray[consolidatedEntryCount++];
-
-                    next = shared;
-                    next.BaseAddress = currentEnd;
-                    shared.Size = current.Size;
-                    next.Size -= current.Size;
-                    shared.Type = combineMemoryTypes(shared.Type, current.Type);
+                    activate(entry.Type, end);
                 }
-                else // if (prevEnd < currentEnd)
+            }
+
+            if (_activeCount == 0)
+                continue;
+
+            // The segment ends when the next type of memory starts or ends.
+            uint64_t end = _active[0].End;
+            MemType type = _active[0].Type;
+
+            for (size_t i = 1; i < _activeCount; ++i)
+            {
+                countStep();
+
+                if (_active[i].End < end)
                 {
-                    // Create a shared entry followed by the rest of the
-                    // current entry.
-                    MemMapEntry &shared = tempArray[consolidatedEntryCount - 1];
-                    MemMapEntry &next = tempArray[consolidatedEntryCount++];
-
-                    next = current;
-                    next.BaseAddress = prevEnd;
-                    next.Size = currentEnd - prevEnd;
-                    shared.Type = combineMemoryTypes(shared.Type, current.Type);
+                    end = _active[i].End;
                 }
+
+                type = combineMemoryTypes(type, _active[i].Type);
             }
-            else
+
+            if ((_nextEntry < _count) && (_entries[_nextEntry].BaseAddress < end))
             {
-                // Copy the current entry to the new array.
-                tempArray[consolidatedEntryCount++] = current;
+                end = _entries[_nextEntry].BaseAddress;
             }
+
+            segment.BaseAddress = _position;
+            segment.Size = end - _position;
+            segment.Type = type;
+            _position = end;
+
+            return true;
         }
 
-        // Overwrite the original array with the temporary values, merging
-        // any consecutive regions of the same type.
-        entries[0] = tempArray[0];
-        size_t j = 1;
+        return false;
+    }
+
+    // Internal Fields
+    const MemMapEntry *_entries;
+    size_t _count;
+    size_t _nextEntry;
+    uint64_t _position;
+    ActiveType _active[MaxActiveTypes];
+    size_t _activeCount;
+    MemMapEntry _pending;
+    bool _hasPending;
+    bool _hasFailed;
+};
 
-        for (size_t i = 1; i < consolidatedEntryCount; ++i)
+//! @brief Processes a sorted memory map of possibly overlapping regions into
+//! a set of unique regions in address order.
+//! @param[in,out] entries The array specifying the memory map and to receive
+//! the new memory map entries.
+//! @param[in] count The count of entries in \p entries.
+//! @param[in] capacity The maximum count of elements \p entries can hold.
+//! @return The new size of the \p entries array or 0 if there was a problem.
+//! @details
+//! A first sweep over the entries counts the distinct regions and measures
+//! how far the output would overtake the input if it was written over it.
+//! If the slack at the end of \p entries can absorb that, the input is
+//! moved up by that much and a second sweep writes the regions in place,
+//! otherwise they are written to the largest addressable block of usable RAM
+//! and copied back. All sweeps run in O(n) time.
+size_t consolidateMemoryMap(MemMapEntry *entries, size_t count, size_t capacity)
+{
+    MemoryMapSweep measure(entries, count);
+    MemMapEntry region;
+    size_t consolidatedEntryCount = 0;
+    size_t displacement = 0;
+    uint64_t bestBaseAddr = 0;
+    uint64_t bestSize = 0;
+
+    while (measure.next(region))
+    {
+        ++consolidatedEntryCount;
+
+        // Every entry the sweep has yet to read must stay ahead of the
+        // region about to be written.
+        size_t consumedCount = measure.getConsumedCount();
+
+        if (consolidatedEntryCount > (consumedCount + displacement))
         {
-            MemMapEntry &prev = entries[j - 1];
-            MemMapEntry &next = tempArray[i];
-            uint64_t prevEnd = prev.BaseAddress + prev.Size;
+            displacement = consolidatedEntryCount - consumedCount;
+        }
 
-            if ((next.BaseAddress == prevEnd) &&
-                (prev.Type == next.Type))
-            {
-                // The regions should be merged.
-                prev.Size += next.Size;
-            }
-            else
+        if ((region.Type == MemType::UsableRAM) &&
+            isDirectlyAddressable(region) &&
+            (region.Size > bestSize))
+        {
+            bestBaseAddr = region.BaseAddress;
+            bestSize = region.Size;
+        }
+    }
+
+    if (measure.hasFailed() || (consolidatedEntryCount == 0) ||
+        (consolidatedEntryCount > capacity))
+    {
+        return 0;
+    }
+
+    if (displacement <= (capacity - count))
+    {
+        // Move the input entries up into the slack so that the output
+        // never overwrites an entry before it has been read.
+        if (displacement > 0)
+        {
+            for (size_t i = count; i > 0; --i)
             {
-                // The regions are distinct.
-                entries[j++] = next;
+                entries[i + displacement - 1] = entries[i - 1];
             }
         }
 
-        consolidatedEntryCount = j;
+        MemoryMapSweep sweep(entries + displacement, count);
+        size_t i = 0;
+
+        while (sweep.next(region))
+        {
+            entries[i++] = region;
+        }
+    }
+    else
+    {
+        // Align the temporary array so that it can be accessed efficiently.
+        constexpr uint64_t Alignment = sizeof(uint64_t);
+        uint64_t alignedBaseAddr = (bestBaseAddr + Alignment - 1) & ~(Alignment - 1);
+        uint64_t minSizeRequired = (consolidatedEntryCount * sizeof(MemMapEntry)) +
+                                   (alignedBaseAddr - bestBaseAddr);
+
+        if (bestSize < minSizeRequired)
+            return 0;
+
+        // Convert the physical address to a linear address, which will
+        // be in a thread-local memory slab if TEST_BUILD defined.
+        MemMapEntry *tempArray = getAddress<MemMapEntry>(alignedBaseAddr);
+        MemoryMapSweep sweep(entries, count);
+        size_t i = 0;
+
+        while (sweep.next(tempArray[i]))
+        {
+            ++i;
+        }
+
+        for (i = 0; i < consolidatedEntryCount; ++i)
+        {
+            entries[i] = tempArray[i];
+        }
     }
 
     return consolidatedEntryCount;
@@ -255,7 +598,10 @@ size_t consolidateMemoryMap(MemMapEntry *entries, size_t count,
 //! @brief Constructs an object to manage the system memory map during boot time.
 MemoryMap::MemoryMap() :
     _allRegions(nullptr),
-    _regionCount(0)
+    _regionCount(0),
+    _capacity(0),
+    _indexStride(1),
+    _indexCount(0)
 {
 }
 
@@ -276,100 +622,339 @@ bool MemoryMap::isRegionAccessable(size_t index) const
                                     false;
 }
 
+//! @brief Finds the region which contains a physical address.
+//! @param[in] address The physical address to look up.
+//! @return A pointer to the region containing \p address or nullptr if the
+//! address is not described by the memory map.
+//! @note The search runs in O(log n) time.
+const MemMapEntry *MemoryMap::findRegion(uint64_t address) const
+{
+    size_t index = countRegionsStartingAtOrBelow(address);
+
+    if (index == 0)
+        return nullptr;
+
+    const MemMapEntry &region = _allRegions[index - 1];
+
+    return ((address - region.BaseAddress) < region.Size) ? &region : nullptr;
+}
+
+//! @brief Finds the set of regions which overlap a range of physical
+//! addresses.
+//! @param[in] baseAddr The physical address of the start of the range.
+//! @param[in] size The count of bytes in the range.
+//! @param[out] count Receives the count of consecutive regions overlapping
+//! the range.
+//! @return A pointer to the first region overlapping the range or nullptr if
+//! no regions overlap it.
+//! @note The search runs in O(log n) time. Gaps in the memory map within the
+//! range are not reported.
+const MemMapEntry *MemoryMap::findRegionsInRange(uint64_t baseAddr, uint64_t size,
+                                                 size_t &count) const
+{
+    count = 0;
+
+    if (size == 0)
+        return nullptr;
+
+    // Clamp the range rather than letting it wrap around.
+    uint64_t lastAddr = baseAddr + (size - 1);
+
+    if (lastAddr < baseAddr)
+    {
+        lastAddr = UINT64_MAX;
+    }
+
+    size_t first = countRegionsStartingAtOrBelow(baseAddr);
+
+    if ((first > 0) &&
+        ((baseAddr - _allRegions[first - 1].BaseAddress) < _allRegions[first - 1].Size))
+    {
+        // The range starts part-way through a region.
+        --first;
+    }
+
+    size_t last = countRegionsStartingAtOrBelow(lastAddr);
+
+    if (last <= first)
+        return nullptr;
+
+    count = last - first;
+
+    return _allRegions + first;
+}
+
+//! @brief Marks a range of memory as being used for a specific purpose.
+//! @param[in] baseAddr The physical address of the start of the range.
+//! @param[in] size The count of bytes in the range.
+//! @param[in] type The type of memory to apply to the range, which is combined
+//! with the existing type of each region it overlaps.
+//! @retval true The range was reserved.
+//! @retval false The range was not wholly described by the memory map or
+//! there was not enough capacity to split the regions at either end.
+//! @note Only the regions overlapping the range and their immediate
+//! neighbours are updated.
+bool MemoryMap::reserve(uint64_t baseAddr, uint64_t size, MemType type)
+{
+    uint64_t endAddr = baseAddr + size;
+    size_t count = 0;
+    const MemMapEntry *regions = findRegionsInRange(baseAddr, size, count);
+
+    if ((regions == nullptr) || (endAddr < baseAddr) ||
+        (regions->BaseAddress > baseAddr))
+    {
+        return false;
+    }
+
+    // Ensure there are no gaps in the memory map within the range.
+    for (size_t i = 1; i < count; ++i)
+    {
+        if (regions[i].BaseAddress != (regions[i - 1].BaseAddress + regions[i - 1].Size))
+            return false;
+    }
+
+    const MemMapEntry &lastRegion = regions[count - 1];
+
+    if ((lastRegion.BaseAddress + lastRegion.Size) < endAddr)
+        return false;
+
+    return retypeRegions(static_cast<size_t>(regions - _allRegions), count,
+                         baseAddr, endAddr, type, false);
+}
+
+//! @brief Returns memory reserved for Helix within a range to usable RAM.
+//! @param[in] baseAddr The physical address of the start of the range.
+//! @param[in] size The count of bytes in the range.
+//! @retval true Any memory in the range reserved for Helix was released.
+//! @retval false There was not enough capacity to split the regions at
+//! either end of the range.
+//! @note Memory reserved by the firmware is left unchanged.
+bool MemoryMap::release(uint64_t baseAddr, uint64_t size)
+{
+    uint64_t endAddr = baseAddr + size;
+    size_t count = 0;
+    const MemMapEntry *regions = findRegionsInRange(baseAddr, size, count);
+
+    if (endAddr < baseAddr)
+    {
+        endAddr = UINT64_MAX;
+    }
+
+    return (regions == nullptr) ? true :
+        retypeRegions(static_cast<size_t>(regions - _allRegions), count,
+                      baseAddr, endAddr, MemType::UsableRAM, true);
+}
+
 //! @brief Initialises the memory map from an unordered and possibly
 //! overlapping set of memory regions.
-//! @param[in] entries The array of entries stored in static memory with an
-//! capacity expected to be able to accommodate any increases in size.
+//! @param[in] entries The array of entries stored in static memory.
 //! @param[in] count The count of elements in \p entries.
+//! @param[in] capacity The maximum count of elements \p entries can hold.
+//! Any slack beyond \p count allows the map to be consolidated in place.
 //! @return A boolean value indicating whether initialisation was successful.
-bool MemoryMap::initialise(MemMapEntry *entries, size_t count)
+bool MemoryMap::initialise(MemMapEntry *entries, size_t count, size_t capacity)
 {
     bool isOK = false;
 
     _allRegions = entries;
 
-    if (_allRegions == nullptr)
+    if ((_allRegions == nullptr) || (capacity < count))
     {
         _regionCount = 0;
+        _capacity = 0;
     }
     else
     {
         _regionCount = count;
+        _capacity = capacity;
 
         // Sort the regions into address and then size order.
-        MemMapItemTraits regionTraits;
-        MemMapItemComparer comparer;
+        sortMemoryMap(entries, count);
 
-        Collection::sort(&regionTraits, &comparer, entries, count);
+        // Resolve overlapping regions.
+        _regionCount = consolidateMemoryMap(_allRegions, _regionCount, _capacity);
+        isOK = (_regionCount > 0);
+    }
 
-        // Calculate the required size of a temporary block of memory in which
-        // to process the regions into.
-        size_t minSizeRequired = (_regionCount * 2) * sizeof(MemMapEntry);
-        uint64_t bestBaseAddr = 0;
-        uint64_t bestSize = 0;
+    rebuildIndex();
 
-        // Find a block of memory to use as temporary storage for the
-        // consolidated memory map entries.
-        for (size_t i = 0; i < _regionCount; ++i)
-        {
-            const MemMapEntry &region = _allRegions[i];
+    return isOK;
+}
 
-            if ((region.Type == MemType::UsableRAM) &&
-                isDirectlyAddressable(region) &&
-                (region.Size > bestSize))
-            {
-                // Copy the region and see if it gets reduced by later
-                // defined regions.
-                uint64_t usableBase = region.BaseAddress;
-                uint64_t usableEnd = usableBase + region.Size;
+//! @brief Samples the base addresses of regions at regular intervals so that
+//! searches can be narrowed down without touching most of the region array.
+void MemoryMap::rebuildIndex()
+{
+    _indexStride = (_regionCount + IndexSize - 1) / IndexSize;
 
-                for (auto j = i + 1; j < _regionCount; ++j)
-                {
-                    const MemMapEntry &nextRegion = _allRegions[j];
-
-                    if (nextRegion.BaseAddress >= usableEnd)
-                        break;
-
-                    if (nextRegion.BaseAddress == usableBase)
-                    {
-                        usableBase += nextRegion.Size;
-                    }
-                    else if (nextRegion.BaseAddress < usableEnd)
-                    {
-                        usableEnd = nextRegion.BaseAddress;
-                    }
-                }
+    if (_indexStride == 0)
+    {
+        _indexStride = 1;
+    }
 
-                if (usableBase < usableEnd)
-                {
-                    uint64_t usableSize = usableEnd - usableBase;
-
-                    if (usableSize > minSizeRequired)
-                    {
-                        bestBaseAddr = usableBase;
-                        bestSize = usableSize;
-                        minSizeRequired = usableSize;
-                    }
-                }
-            }
+    _indexCount = 0;
+
+    for (size_t i = 0; i < _regionCount; i += _indexStride)
+    {
+        _indexKeys[_indexCount++] = _allRegions[i].BaseAddress;
+    }
+}
+
+//! @brief Updates the type of a set of consecutive regions, splitting those
+//! at either end and merging the results with their neighbours.
+//! @param[in] first The index of the first region overlapping the range.
+//! @param[in] count The count of regions overlapping the range.
+//! @param[in] baseAddr The physical address of the start of the range.
+//! @param[in] endAddr The physical address of the end of the range.
+//! @param[in] type The type of memory being reserved.
+//! @param[in] isRelease True to release memory rather than reserve it.
+//! @retval true The regions were updated.
+//! @retval false There was not enough capacity to split the end regions.
+bool MemoryMap::retypeRegions(size_t first, size_t count, uint64_t baseAddr,
+                              uint64_t endAddr, MemType type, bool isRelease)
+{
+    size_t last = first + count - 1;
+    const MemMapEntry &head = _allRegions[first];
+    const MemMapEntry &tail = _allRegions[last];
+
+    // Only split regions which would change type.
+    bool splitHead = (head.BaseAddress < baseAddr) &&
+                     (getUpdatedMemoryType(head.Type, type, isRelease) != head.Type);
+    bool splitTail = ((tail.BaseAddress + tail.Size) > endAddr) &&
+                     (getUpdatedMemoryType(tail.Type, type, isRelease) != tail.Type);
+    size_t extraCount = (splitHead ? 1 : 0) + (splitTail ? 1 : 0);
+
+    if ((_regionCount + extraCount) > _capacity)
+        return false;
+
+    if (splitHead)
+    {
+        splitRegion(first, baseAddr);
+        ++first;
+        ++last;
+    }
+
+    if (splitTail)
+    {
+        splitRegion(last, endAddr);
+    }
+
+    for (size_t i = first; i <= last; ++i)
+    {
+        _allRegions[i].Type = getUpdatedMemoryType(_allRegions[i].Type, type,
+                                                   isRelease);
+    }
+
+    // Merge the updated regions with each other and their neighbours.
+    size_t low = (first > 0) ? first - 1 : 0;
+    size_t high = ((last + 1) < _regionCount) ? last + 2 : _regionCount;
+    size_t output = low;
+
+    for (size_t i = low + 1; i < high; ++i)
+    {
+        MemMapEntry &previous = _allRegions[output];
+        const MemMapEntry &current = _allRegions[i];
+
+        if ((previous.Type == current.Type) &&
+            ((previous.BaseAddress + previous.Size) == current.BaseAddress))
+        {
+            previous.Size += current.Size;
         }
+        else
+        {
+            _allRegions[++output] = current;
+        }
+    }
 
-        if (bestSize > 0)
+    size_t removedCount = high - (output + 1);
+
+    if (removedCount > 0)
+    {
+        for (size_t i = high; i < _regionCount; ++i)
         {
-            // We have found an addressable region of memory we can use
-            // for temporary storage.
+            _allRegions[i - removedCount] = _allRegions[i];
+        }
+
+        _regionCount -= removedCount;
+    }
+
+    rebuildIndex();
+
+    return true;
+}
+
+//! @brief Splits a region in two, moving subsequent regions up to make room.
+//! @param[in] index The index of the region to split.
+//! @param[in] splitAddr The physical address at which the second region
+//! should start, which must lie within the region.
+void MemoryMap::splitRegion(size_t index, uint64_t splitAddr)
+{
+    for (size_t i = _regionCount; i > (index + 1); --i)
+    {
+        _allRegions[i] = _allRegions[i - 1];
+    }
+
+    MemMapEntry &lower = _allRegions[index];
+    MemMapEntry &upper = _allRegions[index + 1];
+
+    upper = lower;
+    upper.BaseAddress = splitAddr;
+    upper.Size = (lower.BaseAddress + lower.Size) - splitAddr;
+    lower.Size = splitAddr - lower.BaseAddress;
+    ++_regionCount;
+}
+
+//! @brief Counts the regions which start at or below a physical address.
+//! @param[in] address The physical address to search for.
+//! @return The index of the first region starting above \p address.
+size_t MemoryMap::countRegionsStartingAtOrBelow(uint64_t address) const
+{
+    // Find the sampled bucket which the address falls within.
+    size_t low = 0;
+    size_t high = _indexCount;
+
+    while (low < high)
+    {
+        size_t middle = low + ((high - low) / 2);
+
+        if (_indexKeys[middle] <= address)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == 0)
+        return 0;
 
-            // Convert the physical address to a linear address, which will
-            // be in a thread-local memory slab if TEST_BUILD defined.
-            MemMapEntry *tempArray = getAddress<MemMapEntry>(bestBaseAddr);
+    // Search the regions within the bucket, the first of which is known to
+    // start at or below the address.
+    high = low * _indexStride;
+    low = ((low - 1) * _indexStride) + 1;
+
+    if (high > _regionCount)
+    {
+        high = _regionCount;
+    }
 
-            _regionCount = consolidateMemoryMap(_allRegions, _regionCount, tempArray);
+    while (low < high)
+    {
+        size_t middle = low + ((high - low) / 2);
 
-            isOK = (_regionCount > 0);
+        if (_allRegions[middle].BaseAddress <= address)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
         }
     }
 
-    return isOK;
+    return low;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -398,6 +983,10 @@ void setSystemBase(void *baseAddr, uintptr_t size)
     SimulatedMemory.BaseAddr = reinterpret_cast<uintptr_t>(baseAddr);
     SimulatedMemory.Size = (baseAddr == 0) ? 0 : size;
 }
+
+size_t getSweepStepCount() { return SweepStepCount; }
+
+void resetSweepStepCount() { SweepStepCount = 0; }
 #endif
 
 
@@ -23,6 +23,7 @@
 // Data Type Declarations
 ////////////////////////////////////////////////////////////////////////////////
 struct MemMapEntry;
+enum class MemType : uint8_t;
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class Declarations
@@ -39,19 +40,37 @@ public:
     size_t getRegionCount() const;
     const MemMapEntry *getRegions() const;
     bool isRegionAccessable(size_t index) const;
+    const MemMapEntry *findRegion(uint64_t address) const;
+    const MemMapEntry *findRegionsInRange(uint64_t baseAddr, uint64_t size,
+                                          size_t &count) const;
 
     // Operations
-    bool initialise(MemMapEntry *entries, size_t count);
+    bool initialise(MemMapEntry *entries, size_t count, size_t capacity);
+    bool reserve(uint64_t baseAddr, uint64_t size, MemType type);
+    bool release(uint64_t baseAddr, uint64_t size);
 
     // Overrides
 private:
     // Internal Types
 
+    // Internal Constants
+    //! @brief The count of region base addresses sampled to narrow a search.
+    static constexpr size_t IndexSize = 16;
+
     // Internal Functions
+    void rebuildIndex();
+    bool retypeRegions(size_t first, size_t count, uint64_t baseAddr,
+                       uint64_t endAddr, MemType type, bool isRelease);
+    void splitRegion(size_t index, uint64_t splitAddr);
+    size_t countRegionsStartingAtOrBelow(uint64_t address) const;
 
     // Internal Fields
     MemMapEntry *_allRegions;
     size_t _regionCount;
+    size_t _capacity;
+    size_t _indexStride;
+    size_t _indexCount;
+    uint64_t _indexKeys[IndexSize];
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -62,6 +81,8 @@ private:
 // Functions used to simulate the target memory map while testing.
 void *getSystemBase();
 void setSystemBase(void *baseAddr, uintptr_t size);
+size_t getSweepStepCount();
+void resetSweepStepCount();
 #else
 constexpr void *getSystemBase() noexcept { return nullptr; }
 #endif
@@ -0,0 +1,63 @@
+//! @file BootUtils/MemoryTools.hpp
+//! @brief The declaration of simple functions which operate on blocks of
+//! memory in place of those in a run-time library.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_MEMORY_TOOLS_HPP__
+#define __BOOT_UTILS_MEMORY_TOOLS_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Memory {
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Copies a block of memory a word at a time where both blocks are
+//! word-aligned, otherwise a byte at a time.
+//! @param[in] destination The memory to copy to.
+//! @param[in] source The memory to copy from, which must not overlap
+//! \p destination.
+//! @param[in] size The count of bytes to copy.
+inline void copy(void *destination, const void *source, size_t size)
+{
+    constexpr uintptr_t WordMask = sizeof(size_t) - 1;
+    uint8_t *byteTarget = static_cast<uint8_t *>(destination);
+    const uint8_t *byteSource = static_cast<const uint8_t *>(source);
+
+    if (((reinterpret_cast<uintptr_t>(destination) |
+          reinterpret_cast<uintptr_t>(source)) & WordMask) == 0)
+    {
+        size_t *wordTarget = static_cast<size_t *>(destination);
+        const size_t *wordSource = static_cast<const size_t *>(source);
+        size_t wordCount = size / sizeof(size_t);
+
+        for (size_t i = 0; i < wordCount; ++i)
+        {
+            wordTarget[i] = wordSource[i];
+        }
+
+        byteTarget += wordCount * sizeof(size_t);
+        byteSource += wordCount * sizeof(size_t);
+        size %= sizeof(size_t);
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        byteTarget[i] = byteSource[i];
+    }
+}
+
+} // namespace Memory
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
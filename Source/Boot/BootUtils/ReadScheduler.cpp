@@ -0,0 +1,398 @@
+//! @file BootUtils/ReadScheduler.cpp
+//! @brief The definition of an object which reduces the count of calls made
+//! to read from the boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "CollectionTools.hpp"
+#include "Heap.hpp"
+#include "MemoryTools.hpp"
+#include "ReadScheduler.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+//! @brief The largest sector size supported, 64 KB.
+constexpr uint8_t MaxSectorSizePow2 = 16;
+
+//! @brief A sector index used to indicate that there is no read history.
+constexpr uint64_t NoSector = UINT64_MAX;
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// ReadScheduler Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Constructs a scheduler which must be initialised before use.
+ReadScheduler::ReadScheduler() :
+    _reader(nullptr),
+    _buffer(nullptr),
+    _pending(nullptr),
+    _bufferStart(0),
+    _nextSector(NoSector),
+    _bufferCount(0),
+    _windowSize(0),
+    _queueCapacity(0),
+    _pendingCount(0),
+    _modeSwitchCount(0),
+    _unscheduledSwitchCount(0),
+    _sectorSizePow2(0)
+{
+}
+
+//! @brief Gets the maximum count of sectors read in a single transfer.
+uint32_t ReadScheduler::getWindowSize() const { return _windowSize; }
+
+//! @brief Gets the count of queued reads waiting to be flushed.
+uint32_t ReadScheduler::getPendingCount() const { return _pendingCount; }
+
+//! @brief Gets the count of transfers made, each of which costs a switch to
+//! real mode and back.
+uint32_t ReadScheduler::getModeSwitchCount() const { return _modeSwitchCount; }
+
+//! @brief Gets the count of transfers which would have been made had each
+//! request been passed straight to the boot device.
+uint32_t ReadScheduler::getUnscheduledSwitchCount() const
+{
+    return _unscheduledSwitchCount;
+}
+
+//! @brief Gets the count of transfers avoided by scheduling.
+uint32_t ReadScheduler::getSavedSwitchCount() const
+{
+    return (_unscheduledSwitchCount > _modeSwitchCount) ?
+                _unscheduledSwitchCount - _modeSwitchCount : 0;
+}
+
+//! @brief Allocates the staging buffer and request queue.
+//! @param[in] heap The heap to allocate from.
+//! @param[in] reader The function which reads sectors from the boot device.
+//! @param[in] sectorSizePow2 The size of sectors as a power of 2.
+//! @param[in] windowSize The count of sectors the boot device can read in a
+//! single transfer, which is the size of each read-ahead.
+//! @param[in] queueCapacity The maximum count of reads which can be queued.
+//! @retval true The scheduler is ready to use.
+//! @retval false The parameters were invalid, the scheduler was already
+//! initialised or there was not enough memory.
+bool ReadScheduler::initialise(Heap &heap, ReadBootSectorsFn reader,
+                               uint8_t sectorSizePow2, uint32_t windowSize,
+                               uint32_t queueCapacity)
+{
+    if ((_reader != nullptr) || (reader == nullptr) || (windowSize == 0) ||
+        (sectorSizePow2 > MaxSectorSizePow2) ||
+        (windowSize > (SIZE_MAX >> (sectorSizePow2 + 1))) ||
+        (queueCapacity > (SIZE_MAX / sizeof(PendingRead))))
+    {
+        return false;
+    }
+
+    uint8_t *buffer = static_cast<uint8_t *>(
+        heap.allocate(static_cast<size_t>(windowSize) << sectorSizePow2));
+    PendingRead *pending = nullptr;
+
+    if (queueCapacity > 0)
+    {
+        pending = static_cast<PendingRead *>(
+            heap.allocate(sizeof(PendingRead) * queueCapacity, alignof(PendingRead)));
+    }
+
+    if ((buffer == nullptr) || ((queueCapacity > 0) && (pending == nullptr)))
+        return false;
+
+    _reader = reader;
+    _buffer = buffer;
+    _pending = pending;
+    _windowSize = windowSize;
+    _queueCapacity = queueCapacity;
+    _sectorSizePow2 = sectorSizePow2;
+    invalidate();
+
+    return true;
+}
+
+//! @brief Reads sectors immediately, reading ahead if access is sequential.
+//! @param[in] destination The memory to receive the sectors.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @return The count of sectors read, which is only less than
+//! \p sectorCount if the boot device failed.
+uint32_t ReadScheduler::read(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    if (_reader == nullptr)
+        return 0;
+
+    uint8_t *target = static_cast<uint8_t *>(destination);
+    bool isSequential = (startSector == _nextSector);
+    uint32_t index = 0;
+
+    _unscheduledSwitchCount += getSwitchCount(sectorCount);
+
+    while (index < sectorCount)
+    {
+        uint64_t sector = startSector + index;
+        uint32_t remaining = sectorCount - index;
+        uint32_t copied = copyFromBuffer(target, sector, remaining);
+
+        if (copied > 0)
+        {
+            index += copied;
+            target += static_cast<size_t>(copied) << _sectorSizePow2;
+        }
+        else if (isSequential && (remaining < _windowSize) &&
+                 fillBuffer(sector, _windowSize))
+        {
+            // The rest of the request and the sectors beyond it were read in
+            // one transfer, on the assumption that they will be needed next,
+            // and will be copied on the next pass.
+        }
+        else
+        {
+            // Large or random reads go straight to their destination, as do
+            // read-aheads which the device rejected, which it may do if the
+            // window crosses the end of the media.
+            uint32_t readCount = readDevice(target, sector, remaining);
+
+            index += readCount;
+            target += static_cast<size_t>(readCount) << _sectorSizePow2;
+
+            if (readCount < remaining)
+                break;
+        }
+    }
+
+    _nextSector = startSector + index;
+
+    return index;
+}
+
+//! @brief Queues a read to be performed when the queue is flushed.
+//! @param[in] destination The memory to receive the sectors.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @retval true The request was queued.
+//! @retval false The queue was full, it should be flushed and the request
+//! queued again.
+bool ReadScheduler::queue(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    if (_pendingCount >= _queueCapacity)
+        return false;
+
+    if (sectorCount > 0)
+    {
+        PendingRead &request = _pending[_pendingCount++];
+
+        request.StartSector = startSector;
+        request.Destination = static_cast<uint8_t *>(destination);
+        request.SectorCount = sectorCount;
+        _unscheduledSwitchCount += getSwitchCount(sectorCount);
+    }
+
+    return true;
+}
+
+//! @brief Performs all queued reads, merging adjacent and overlapping
+//! requests into as few transfers as possible.
+//! @retval true All requested sectors were read.
+//! @retval false The boot device failed, some destinations may be incomplete.
+bool ReadScheduler::flush()
+{
+    if (_pendingCount == 0)
+        return true;
+
+    Collection::sort(_pending, _pendingCount, PendingReadComparer());
+
+    bool isOK = true;
+    uint32_t groupFirst = 0;
+    uint64_t groupStart = _pending[0].StartSector;
+    uint64_t groupEnd = groupStart + _pending[0].SectorCount;
+
+    for (uint32_t i = 1; i <= _pendingCount; ++i)
+    {
+        if (i < _pendingCount)
+        {
+            const PendingRead &request = _pending[i];
+            uint64_t requestEnd = request.StartSector + request.SectorCount;
+
+            if (request.StartSector <= groupEnd)
+            {
+                // The request touches the group, so merge it.
+                if (requestEnd > groupEnd)
+                {
+                    groupEnd = requestEnd;
+                }
+
+                continue;
+            }
+        }
+
+        if (readGroup(_pending + groupFirst, i - groupFirst, groupStart, groupEnd) == false)
+        {
+            isOK = false;
+        }
+
+        if (i < _pendingCount)
+        {
+            groupFirst = i;
+            groupStart = _pending[i].StartSector;
+            groupEnd = groupStart + _pending[i].SectorCount;
+        }
+    }
+
+    _pendingCount = 0;
+
+    return isOK;
+}
+
+//! @brief Discards the contents of the read-ahead buffer and any queued
+//! requests, for example if the media changed.
+void ReadScheduler::invalidate()
+{
+    _bufferStart = 0;
+    _bufferCount = 0;
+    _nextSector = NoSector;
+    _pendingCount = 0;
+}
+
+//! @brief Compares the first sectors of two pending reads.
+int ReadScheduler::PendingReadComparer::operator()(const PendingRead &lhs,
+                                                   const PendingRead &rhs) const
+{
+    if (lhs.StartSector == rhs.StartSector)
+        return 0;
+
+    return (lhs.StartSector < rhs.StartSector) ? -1 : 1;
+}
+
+//! @brief Calculates the count of transfers needed to read a run of sectors.
+uint32_t ReadScheduler::getSwitchCount(uint64_t sectorCount) const
+{
+    uint64_t count = 0;
+
+    // Avoid 64-bit division, which the loader can't rely on.
+    if (sectorCount > 0)
+    {
+        uint32_t window = _windowSize;
+        count = (sectorCount <= UINT32_MAX) ?
+                    ((static_cast<uint32_t>(sectorCount) - 1) / window) + 1 :
+                    (UINT32_MAX / window) + 1;
+    }
+
+    return static_cast<uint32_t>(count);
+}
+
+//! @brief Reads directly from the boot device, counting the transfers.
+uint32_t ReadScheduler::readDevice(void *destination, uint64_t startSector,
+                                   uint32_t sectorCount)
+{
+    _modeSwitchCount += getSwitchCount(sectorCount);
+
+    uint32_t readCount = _reader(destination, startSector, sectorCount);
+
+    return (readCount > sectorCount) ? sectorCount : readCount;
+}
+
+//! @brief Reads sectors into the staging buffer.
+//! @param[in] startSector The first sector to read.
+//! @param[in] sectorCount The count of sectors to read, no more than the
+//! window size.
+//! @retval true At least one sector was read.
+//! @retval false The boot device failed to read anything.
+bool ReadScheduler::fillBuffer(uint64_t startSector, uint32_t sectorCount)
+{
+    _bufferStart = startSector;
+    _bufferCount = readDevice(_buffer, startSector, sectorCount);
+
+    return _bufferCount > 0;
+}
+
+//! @brief Copies the leading part of a run of sectors from the staging
+//! buffer if it holds them.
+//! @return The count of sectors copied, 0 if the first sector isn't buffered.
+uint32_t ReadScheduler::copyFromBuffer(uint8_t *destination, uint64_t startSector,
+                                       uint32_t sectorCount) const
+{
+    if ((startSector < _bufferStart) || (startSector >= (_bufferStart + _bufferCount)))
+        return 0;
+
+    uint32_t offset = static_cast<uint32_t>(startSector - _bufferStart);
+    uint32_t count = _bufferCount - offset;
+
+    if (count > sectorCount)
+    {
+        count = sectorCount;
+    }
+
+    Memory::copy(destination, _buffer + (static_cast<size_t>(offset) << _sectorSizePow2),
+                 static_cast<size_t>(count) << _sectorSizePow2);
+
+    return count;
+}
+
+//! @brief Reads a group of overlapping or adjacent requests in window-sized
+//! transfers through the staging buffer.
+//! @param[in] requests The requests in the group, sorted by first sector.
+//! @param[in] count The count of requests in the group.
+//! @param[in] startSector The first sector of the group.
+//! @param[in] endSector The sector after the last in the group.
+//! @retval true All sectors in the group were read.
+//! @retval false The boot device failed.
+bool ReadScheduler::readGroup(const PendingRead *requests, uint32_t count,
+                              uint64_t startSector, uint64_t endSector)
+{
+    for (uint64_t chunkStart = startSector; chunkStart < endSector; chunkStart += _windowSize)
+    {
+        uint32_t chunkSize = ((endSector - chunkStart) < _windowSize) ?
+                                static_cast<uint32_t>(endSector - chunkStart) : _windowSize;
+        fillBuffer(chunkStart, chunkSize);
+
+        // Give each request the part of the chunk which it overlaps.
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const PendingRead &request = requests[i];
+
+            if ((request.StartSector >= (chunkStart + chunkSize)) ||
+                ((request.StartSector + request.SectorCount) <= chunkStart))
+            {
+                continue;
+            }
+
+            uint64_t first = (request.StartSector > chunkStart) ? request.StartSector :
+                                                                  chunkStart;
+            uint32_t offset = static_cast<uint32_t>(first - request.StartSector);
+
+            copyFromBuffer(request.Destination + (static_cast<size_t>(offset) << _sectorSizePow2),
+                           first, request.SectorCount - offset);
+        }
+
+        if (_bufferCount < chunkSize)
+            return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
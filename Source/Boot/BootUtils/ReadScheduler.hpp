@@ -0,0 +1,115 @@
+//! @file BootUtils/ReadScheduler.hpp
+//! @brief The declaration of an object which reduces the count of calls made
+//! to read from the boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_READ_SCHEDULER_HPP__
+#define __BOOT_UTILS_READ_SCHEDULER_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Loader.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+class Heap;
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Schedules reads from the boot device so that as few transfers as
+//! possible are made, each of which costs a switch to real mode and back.
+//! @details
+//! Immediate reads which continue where the last one finished are treated
+//! as sequential and trigger a read-ahead of a whole transfer window into a
+//! staging buffer, which subsequent small reads are served from. Reads can
+//! also be queued and then flushed together, in which case adjacent and
+//! overlapping requests are merged into window-sized transfers.
+class ReadScheduler
+{
+public:
+    // Construction/Destruction
+    ReadScheduler();
+    ReadScheduler(const ReadScheduler &) = delete;
+    ReadScheduler &operator=(const ReadScheduler &) = delete;
+    ~ReadScheduler() = default;
+
+    // Accessors
+    uint32_t getWindowSize() const;
+    uint32_t getPendingCount() const;
+    uint32_t getModeSwitchCount() const;
+    uint32_t getUnscheduledSwitchCount() const;
+    uint32_t getSavedSwitchCount() const;
+
+    // Operations
+    bool initialise(Heap &heap, ReadBootSectorsFn reader, uint8_t sectorSizePow2,
+                    uint32_t windowSize, uint32_t queueCapacity);
+    uint32_t read(void *destination, uint64_t startSector, uint32_t sectorCount);
+    bool queue(void *destination, uint64_t startSector, uint32_t sectorCount);
+    bool flush();
+    void invalidate();
+
+private:
+    // Internal Types
+    //! @brief A request to read sectors held until the queue is flushed.
+    struct PendingRead
+    {
+        uint64_t StartSector;
+        uint8_t *Destination;
+        uint32_t SectorCount;
+    };
+
+    //! @brief Orders pending reads by their first sector.
+    struct PendingReadComparer
+    {
+        int operator()(const PendingRead &lhs, const PendingRead &rhs) const;
+    };
+
+    // Internal Functions
+    uint32_t getSwitchCount(uint64_t sectorCount) const;
+    uint32_t readDevice(void *destination, uint64_t startSector, uint32_t sectorCount);
+    bool fillBuffer(uint64_t startSector, uint32_t sectorCount);
+    uint32_t copyFromBuffer(uint8_t *destination, uint64_t startSector,
+                            uint32_t sectorCount) const;
+    bool readGroup(const PendingRead *requests, uint32_t count,
+                   uint64_t startSector, uint64_t endSector);
+
+    // Internal Fields
+    ReadBootSectorsFn _reader;
+    uint8_t *_buffer;
+    PendingRead *_pending;
+    uint64_t _bufferStart;
+    uint64_t _nextSector;
+    uint32_t _bufferCount;
+    uint32_t _windowSize;
+    uint32_t _queueCapacity;
+    uint32_t _pendingCount;
+    uint32_t _modeSwitchCount;
+    uint32_t _unscheduledSwitchCount;
+    uint8_t _sectorSizePow2;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,333 @@
+//! @file BootUtils/SectorCache.cpp
+//! @brief The definition of an object which caches sectors read from the
+//! boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "Heap.hpp"
+#include "MemoryTools.hpp"
+#include "SectorCache.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+//! @brief The largest sector size supported, 64 KB.
+constexpr uint8_t MaxSectorSizePow2 = 16;
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// SectorCache Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Constructs a cache which must be initialised before use.
+SectorCache::SectorCache() :
+    _reader(nullptr),
+    _slots(nullptr),
+    _buckets(nullptr),
+    _data(nullptr),
+    _hitCount(0),
+    _missCount(0),
+    _deviceReadCount(0),
+    _capacity(0),
+    _usedCount(0),
+    _bucketMask(0),
+    _mostRecent(NoSlot),
+    _leastRecent(NoSlot),
+    _sectorSizePow2(0)
+{
+}
+
+//! @brief Gets the maximum count of sectors the cache can hold.
+uint32_t SectorCache::getCapacity() const { return _capacity; }
+
+//! @brief Gets the count of sectors currently held in the cache.
+uint32_t SectorCache::getCachedCount() const { return _usedCount; }
+
+//! @brief Gets the count of sectors served from the cache.
+uint64_t SectorCache::getHitCount() const { return _hitCount; }
+
+//! @brief Gets the count of sectors requested from the boot device.
+uint64_t SectorCache::getMissCount() const { return _missCount; }
+
+//! @brief Gets the count of calls made to the underlying read function.
+uint32_t SectorCache::getDeviceReadCount() const { return _deviceReadCount; }
+
+//! @brief Determines whether a sector is held in the cache.
+bool SectorCache::isCached(uint64_t sector) const
+{
+    return findSlot(sector) != NoSlot;
+}
+
+//! @brief Allocates the cache and attaches it to the boot device.
+//! @param[in] heap The heap to allocate the cache from.
+//! @param[in] reader The function which reads sectors from the boot device.
+//! @param[in] sectorSizePow2 The size of sectors as a power of 2.
+//! @param[in] capacity The maximum count of sectors to hold.
+//! @retval true The cache is ready to use.
+//! @retval false The parameters were invalid, the cache was already
+//! initialised or there was not enough memory.
+bool SectorCache::initialise(Heap &heap, ReadBootSectorsFn reader,
+                             uint8_t sectorSizePow2, uint32_t capacity)
+{
+    Heap::Marker marker = heap.mark();
+
+    if ((_reader != nullptr) || (reader == nullptr) || (capacity == 0) ||
+        (sectorSizePow2 > MaxSectorSizePow2) ||
+        (capacity > (SIZE_MAX >> (sectorSizePow2 + 1))))
+    {
+        heap.release(marker);
+        return false;
+    }
+
+    // Size the hash table to the next power of 2, so chains stay short.
+    uint32_t bucketCount = 1;
+
+    while ((bucketCount < capacity) && (bucketCount < 0x80000000u))
+    {
+        bucketCount <<= 1;
+    }
+
+    CacheSlot *slots = static_cast<CacheSlot *>(
+        heap.allocate(sizeof(CacheSlot) * capacity, alignof(CacheSlot)));
+    uint32_t *buckets = static_cast<uint32_t *>(
+        heap.allocate(sizeof(uint32_t) * bucketCount, alignof(uint32_t)));
+    uint8_t *data = static_cast<uint8_t *>(
+        heap.allocate(static_cast<size_t>(capacity) << sectorSizePow2));
+
+    if ((slots == nullptr) || (buckets == nullptr) || (data == nullptr))
+    {
+        // Give back whatever was allocated before memory ran out.
+        heap.release(marker);
+        return false;
+    }
+
+    _reader = reader;
+    _slots = slots;
+    _buckets = buckets;
+    _data = data;
+    _capacity = capacity;
+    _bucketMask = bucketCount - 1;
+    _sectorSizePow2 = sectorSizePow2;
+    invalidate();
+
+    return true;
+}
+
+//! @brief Reads sectors, from the cache where possible.
+//! @param[in] destination The memory to receive the sectors.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @return The count of sectors read, which is only less than
+//! \p sectorCount if the boot device failed.
+uint32_t SectorCache::read(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    if (_reader == nullptr)
+        return 0;
+
+    uint8_t *target = static_cast<uint8_t *>(destination);
+    const size_t sectorSize = static_cast<size_t>(1) << _sectorSizePow2;
+    uint32_t index = 0;
+
+    while (index < sectorCount)
+    {
+        uint32_t slot = findSlot(startSector + index);
+
+        if (slot != NoSlot)
+        {
+            Memory::copy(target, _data + (static_cast<size_t>(slot) << _sectorSizePow2),
+                         sectorSize);
+            unlinkRecent(slot);
+            linkMostRecent(slot);
+            ++_hitCount;
+            ++index;
+            target += sectorSize;
+            continue;
+        }
+
+        // Find the run of missing sectors and read it in one call.
+        uint32_t runLength = 1;
+
+        while (((index + runLength) < sectorCount) &&
+               (findSlot(startSector + index + runLength) == NoSlot))
+        {
+            ++runLength;
+        }
+
+        uint32_t readCount = _reader(target, startSector + index, runLength);
+        ++_deviceReadCount;
+        _missCount += runLength;
+
+        if (readCount > runLength)
+        {
+            readCount = runLength;
+        }
+
+        // Only cache runs which won't flush most of the cache.
+        if (readCount <= (_capacity / 2))
+        {
+            for (uint32_t i = 0; i < readCount; ++i)
+            {
+                insert(startSector + index + i,
+                       target + (static_cast<size_t>(i) << _sectorSizePow2));
+            }
+        }
+
+        index += readCount;
+        target += static_cast<size_t>(readCount) << _sectorSizePow2;
+
+        if (readCount < runLength)
+            break;
+    }
+
+    return index;
+}
+
+//! @brief Discards all cached sectors, for example if the media changed.
+void SectorCache::invalidate()
+{
+    for (uint32_t i = 0; i <= _bucketMask; ++i)
+    {
+        _buckets[i] = NoSlot;
+    }
+
+    _usedCount = 0;
+    _mostRecent = NoSlot;
+    _leastRecent = NoSlot;
+}
+
+//! @brief Gets the hash table bucket holding a sector.
+uint32_t SectorCache::getBucket(uint64_t sector) const
+{
+    // Sectors are mostly read in runs, so the low bits are well distributed.
+    return (static_cast<uint32_t>(sector) ^ static_cast<uint32_t>(sector >> 32)) & _bucketMask;
+}
+
+//! @brief Finds the slot holding a sector.
+//! @return The index of the slot or NoSlot if the sector isn't cached.
+uint32_t SectorCache::findSlot(uint64_t sector) const
+{
+    if (_buckets == nullptr)
+        return NoSlot;
+
+    uint32_t slot = _buckets[getBucket(sector)];
+
+    while ((slot != NoSlot) && (_slots[slot].Sector != sector))
+    {
+        slot = _slots[slot].HashNext;
+    }
+
+    return slot;
+}
+
+//! @brief Removes a slot from the least recently used list.
+void SectorCache::unlinkRecent(uint32_t slot)
+{
+    CacheSlot &entry = _slots[slot];
+
+    if (entry.Prev == NoSlot)
+    {
+        _mostRecent = entry.Next;
+    }
+    else
+    {
+        _slots[entry.Prev].Next = entry.Next;
+    }
+
+    if (entry.Next == NoSlot)
+    {
+        _leastRecent = entry.Prev;
+    }
+    else
+    {
+        _slots[entry.Next].Prev = entry.Prev;
+    }
+}
+
+//! @brief Adds a slot to the most recently used end of the list.
+void SectorCache::linkMostRecent(uint32_t slot)
+{
+    CacheSlot &entry = _slots[slot];
+
+    entry.Prev = NoSlot;
+    entry.Next = _mostRecent;
+
+    if (_mostRecent == NoSlot)
+    {
+        _leastRecent = slot;
+    }
+    else
+    {
+        _slots[_mostRecent].Prev = slot;
+    }
+
+    _mostRecent = slot;
+}
+
+//! @brief Removes a slot from its hash table chain.
+void SectorCache::unlinkHash(uint32_t slot)
+{
+    uint32_t *link = &_buckets[getBucket(_slots[slot].Sector)];
+
+    while (*link != slot)
+    {
+        link = &_slots[*link].HashNext;
+    }
+
+    *link = _slots[slot].HashNext;
+}
+
+//! @brief Adds a sector to the cache, evicting the least recently used
+//! sector if the cache is full.
+//! @param[in] sector The index of the sector.
+//! @param[in] data The contents of the sector.
+void SectorCache::insert(uint64_t sector, const uint8_t *data)
+{
+    uint32_t slot;
+
+    if (_usedCount < _capacity)
+    {
+        slot = _usedCount++;
+    }
+    else
+    {
+        slot = _leastRecent;
+        unlinkHash(slot);
+        unlinkRecent(slot);
+    }
+
+    uint32_t bucket = getBucket(sector);
+
+    _slots[slot].Sector = sector;
+    _slots[slot].HashNext = _buckets[bucket];
+    _buckets[bucket] = slot;
+    linkMostRecent(slot);
+
+    Memory::copy(_data + (static_cast<size_t>(slot) << _sectorSizePow2), data,
+                 static_cast<size_t>(1) << _sectorSizePow2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,115 @@
+//! @file BootUtils/SectorCache.hpp
+//! @brief The declaration of an object which caches sectors read from the
+//! boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_SECTOR_CACHE_HPP__
+#define __BOOT_UTILS_SECTOR_CACHE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Loader.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+class Heap;
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A cache of recently read sectors in front of a function which
+//! reads from the boot device.
+//! @details
+//! Cached sectors are found through a hash table and kept in least recently
+//! used order on a doubly linked list, both indexed by slot so that no
+//! pointers are stored. A request which is partly cached is served by
+//! copying the cached sectors and reading only the missing runs. Long runs
+//! are passed straight through so that streaming a large file doesn't flush
+//! the sectors which are read repeatedly, such as volume descriptors and
+//! directories.
+class SectorCache
+{
+public:
+    // Construction/Destruction
+    SectorCache();
+    SectorCache(const SectorCache &) = delete;
+    SectorCache &operator=(const SectorCache &) = delete;
+    ~SectorCache() = default;
+
+    // Accessors
+    uint32_t getCapacity() const;
+    uint32_t getCachedCount() const;
+    uint64_t getHitCount() const;
+    uint64_t getMissCount() const;
+    uint32_t getDeviceReadCount() const;
+    bool isCached(uint64_t sector) const;
+
+    // Operations
+    bool initialise(Heap &heap, ReadBootSectorsFn reader,
+                    uint8_t sectorSizePow2, uint32_t capacity);
+    uint32_t read(void *destination, uint64_t startSector, uint32_t sectorCount);
+    void invalidate();
+
+private:
+    // Internal Types
+    //! @brief Describes the sector held in a slot of the cache.
+    struct CacheSlot
+    {
+        uint64_t Sector;
+        uint32_t Prev;
+        uint32_t Next;
+        uint32_t HashNext;
+    };
+
+    // Internal Constants
+    //! @brief A slot index used to mark the end of a list.
+    static constexpr uint32_t NoSlot = UINT32_MAX;
+
+    // Internal Functions
+    uint32_t getBucket(uint64_t sector) const;
+    uint32_t findSlot(uint64_t sector) const;
+    void unlinkRecent(uint32_t slot);
+    void linkMostRecent(uint32_t slot);
+    void unlinkHash(uint32_t slot);
+    void insert(uint64_t sector, const uint8_t *data);
+
+    // Internal Fields
+    ReadBootSectorsFn _reader;
+    CacheSlot *_slots;
+    uint32_t *_buckets;
+    uint8_t *_data;
+    uint64_t _hitCount;
+    uint64_t _missCount;
+    uint32_t _deviceReadCount;
+    uint32_t _capacity;
+    uint32_t _usedCount;
+    uint32_t _bucketMask;
+    uint32_t _mostRecent;
+    uint32_t _leastRecent;
+    uint8_t _sectorSizePow2;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
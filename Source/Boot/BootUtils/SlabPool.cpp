@@ -0,0 +1,265 @@
+//! @file BootUtils/SlabPool.cpp
+//! @brief The definition of pools which allocate fixed size objects from
+//! page-sized slabs taken from the boot-time heap.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "BitTools.hpp"
+#include "Heap.hpp"
+#include "SlabPool.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Rounds a value up to a power of 2 boundary.
+constexpr size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// SlabAllocator Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Constructs an allocator which must be initialised before use.
+SlabAllocator::SlabAllocator() :
+    _heap(nullptr),
+    _freeList(nullptr),
+    _slabs(nullptr),
+    _objectSize(0),
+    _alignment(0),
+    _objectsPerSlab(0),
+    _slabCount(0),
+    _usedCount(0)
+{
+}
+
+//! @brief Returns all slabs to the heap.
+SlabAllocator::~SlabAllocator()
+{
+    clear();
+}
+
+//! @brief Gets the count of bytes allocated for each object, including
+//! alignment padding.
+size_t SlabAllocator::getObjectSize() const { return _objectSize; }
+
+//! @brief Gets the count of objects which fit in each slab.
+size_t SlabAllocator::getObjectsPerSlab() const { return _objectsPerSlab; }
+
+//! @brief Gets the count of slabs allocated from the heap.
+size_t SlabAllocator::getSlabCount() const { return _slabCount; }
+
+//! @brief Gets the count of objects currently allocated.
+size_t SlabAllocator::getUsedCount() const { return _usedCount; }
+
+//! @brief Prepares the allocator to allocate objects of a specific size.
+//! @param[in] heap The heap whose general purpose pool slabs are taken from.
+//! @param[in] objectSize The count of bytes in each object.
+//! @param[in] alignment The power of 2 boundary each object must start on.
+//! @retval true The allocator is ready to use.
+//! @retval false The allocator was already initialised or the size or
+//! alignment were invalid.
+bool SlabAllocator::initialise(Heap &heap, size_t objectSize, size_t alignment)
+{
+    if ((_heap != nullptr) || (Bits::isPowerOf2(alignment) == false))
+        return false;
+
+    // Each object must be able to hold the free list link.
+    if (alignment < alignof(FreeObject))
+        alignment = alignof(FreeObject);
+
+    if (objectSize < sizeof(FreeObject))
+        objectSize = sizeof(FreeObject);
+
+    size_t paddedSize = alignUp(objectSize, alignment);
+
+    // Slabs are only guaranteed to be aligned to a pointer, so allow for
+    // padding before the first object.
+    size_t worstOffset = sizeof(SlabHeader) + alignment - alignof(SlabHeader);
+
+    if ((paddedSize < objectSize) || (worstOffset + paddedSize > SlabSize))
+        return false;
+
+    _heap = &heap;
+    _objectSize = paddedSize;
+    _alignment = alignment;
+    _objectsPerSlab = (SlabSize - worstOffset) / paddedSize;
+
+    return true;
+}
+
+//! @brief Returns all slabs to the heap, releasing every object at once.
+void SlabAllocator::clear()
+{
+    while (_slabs != nullptr)
+    {
+        SlabHeader *next = _slabs->Next;
+
+        _heap->freeBlock(_slabs);
+        _slabs = next;
+    }
+
+    _freeList = nullptr;
+    _slabCount = 0;
+    _usedCount = 0;
+}
+
+//! @brief Allocates a new slab and threads its objects onto the free list.
+//! @return The first free object or nullptr if no slab could be allocated.
+SlabAllocator::FreeObject *SlabAllocator::addSlab()
+{
+    if (_heap == nullptr)
+        return nullptr;
+
+    uint8_t *memory = static_cast<uint8_t *>(_heap->allocateBlock(SlabSize));
+
+    if (memory == nullptr)
+        return nullptr;
+
+    SlabHeader *slab = reinterpret_cast<SlabHeader *>(memory);
+    slab->Next = _slabs;
+    _slabs = slab;
+    ++_slabCount;
+
+    // Thread the objects from the highest address down so that they are
+    // handed out in ascending address order.
+    uintptr_t first = alignUp(reinterpret_cast<uintptr_t>(memory) + sizeof(SlabHeader),
+                              _alignment);
+    FreeObject *head = _freeList;
+
+    for (size_t i = _objectsPerSlab; i > 0; --i)
+    {
+        FreeObject *object = reinterpret_cast<FreeObject *>(first + ((i - 1) * _objectSize));
+
+        object->Next = head;
+        head = object;
+    }
+
+    _freeList = head;
+
+    return head;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SizeClassAllocator Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief The count of bytes in each size class.
+const uint16_t SizeClassAllocator::ClassSizes[ClassCount] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512
+};
+
+//! @brief Maps a size, divided by Granularity and rounded up, to the index
+//! of the smallest size class which can hold it.
+const uint8_t SizeClassAllocator::ClassIndices[(MaxClassSize / Granularity) + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+    8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9
+};
+
+//! @brief Constructs an allocator which must be initialised before use.
+SizeClassAllocator::SizeClassAllocator() :
+    _heap(nullptr)
+{
+}
+
+//! @brief Gets the count of bytes actually allocated for a request.
+//! @param[in] size The count of bytes requested.
+//! @return The size of the class serving the request or \p size if it is
+//! too large to be served by a size class.
+size_t SizeClassAllocator::getClassSize(size_t size)
+{
+    return (size > MaxClassSize) ? size :
+        ClassSizes[ClassIndices[(size + Granularity - 1) / Granularity]];
+}
+
+//! @brief Prepares the allocator to allocate slabs from a heap.
+//! @param[in] heap A heap with a general purpose pool.
+//! @retval true The allocator is ready to use.
+//! @retval false The allocator was already initialised.
+bool SizeClassAllocator::initialise(Heap &heap)
+{
+    if (_heap != nullptr)
+        return false;
+
+    for (size_t i = 0; i < ClassCount; ++i)
+    {
+        // Classes which are multiples of 16 bytes are aligned to 16 bytes so
+        // that objects never straddle more cache lines than necessary.
+        if (_classes[i].initialise(heap, ClassSizes[i], Granularity) == false)
+            return false;
+    }
+
+    _heap = &heap;
+
+    return true;
+}
+
+//! @brief Allocates a block of memory.
+//! @param[in] size The count of bytes required.
+//! @return A pointer to the block or nullptr if no memory was available.
+void *SizeClassAllocator::allocate(size_t size)
+{
+    if (_heap == nullptr)
+        return nullptr;
+
+    if (size > MaxClassSize)
+        return _heap->allocateBlock(size);
+
+    return _classes[ClassIndices[(size + Granularity - 1) / Granularity]].allocate();
+}
+
+//! @brief Frees a block of memory.
+//! @param[in] block A block returned by allocate() or nullptr.
+//! @param[in] size The size originally passed to allocate().
+void SizeClassAllocator::free(void *block, size_t size)
+{
+    if ((_heap == nullptr) || (block == nullptr))
+        return;
+
+    if (size > MaxClassSize)
+    {
+        _heap->freeBlock(block);
+    }
+    else
+    {
+        _classes[ClassIndices[(size + Granularity - 1) / Granularity]].free(block);
+    }
+}
+
+//! @brief Returns the slabs of every size class to the heap, releasing all
+//! blocks allocated from size classes at once.
+//! @note Blocks larger than MaxClassSize must still be freed individually.
+void SizeClassAllocator::clear()
+{
+    for (size_t i = 0; i < ClassCount; ++i)
+    {
+        _classes[i].clear();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,244 @@
+//! @file BootUtils/SlabPool.hpp
+//! @brief The declaration of pools which allocate fixed size objects from
+//! page-sized slabs taken from the boot-time heap.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_SLAB_POOL_HPP__
+#define __BOOT_UTILS_SLAB_POOL_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef TEST_BUILD
+#include <new>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+class Heap;
+
+#ifndef TEST_BUILD
+//! @brief The placement form of operator new, which the loader has no
+//! run-time library to provide.
+inline void *operator new(size_t, void *place) noexcept { return place; }
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Allocates objects of a single size from page-sized slabs.
+//! @details
+//! Free objects are threaded onto a singly linked list through their own
+//! memory, so allocation and freeing are a pop or push with no searching.
+//! Objects are packed back to back, only padded to their alignment. Slabs
+//! are taken from the general purpose pool of a Heap and are only returned
+//! to it in bulk, by clear() or on destruction.
+class SlabAllocator
+{
+public:
+    // Public Constants
+    //! @brief The count of bytes requested from the heap for each slab.
+    static constexpr size_t SlabSize = 0x1000;
+
+    // Construction/Destruction
+    SlabAllocator();
+    SlabAllocator(const SlabAllocator &) = delete;
+    SlabAllocator &operator=(const SlabAllocator &) = delete;
+    ~SlabAllocator();
+
+    // Accessors
+    size_t getObjectSize() const;
+    size_t getObjectsPerSlab() const;
+    size_t getSlabCount() const;
+    size_t getUsedCount() const;
+
+    // Operations
+    bool initialise(Heap &heap, size_t objectSize,
+                    size_t alignment = alignof(void *));
+
+    //! @brief Allocates an object-sized block of memory.
+    //! @return A pointer to the uninitialised block or nullptr if a new slab
+    //! was needed but couldn't be allocated.
+    void *allocate()
+    {
+        FreeObject *block = _freeList;
+
+        if ((block == nullptr) && ((block = addSlab()) == nullptr))
+            return nullptr;
+
+        _freeList = block->Next;
+        ++_usedCount;
+
+        return block;
+    }
+
+    //! @brief Returns a block to the pool.
+    //! @param[in] block A block returned by allocate() on this object, or
+    //! nullptr.
+    void free(void *block)
+    {
+        if (block != nullptr)
+        {
+            FreeObject *object = static_cast<FreeObject *>(block);
+
+            object->Next = _freeList;
+            _freeList = object;
+            --_usedCount;
+        }
+    }
+
+    void clear();
+
+private:
+    // Internal Types
+    //! @brief The link written into each free object.
+    struct FreeObject
+    {
+        FreeObject *Next;
+    };
+
+    //! @brief The header at the start of each slab linking it to the others.
+    struct SlabHeader
+    {
+        SlabHeader *Next;
+    };
+
+    // Internal Functions
+    FreeObject *addSlab();
+
+    // Internal Fields
+    Heap *_heap;
+    FreeObject *_freeList;
+    SlabHeader *_slabs;
+    size_t _objectSize;
+    size_t _alignment;
+    size_t _objectsPerSlab;
+    size_t _slabCount;
+    size_t _usedCount;
+};
+
+//! @brief Allocates blocks of small, varying sizes by rounding each up to
+//! one of a fixed set of size classes, each served by its own SlabAllocator.
+//! @details
+//! Larger blocks are passed on to the general purpose pool of the heap.
+//! The caller must pass the size of a block back when freeing it so that no
+//! per-block header is needed.
+class SizeClassAllocator
+{
+public:
+    // Public Constants
+    //! @brief The largest block served from a size class.
+    static constexpr size_t MaxClassSize = 512;
+
+    // Construction/Destruction
+    SizeClassAllocator();
+    SizeClassAllocator(const SizeClassAllocator &) = delete;
+    SizeClassAllocator &operator=(const SizeClassAllocator &) = delete;
+    ~SizeClassAllocator() = default;
+
+    // Accessors
+    static size_t getClassSize(size_t size);
+
+    // Operations
+    bool initialise(Heap &heap);
+    void *allocate(size_t size);
+    void free(void *block, size_t size);
+    void clear();
+
+private:
+    // Internal Constants
+    static constexpr size_t ClassCount = 10;
+    static constexpr size_t Granularity = 16;
+    static const uint16_t ClassSizes[ClassCount];
+    static const uint8_t ClassIndices[(MaxClassSize / Granularity) + 1];
+
+    // Internal Fields
+    Heap *_heap;
+    SlabAllocator _classes[ClassCount];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A pool of objects of a single type allocated from page-sized slabs.
+//! @tparam T The type of object to allocate.
+//! @note clear() releases every object in the pool at once without running
+//! their destructors, so is only suitable for types which don't need them.
+template<typename T>
+class SlabPool
+{
+public:
+    // Construction/Destruction
+    SlabPool() = default;
+    ~SlabPool() = default;
+
+    // Accessors
+    //! @brief Gets the count of objects currently allocated.
+    size_t getUsedCount() const { return _slabs.getUsedCount(); }
+
+    //! @brief Gets the count of slabs allocated from the heap.
+    size_t getSlabCount() const { return _slabs.getSlabCount(); }
+
+    //! @brief Gets the count of objects which fit in each slab.
+    size_t getObjectsPerSlab() const { return _slabs.getObjectsPerSlab(); }
+
+    // Operations
+    //! @brief Prepares the pool to allocate slabs from a heap.
+    //! @param[in] heap A heap with a general purpose pool to take slabs from.
+    //! @retval true The pool is ready to allocate objects.
+    //! @retval false The pool was already initialised.
+    bool initialise(Heap &heap)
+    {
+        return _slabs.initialise(heap, sizeof(T), alignof(T));
+    }
+
+    //! @brief Allocates and constructs an object.
+    //! @param[in] args The arguments to pass to the constructor of T.
+    //! @return A pointer to the new object or nullptr if no memory was
+    //! available.
+    template<typename... TArgs>
+    T *create(TArgs &&... args)
+    {
+        void *block = _slabs.allocate();
+
+        return (block == nullptr) ? nullptr :
+                                    new(block) T(static_cast<TArgs &&>(args)...);
+    }
+
+    //! @brief Destroys an object and returns its memory to the pool.
+    //! @param[in] object An object returned by create() or nullptr.
+    void destroy(T *object)
+    {
+        if (object != nullptr)
+        {
+            object->~T();
+            _slabs.free(object);
+        }
+    }
+
+    //! @brief Returns all slabs to the heap, releasing every object at once.
+    void clear() { _slabs.clear(); }
+
+private:
+    SlabAllocator _slabs;
+};
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
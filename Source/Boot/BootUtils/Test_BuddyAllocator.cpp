@@ -0,0 +1,315 @@
+//! @file BootUtils/Test_BuddyAllocator.cpp
+//! @brief The definition of unit tests for the BuddyAllocator class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "BuddyAllocator.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+class BuddyAllocatorTest : public testing::Test
+{
+private:
+    static constexpr size_t RamSizeInMb = 16;
+    TargetMemoryMap _targetMemory;
+
+public:
+    BuddyAllocatorTest() :
+        _targetMemory(RamSizeInMb)
+    {
+    }
+
+    void SetUp()
+    {
+        _targetMemory.fill(0, _targetMemory.getSize(), 0xDF);
+    }
+};
+
+//! @brief A block allocated during a test.
+struct AllocatedBlock
+{
+    uint64_t Address;
+    uint32_t Order;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST(BuddyAllocator, GetOrderForSize)
+{
+    uint32_t order = 42;
+
+    EXPECT_TRUE(BuddyAllocator::getOrderForSize(0, order));
+    EXPECT_EQ(order, 0u);
+    EXPECT_TRUE(BuddyAllocator::getOrderForSize(1, order));
+    EXPECT_EQ(order, 0u);
+    EXPECT_TRUE(BuddyAllocator::getOrderForSize(0x1000, order));
+    EXPECT_EQ(order, 0u);
+    EXPECT_TRUE(BuddyAllocator::getOrderForSize(0x1001, order));
+    EXPECT_EQ(order, 1u);
+    EXPECT_TRUE(BuddyAllocator::getOrderForSize(0x3000, order));
+    EXPECT_EQ(order, 2u);
+    EXPECT_TRUE(BuddyAllocator::getOrderForSize(0x8000000, order));
+    EXPECT_EQ(order, 15u);
+    EXPECT_FALSE(BuddyAllocator::getOrderForSize(0x8000001, order));
+    EXPECT_FALSE(BuddyAllocator::getOrderForSize(UINT64_MAX, order));
+}
+
+TEST_F(BuddyAllocatorTest, InitialiseSplitsRegions)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0xE8000, 0x18000, MemType::Reserved, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    BuddyAllocator specimen;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 4, std::size(entries)));
+    ASSERT_TRUE(specimen.initialise(memoryMap));
+
+    // The bitmap takes the last page, so both regions end in an odd page.
+    EXPECT_EQ(specimen.getFreeSize(), 0x9F000u + 0xEFF000u);
+
+    const MemMapEntry *bitmapRegion = memoryMap.findRegion(0xFFF000);
+    ASSERT_NE(bitmapRegion, nullptr);
+    EXPECT_EQ(bitmapRegion->Type, MemType::UsableAfterBoot);
+
+    const size_t expectedCounts[BuddyAllocator::OrderCount] = {
+        2, 2, 2, 2, 2, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 0,
+    };
+
+    for (uint32_t order = 0; order < BuddyAllocator::OrderCount; ++order)
+    {
+        EXPECT_EQ(specimen.getFreeBlockCount(order), expectedCounts[order]) <<
+            "Order " << order;
+    }
+}
+
+TEST_F(BuddyAllocatorTest, SplitAndCoalesce)
+{
+    // A 1 MB region which forms a single block, with the bitmap held
+    // elsewhere.
+    MemMapEntry entries[] = {
+        { 0x100000, 0x100000, MemType::UsableRAM, 0 },
+        { 0x300000, 0x1000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    BuddyAllocator specimen;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 2, std::size(entries)));
+    ASSERT_TRUE(specimen.initialise(memoryMap));
+    ASSERT_EQ(specimen.getFreeBlockCount(8), 1u);
+    ASSERT_EQ(specimen.getFreeSize(), 0x100000u);
+
+    ASSERT_TRUE(specimen.allocate(0, address));
+    EXPECT_EQ(address, 0x100000u);
+    ASSERT_TRUE(specimen.allocate(0, address));
+    EXPECT_EQ(address, 0x101000u);
+    ASSERT_TRUE(specimen.allocate(1, address));
+    EXPECT_EQ(address, 0x102000u);
+    ASSERT_TRUE(specimen.allocate(4, address));
+    EXPECT_EQ(address, 0x110000u);
+
+    for (uint32_t order = 0; order < 8; ++order)
+    {
+        size_t expected = ((order == 0) || (order == 1) || (order == 4)) ? 0 : 1;
+
+        EXPECT_EQ(specimen.getFreeBlockCount(order), expected) <<
+            "Order " << order;
+    }
+
+    EXPECT_FALSE(specimen.allocate(8, address));
+    EXPECT_EQ(specimen.getFreeSize(), 0x100000u - 0x14000u);
+
+    specimen.free(0x101000, 0);
+    specimen.free(0x102000, 1);
+    specimen.free(0x110000, 4);
+    EXPECT_EQ(specimen.getFreeBlockCount(8), 0u);
+
+    // Freeing the last block should coalesce everything.
+    specimen.free(0x100000, 0);
+    EXPECT_EQ(specimen.getFreeBlockCount(8), 1u);
+    EXPECT_EQ(specimen.getFreeSize(), 0x100000u);
+
+    ASSERT_TRUE(specimen.allocate(8, address));
+    EXPECT_EQ(address, 0x100000u);
+    EXPECT_EQ(specimen.getFreeSize(), 0u);
+    EXPECT_FALSE(specimen.allocate(0, address));
+}
+
+TEST_F(BuddyAllocatorTest, IgnoreInvalidFrees)
+{
+    MemMapEntry entries[] = {
+        { 0x100000, 0x100000, MemType::UsableRAM, 0 },
+        { 0x300000, 0x1000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    BuddyAllocator specimen;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 2, std::size(entries)));
+    ASSERT_TRUE(specimen.initialise(memoryMap));
+    ASSERT_TRUE(specimen.allocate(2, address));
+    const uint64_t freeSize = specimen.getFreeSize();
+
+    specimen.free(address + 0x1000, 2);
+    specimen.free(address, BuddyAllocator::OrderCount);
+    specimen.free(0x10000000, 0);
+    specimen.free(0x104000, 2);
+    EXPECT_EQ(specimen.getFreeSize(), freeSize);
+
+    specimen.free(address, 2);
+    specimen.free(address, 2);
+    EXPECT_EQ(specimen.getFreeSize(), 0x100000u);
+    EXPECT_FALSE(specimen.allocate(BuddyAllocator::OrderCount, address));
+}
+
+TEST_F(BuddyAllocatorTest, RandomAllocations)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    BuddyAllocator specimen;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 3, std::size(entries)));
+    ASSERT_TRUE(specimen.initialise(memoryMap));
+
+    const uint64_t initialFreeSize = specimen.getFreeSize();
+    size_t initialCounts[BuddyAllocator::OrderCount];
+
+    for (uint32_t order = 0; order < BuddyAllocator::OrderCount; ++order)
+    {
+        initialCounts[order] = specimen.getFreeBlockCount(order);
+    }
+
+    std::mt19937 random(0x600D5EED);
+    std::vector<AllocatedBlock> blocks;
+    std::vector<bool> isPageUsed(0x1000, false);
+
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        if (blocks.empty() || ((random() % 3) != 0))
+        {
+            AllocatedBlock block;
+            block.Order = random() % 6;
+
+            if (specimen.allocate(block.Order, block.Address) == false)
+                continue;
+
+            // Check the block is aligned and doesn't overlap any other.
+            uint64_t firstPage = block.Address >> 12;
+            uint64_t pageCount = uint64_t(1) << block.Order;
+
+            ASSERT_EQ(firstPage & (pageCount - 1), 0u);
+            ASSERT_LE(firstPage + pageCount, isPageUsed.size());
+
+            for (uint64_t page = firstPage; page < (firstPage + pageCount); ++page)
+            {
+                ASSERT_FALSE(isPageUsed[page]) << "Page " << page;
+                ASSERT_FALSE((page >= 0x9F) && (page < 0x100)) << "Page " << page;
+                isPageUsed[page] = true;
+            }
+
+            blocks.push_back(block);
+        }
+        else
+        {
+            size_t index = random() % blocks.size();
+            AllocatedBlock block = blocks[index];
+
+            blocks[index] = blocks.back();
+            blocks.pop_back();
+
+            uint64_t firstPage = block.Address >> 12;
+            uint64_t pageCount = uint64_t(1) << block.Order;
+
+            for (uint64_t page = firstPage; page < (firstPage + pageCount); ++page)
+            {
+                isPageUsed[page] = false;
+            }
+
+            specimen.free(block.Address, block.Order);
+        }
+    }
+
+    for (const AllocatedBlock &block : blocks)
+    {
+        specimen.free(block.Address, block.Order);
+    }
+
+    // All blocks should have coalesced back to their initial state.
+    EXPECT_EQ(specimen.getFreeSize(), initialFreeSize);
+
+    for (uint32_t order = 0; order < BuddyAllocator::OrderCount; ++order)
+    {
+        EXPECT_EQ(specimen.getFreeBlockCount(order), initialCounts[order]) <<
+            "Order " << order;
+    }
+}
+
+TEST_F(BuddyAllocatorTest, FailWithoutUsableRAM)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x100000, MemType::Reserved, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    BuddyAllocator specimen;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 1, std::size(entries)));
+    EXPECT_FALSE(specimen.initialise(memoryMap));
+    EXPECT_FALSE(specimen.allocate(0, address));
+    EXPECT_EQ(specimen.getFreeSize(), 0u);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,312 @@
+//! @file BootUtils/Test_FrameAllocator.cpp
+//! @brief The definition of unit tests for the FrameAllocator class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <iterator>
+
+#include "FrameAllocator.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+class FrameAllocatorTest : public testing::Test
+{
+private:
+    static constexpr size_t RamSizeInMb = 16;
+    TargetMemoryMap _targetMemory;
+
+protected:
+    // The memory map of a 16 MB machine.
+    MemMapEntry _entries[12] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0xE8000, 0x18000, MemType::Reserved, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+    };
+
+    MemoryMap _memoryMap;
+
+public:
+    FrameAllocatorTest() :
+        _targetMemory(RamSizeInMb)
+    {
+    }
+
+    void SetUp()
+    {
+        _targetMemory.fill(0, _targetMemory.getSize(), 0xDF);
+        ASSERT_TRUE(_memoryMap.initialise(_entries, 4, std::size(_entries)));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(FrameAllocatorTest, InitialiseFromMemoryMap)
+{
+    FrameAllocator specimen;
+
+    EXPECT_EQ(specimen.getFrameCount(), 0u);
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+
+    // The bitmap should take the top frame of memory.
+    EXPECT_EQ(specimen.getFrameCount(), 0x1000u);
+    EXPECT_EQ(specimen.getFreeFrameCount(), 0x9Fu + 0xEFFu);
+
+    const MemMapEntry *bitmapRegion = _memoryMap.findRegion(0xFFF000);
+    ASSERT_NE(bitmapRegion, nullptr);
+    EXPECT_EQ(bitmapRegion->BaseAddress, 0xFFF000u);
+    EXPECT_EQ(bitmapRegion->Size, 0x1000u);
+    EXPECT_EQ(bitmapRegion->Type, MemType::UsableAfterBoot);
+
+    EXPECT_TRUE(specimen.isFrameFree(0x0));
+    EXPECT_TRUE(specimen.isFrameFree(0x9E000));
+    EXPECT_FALSE(specimen.isFrameFree(0x9F000));
+    EXPECT_FALSE(specimen.isFrameFree(0xA0000));
+    EXPECT_TRUE(specimen.isFrameFree(0x100000));
+    EXPECT_TRUE(specimen.isFrameFree(0xFFEFFF));
+    EXPECT_FALSE(specimen.isFrameFree(0xFFF000));
+    EXPECT_FALSE(specimen.isFrameFree(0x1000000));
+}
+
+TEST_F(FrameAllocatorTest, IgnorePartialFrames)
+{
+    MemMapEntry entries[] = {
+        { 0x800, 0x9E000, MemType::UsableRAM, 0 },
+        { 0x100000, 0x100000, MemType::UsableRAM, 0 },
+        { 0x180400, 0x400, MemType::Reserved, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    FrameAllocator specimen;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 3, std::size(entries)));
+    ASSERT_TRUE(specimen.initialise(memoryMap));
+
+    EXPECT_EQ(specimen.getFrameCount(), 0x200u);
+    EXPECT_FALSE(specimen.isFrameFree(0x0));
+    EXPECT_TRUE(specimen.isFrameFree(0x1000));
+    EXPECT_TRUE(specimen.isFrameFree(0x9D000));
+    EXPECT_FALSE(specimen.isFrameFree(0x9E000));
+    EXPECT_TRUE(specimen.isFrameFree(0x17F000));
+    EXPECT_FALSE(specimen.isFrameFree(0x180000));
+    EXPECT_TRUE(specimen.isFrameFree(0x181000));
+    EXPECT_FALSE(specimen.isFrameFree(0x1FF000));
+    EXPECT_EQ(specimen.getFreeFrameCount(), 0x9Du + 0xFEu);
+}
+
+TEST_F(FrameAllocatorTest, AllocateSingleFrames)
+{
+    FrameAllocator specimen;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+    const size_t initialFreeCount = specimen.getFreeFrameCount();
+
+    for (uint64_t expected = 0; expected < 0x9F000; expected += 0x1000)
+    {
+        ASSERT_TRUE(specimen.allocate(address));
+        EXPECT_EQ(address, expected);
+    }
+
+    // The next frame should skip the reserved upper memory area.
+    ASSERT_TRUE(specimen.allocate(address));
+    EXPECT_EQ(address, 0x100000u);
+    EXPECT_EQ(specimen.getFreeFrameCount(), initialFreeCount - 0xA0u);
+
+    // Freed frames should be reused first.
+    specimen.free(0x5000);
+    EXPECT_TRUE(specimen.isFrameFree(0x5000));
+    ASSERT_TRUE(specimen.allocate(address));
+    EXPECT_EQ(address, 0x5000u);
+    ASSERT_TRUE(specimen.allocate(address));
+    EXPECT_EQ(address, 0x101000u);
+
+    // Freeing frames twice should not affect the count.
+    specimen.free(0x100000, 2);
+    specimen.free(0x100000, 2);
+    EXPECT_EQ(specimen.getFreeFrameCount(), initialFreeCount - 0x9Fu);
+}
+
+TEST_F(FrameAllocatorTest, AllocateAlignedRuns)
+{
+    FrameAllocator specimen;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+
+    // Fragment the start of memory.
+    ASSERT_TRUE(specimen.allocate(address));
+    ASSERT_TRUE(specimen.allocate(address));
+    ASSERT_EQ(address, 0x1000u);
+
+    ASSERT_TRUE(specimen.allocate(3, 0x1000, address));
+    EXPECT_EQ(address, 0x2000u);
+
+    ASSERT_TRUE(specimen.allocate(16, 0x10000, address));
+    EXPECT_EQ(address, 0x10000u);
+
+    // The gap left behind should still be usable.
+    ASSERT_TRUE(specimen.allocate(11, 0x1000, address));
+    EXPECT_EQ(address, 0x5000u);
+
+    ASSERT_TRUE(specimen.allocate(0x10, 0x1000, address));
+    EXPECT_EQ(address, 0x20000u);
+    ASSERT_TRUE(specimen.allocate(address));
+    EXPECT_EQ(address, 0x30000u);
+
+    // A run which would cross an allocated frame should be moved past it.
+    specimen.free(0x20000, 0x10);
+    ASSERT_TRUE(specimen.allocate(0x14, 0x1000, address));
+    EXPECT_EQ(address, 0x31000u);
+
+    // Runs which can't fit in conventional memory should be placed in
+    // extended memory.
+    ASSERT_TRUE(specimen.allocate(0x100, 0x1000, address));
+    EXPECT_EQ(address, 0x100000u);
+    ASSERT_TRUE(specimen.allocate(0x10, 0x1000, address));
+    EXPECT_EQ(address, 0x20000u);
+
+    EXPECT_FALSE(specimen.allocate(0, 0x1000, address));
+    EXPECT_FALSE(specimen.allocate(1, 0x3000, address));
+}
+
+TEST_F(FrameAllocatorTest, AllocateLargePages)
+{
+    constexpr uint64_t LargePageSize = 0x400000;
+    constexpr size_t FramesPerLargePage = LargePageSize / FrameAllocator::FrameSize;
+    FrameAllocator specimen;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+
+    ASSERT_TRUE(specimen.allocate(FramesPerLargePage, LargePageSize, address));
+    EXPECT_EQ(address, 0x400000u);
+    ASSERT_TRUE(specimen.allocate(FramesPerLargePage, LargePageSize, address));
+    EXPECT_EQ(address, 0x800000u);
+
+    // The last large page holds the bitmap, the first low memory.
+    EXPECT_FALSE(specimen.allocate(FramesPerLargePage, LargePageSize, address));
+
+    specimen.free(0x400000, FramesPerLargePage);
+    ASSERT_TRUE(specimen.allocate(FramesPerLargePage, LargePageSize, address));
+    EXPECT_EQ(address, 0x400000u);
+}
+
+TEST_F(FrameAllocatorTest, AllocateUntilExhausted)
+{
+    FrameAllocator specimen;
+    uint64_t address = 0;
+    size_t count = 0;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+    const size_t initialFreeCount = specimen.getFreeFrameCount();
+
+    while (specimen.allocate(address))
+    {
+        ++count;
+        ASSERT_LE(count, initialFreeCount);
+    }
+
+    EXPECT_EQ(count, initialFreeCount);
+    EXPECT_EQ(specimen.getFreeFrameCount(), 0u);
+    EXPECT_FALSE(specimen.allocate(1, 0x1000, address));
+}
+
+TEST_F(FrameAllocatorTest, DescribeBitmap)
+{
+    FrameAllocator specimen;
+    FrameBitmap info;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+    ASSERT_TRUE(specimen.allocate(address));
+    ASSERT_TRUE(specimen.allocate(2, 0x1000, address));
+    specimen.getBitmapInfo(info);
+
+    EXPECT_EQ(info.BitmapAddress, 0xFFF000u);
+    EXPECT_EQ(info.BitmapSize, 0x200u);
+    EXPECT_EQ(info.FrameCount, 0x1000u);
+    EXPECT_EQ(info.FreeFrameCount, specimen.getFreeFrameCount());
+
+    // Verify the format the kernel will see, one bit per frame, in byte order.
+    const uint8_t *bitmap = getAddress<uint8_t>(info.BitmapAddress);
+
+    EXPECT_EQ(bitmap[0], 0xF8);
+    EXPECT_EQ(bitmap[0x13], 0x7F);
+    EXPECT_EQ(bitmap[0x14], 0x00);
+    EXPECT_EQ(bitmap[0x20], 0xFF);
+    EXPECT_EQ(bitmap[0x1FF], 0x7F);
+}
+
+TEST_F(FrameAllocatorTest, MemoryAboveAddressableLimit)
+{
+    _entries[4] = { 0x1100000, 0xF00000, MemType::UsableRAM, 0 };
+    ASSERT_TRUE(_memoryMap.initialise(_entries, 5, std::size(_entries)));
+
+    FrameAllocator specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+
+    // The bitmap should cover all usable RAM, but be placed where it can be
+    // accessed.
+    FrameBitmap info;
+    specimen.getBitmapInfo(info);
+
+    EXPECT_EQ(specimen.getFrameCount(), 0x2000u);
+    EXPECT_EQ(info.BitmapAddress, 0xFFF000u);
+    EXPECT_FALSE(specimen.isFrameFree(0x1000000));
+    EXPECT_TRUE(specimen.isFrameFree(0x1100000));
+    EXPECT_TRUE(specimen.isFrameFree(0x1FFF000));
+    EXPECT_FALSE(specimen.isFrameFree(0x2000000));
+}
+
+TEST_F(FrameAllocatorTest, FailWithoutUsableRAM)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x100000, MemType::Reserved, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    FrameAllocator specimen;
+    uint64_t address = 0;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 1, std::size(entries)));
+    EXPECT_FALSE(specimen.initialise(memoryMap));
+    EXPECT_FALSE(specimen.allocate(address));
+    EXPECT_FALSE(specimen.isFrameFree(0));
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,410 @@
+//! @file BootUtils/Test_Heap.cpp
+//! @brief The definition of unit tests for the Heap class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <string>
+
+#include "Heap.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "Test_TargetTools.hpp"
+#include "Tlsf.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+class HeapTest : public testing::Test
+{
+private:
+    static constexpr size_t RamSizeInMb = 16;
+    TargetMemoryMap _targetMemory;
+
+protected:
+    MemMapEntry _entries[8] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0x100000, 0x3000, MemType::UsableAfterBoot, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+    };
+
+    MemoryMap _memoryMap;
+
+    //! @brief Gets the physical address of a block allocated from the heap.
+    static uint64_t getPhysicalAddress(const void *block)
+    {
+        return static_cast<uint64_t>(static_cast<const uint8_t *>(block) -
+                                     getAddress<uint8_t>(0));
+    }
+
+public:
+    HeapTest() :
+        _targetMemory(RamSizeInMb)
+    {
+    }
+
+    void SetUp()
+    {
+        _targetMemory.fill(0, _targetMemory.getSize(), 0xDF);
+        ASSERT_TRUE(_memoryMap.initialise(_entries, 4, std::size(_entries)));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+#ifdef BOOT_HEAP_STATS
+//! @brief Accumulates the text written by dumpHeapStats().
+std::string dumpedText;
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+#ifdef BOOT_HEAP_STATS
+void appendDumpedText(const char *text, size_t length)
+{
+    dumpedText.append(text, length);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(HeapTest, InitialiseFromLargestRegion)
+{
+    Heap specimen;
+
+    EXPECT_EQ(specimen.allocate(16), nullptr);
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+
+    EXPECT_EQ(specimen.getBaseAddress(), 0x103000u);
+    EXPECT_EQ(specimen.getCapacity(), 0xEFD000u);
+    EXPECT_EQ(specimen.getUsedSize(), 0u);
+
+    // The heap should be reserved until it is committed.
+    const MemMapEntry *region = _memoryMap.findRegion(0x103000);
+    ASSERT_NE(region, nullptr);
+    EXPECT_EQ(region->BaseAddress, 0x100000u);
+    EXPECT_EQ(region->Size, 0xF00000u);
+    EXPECT_EQ(region->Type, MemType::UsableAfterBoot);
+}
+
+TEST_F(HeapTest, InitialiseWithLimit)
+{
+    Heap specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap, 0x10800));
+
+    EXPECT_EQ(specimen.getBaseAddress(), 0x103000u);
+    EXPECT_EQ(specimen.getCapacity(), 0x10000u);
+
+    const MemMapEntry *region = _memoryMap.findRegion(0x113000);
+    ASSERT_NE(region, nullptr);
+    EXPECT_EQ(region->BaseAddress, 0x113000u);
+    EXPECT_EQ(region->Type, MemType::UsableRAM);
+
+    Heap tooSmall;
+    EXPECT_FALSE(tooSmall.initialise(_memoryMap, 0xFFF));
+}
+
+TEST_F(HeapTest, AllocateWithAlignment)
+{
+    Heap specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+
+    void *first = specimen.allocate(3);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(getPhysicalAddress(first), 0x103000u);
+
+    void *second = specimen.allocate(5);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(getPhysicalAddress(second), 0x103008u);
+
+    void *third = specimen.allocate(1, 1);
+    ASSERT_NE(third, nullptr);
+    EXPECT_EQ(getPhysicalAddress(third), 0x10300Du);
+
+    void *fourth = specimen.allocate(32, 0x1000);
+    ASSERT_NE(fourth, nullptr);
+    EXPECT_EQ(getPhysicalAddress(fourth), 0x104000u);
+    EXPECT_EQ(specimen.getUsedSize(), 0x1020u);
+
+    EXPECT_EQ(specimen.allocate(8, 0), nullptr);
+    EXPECT_EQ(specimen.allocate(8, 12), nullptr);
+    EXPECT_EQ(specimen.getUsedSize(), 0x1020u);
+}
+
+TEST_F(HeapTest, AllocateUntilFull)
+{
+    Heap specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap, 0x2000));
+
+    EXPECT_NE(specimen.allocate(0x1000), nullptr);
+    EXPECT_EQ(specimen.allocate(0x1001), nullptr);
+    EXPECT_EQ(specimen.allocate(SIZE_MAX), nullptr);
+    EXPECT_EQ(specimen.allocate(8, 0x8000), nullptr);
+    EXPECT_NE(specimen.allocate(0x1000), nullptr);
+    EXPECT_EQ(specimen.allocate(1, 1), nullptr);
+    EXPECT_EQ(specimen.getUsedSize(), 0x2000u);
+}
+
+TEST_F(HeapTest, MarkAndRelease)
+{
+    Heap specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+
+    void *persistent = specimen.allocate(100);
+    ASSERT_NE(persistent, nullptr);
+
+    Heap::Marker scope = specimen.mark();
+    void *temporary = specimen.allocate(0x10000);
+    ASSERT_NE(temporary, nullptr);
+    EXPECT_NE(specimen.allocate(0x10000), nullptr);
+
+    specimen.release(scope);
+    EXPECT_EQ(specimen.getUsedSize(), 100u);
+
+    // The space freed should be reused.
+    EXPECT_EQ(specimen.allocate(0x10000), temporary);
+
+    // Stale markers beyond the current position should be ignored.
+    Heap::Marker later = specimen.mark();
+    specimen.release(scope);
+    specimen.release(later);
+    EXPECT_EQ(specimen.getUsedSize(), 100u);
+}
+
+TEST_F(HeapTest, CommitReservesUsedExtent)
+{
+    Heap specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap));
+    ASSERT_NE(specimen.allocate(0x1800), nullptr);
+    ASSERT_TRUE(specimen.commit(_memoryMap));
+
+    EXPECT_EQ(specimen.allocate(1), nullptr);
+
+    // The used pages should be merged with the adjacent Loader32 reservation.
+    const MemMapEntry *region = _memoryMap.findRegion(0x104FFF);
+    ASSERT_NE(region, nullptr);
+    EXPECT_EQ(region->BaseAddress, 0x100000u);
+    EXPECT_EQ(region->Size, 0x5000u);
+    EXPECT_EQ(region->Type, MemType::UsableAfterBoot);
+
+    region = _memoryMap.findRegion(0x105000);
+    ASSERT_NE(region, nullptr);
+    EXPECT_EQ(region->BaseAddress, 0x105000u);
+    EXPECT_EQ(region->Size, 0xEFB000u);
+    EXPECT_EQ(region->Type, MemType::UsableRAM);
+}
+
+TEST_F(HeapTest, PoolTakenFromTopOfHeap)
+{
+    Heap specimen;
+
+    EXPECT_FALSE(specimen.createPool(0x1000));
+    EXPECT_EQ(specimen.allocateBlock(16), nullptr);
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap, 0x20000));
+    ASSERT_NE(specimen.allocate(0x100), nullptr);
+    ASSERT_TRUE(specimen.createPool(0x7800));
+
+    EXPECT_FALSE(specimen.createPool(0x1000));
+    EXPECT_EQ(specimen.getPoolSize(), 0x8000u);
+    EXPECT_EQ(specimen.getCapacity(), 0x18000u);
+    EXPECT_GT(specimen.getPoolFreeSize(), 0x7000u);
+
+    void *first = specimen.allocateBlock(100);
+    void *second = specimen.allocateBlock(200);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_GE(getPhysicalAddress(first), 0x11B000u);
+    EXPECT_LT(getPhysicalAddress(second), 0x123000u);
+
+    size_t freeSize = specimen.getPoolFreeSize();
+    specimen.freeBlock(first);
+    EXPECT_GT(specimen.getPoolFreeSize(), freeSize);
+
+    void *resized = specimen.reallocateBlock(second, 0x1000);
+    EXPECT_NE(resized, nullptr);
+    specimen.freeBlock(resized);
+
+    // Arena allocations must not stray into the pool.
+    EXPECT_EQ(specimen.allocate(0x18000), nullptr);
+    EXPECT_NE(specimen.allocate(0x17F00), nullptr);
+}
+
+TEST_F(HeapTest, PoolFailsWithoutSpace)
+{
+    Heap specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap, 0x4000));
+    ASSERT_NE(specimen.allocate(0x2800), nullptr);
+
+    EXPECT_FALSE(specimen.createPool(0x2000));
+    EXPECT_TRUE(specimen.createPool(0x1000));
+    EXPECT_EQ(specimen.getCapacity(), 0x3000u);
+}
+
+TEST_F(HeapTest, CommitKeepsPoolReserved)
+{
+    Heap specimen;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap, 0x20000));
+    ASSERT_TRUE(specimen.createPool(0x4000));
+    ASSERT_NE(specimen.allocate(0x1800), nullptr);
+    ASSERT_TRUE(specimen.commit(_memoryMap));
+
+    // The pool should still be usable after the arena is committed.
+    EXPECT_NE(specimen.allocateBlock(64), nullptr);
+
+    const MemMapEntry *region = _memoryMap.findRegion(0x105000);
+    ASSERT_NE(region, nullptr);
+    EXPECT_EQ(region->BaseAddress, 0x105000u);
+    EXPECT_EQ(region->Size, 0x1A000u);
+    EXPECT_EQ(region->Type, MemType::UsableRAM);
+
+    region = _memoryMap.findRegion(0x11F000);
+    ASSERT_NE(region, nullptr);
+    EXPECT_EQ(region->BaseAddress, 0x11F000u);
+    EXPECT_EQ(region->Size, 0x4000u);
+    EXPECT_EQ(region->Type, MemType::UsableAfterBoot);
+}
+
+#ifdef BOOT_HEAP_STATS
+TEST_F(HeapTest, StatsCountAllocations)
+{
+    Heap specimen;
+    HeapStats stats;
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap, 0x40000));
+    ASSERT_TRUE(specimen.createPool(0x20000));
+    ASSERT_TRUE(specimen.getStats(stats));
+    EXPECT_EQ(stats.BytesInUse, 0u);
+    EXPECT_EQ(stats.PoolSize, 0x20000u);
+    EXPECT_EQ(stats.PoolFreeSize, stats.LargestFreeBlock);
+    EXPECT_EQ(stats.FragmentationPerMille, 0u);
+
+    Heap::Marker start = specimen.mark();
+    ASSERT_NE(specimen.allocate(10), nullptr);
+    ASSERT_NE(specimen.allocate(100), nullptr);
+
+    void *small = specimen.allocateBlock(24);
+    void *large = specimen.allocateBlock(5000);
+    ASSERT_NE(small, nullptr);
+    ASSERT_NE(large, nullptr);
+
+    ASSERT_TRUE(specimen.getStats(stats));
+    EXPECT_EQ(stats.AllocationCounts[0], 1u);
+    EXPECT_EQ(stats.AllocationCounts[1], 1u);
+    EXPECT_EQ(stats.AllocationCounts[3], 1u);
+    EXPECT_EQ(stats.AllocationCounts[HeapStatsBucketCount - 1], 1u);
+    EXPECT_EQ(stats.BytesInUse, 116 + Tlsf::getBlockSize(small) + Tlsf::getBlockSize(large));
+
+    uint32_t peak = stats.BytesInUse;
+
+    specimen.freeBlock(small);
+    specimen.release(start);
+
+    ASSERT_TRUE(specimen.getStats(stats));
+    EXPECT_EQ(stats.FreeCounts[1], 1u);
+    EXPECT_EQ(stats.BytesInUse, Tlsf::getBlockSize(large));
+    EXPECT_EQ(stats.PeakBytesInUse, peak);
+
+    // Reallocation counts as a free and an allocation.
+    large = specimen.reallocateBlock(large, 6000);
+    ASSERT_NE(large, nullptr);
+    ASSERT_TRUE(specimen.getStats(stats));
+    EXPECT_EQ(stats.AllocationCounts[HeapStatsBucketCount - 1], 2u);
+    EXPECT_EQ(stats.FreeCounts[HeapStatsBucketCount - 1], 1u);
+    EXPECT_EQ(stats.BytesInUse, Tlsf::getBlockSize(large));
+}
+
+TEST_F(HeapTest, StatsMeasureFragmentation)
+{
+    Heap specimen;
+    HeapStats stats;
+    void *blocks[16];
+
+    ASSERT_TRUE(specimen.initialise(_memoryMap, 0x40000));
+    ASSERT_TRUE(specimen.createPool(0x10000));
+
+    for (void *&block : blocks)
+    {
+        block = specimen.allocateBlock(0xF00);
+        ASSERT_NE(block, nullptr);
+    }
+
+    // Free every other block, leaving the free space in small pieces.
+    for (size_t i = 0; i < std::size(blocks); i += 2)
+    {
+        specimen.freeBlock(blocks[i]);
+    }
+
+    ASSERT_TRUE(specimen.getStats(stats));
+    EXPECT_GT(stats.PoolFreeSize, 0x7000u);
+    EXPECT_LT(stats.LargestFreeBlock, 0x1000u);
+    EXPECT_GT(stats.FragmentationPerMille, 800u);
+}
+
+TEST_F(HeapTest, DumpStats)
+{
+    HeapStats stats = { };
+
+    stats.AllocationCounts[0] = 12;
+    stats.FreeCounts[0] = 3;
+    stats.AllocationCounts[HeapStatsBucketCount - 1] = 4000000000u;
+    stats.BytesInUse = 1234;
+    stats.PeakBytesInUse = 5678;
+    stats.PoolSize = 0x10000;
+    stats.FragmentationPerMille = 250;
+
+    dumpedText.clear();
+    dumpHeapStats(stats, appendDumpedText);
+
+    EXPECT_NE(dumpedText.find("Heap: in use 1234 bytes, peak 5678 bytes\n"), std::string::npos);
+    EXPECT_NE(dumpedText.find("size 65536 bytes"), std::string::npos);
+    EXPECT_NE(dumpedText.find("fragmentation 250/1000\n"), std::string::npos);
+    EXPECT_NE(dumpedText.find("  <= 16: 12 allocated, 3 freed\n"), std::string::npos);
+    EXPECT_NE(dumpedText.find("  >  4096: 4000000000 allocated, 0 freed\n"), std::string::npos);
+}
+#endif
+
+TEST_F(HeapTest, FailWithoutUsableRAM)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x100000, MemType::Reserved, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap memoryMap;
+    Heap specimen;
+
+    ASSERT_TRUE(memoryMap.initialise(entries, 1, std::size(entries)));
+    EXPECT_FALSE(specimen.initialise(memoryMap));
+    EXPECT_FALSE(specimen.commit(memoryMap));
+    EXPECT_EQ(specimen.allocate(1), nullptr);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -12,6 +12,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <gtest/gtest.h>
 
+#include <iterator>
+#include <vector>
+
 #include "Loader.hpp"
 #include "MemoryMap.hpp"
 #include "Test_TargetTools.hpp"
@@ -52,6 +55,64 @@ const char *memTypeToString(MemType memType)
 }
 
 
+//! @brief Combines overlapping memory types, specific types take precedence
+//! over usable RAM, otherwise the lowest valued type wins.
+MemType combineTypes(MemType lhs, MemType rhs)
+{
+    if (lhs == MemType::UsableRAM)
+        return rhs;
+
+    if (rhs == MemType::UsableRAM)
+        return lhs;
+
+    return (lhs < rhs) ? lhs : rhs;
+}
+
+//! @brief Creates a consolidated memory map from page-aligned entries by
+//! painting each page individually.
+std::vector<MemMapEntry> createReferenceMap(const std::vector<MemMapEntry> &entries,
+                                            uint64_t pageCount)
+{
+    constexpr uint64_t PageSize = 0x1000;
+    std::vector<MemType> pages(pageCount, MemType::Max);
+
+    for (const MemMapEntry &entry : entries)
+    {
+        uint64_t first = entry.BaseAddress / PageSize;
+        uint64_t last = (entry.BaseAddress + entry.Size) / PageSize;
+
+        for (uint64_t page = first; page < last; ++page)
+        {
+            pages[page] = (pages[page] == MemType::Max) ?
+                entry.Type : combineTypes(pages[page], entry.Type);
+        }
+    }
+
+    std::vector<MemMapEntry> regions;
+
+    for (uint64_t page = 0; page < pageCount; ++page)
+    {
+        if (pages[page] == MemType::Max)
+            continue;
+
+        if (regions.empty() == false)
+        {
+            MemMapEntry &prev = regions.back();
+
+            if ((prev.Type == pages[page]) &&
+                ((prev.BaseAddress + prev.Size) == (page * PageSize)))
+            {
+                prev.Size += PageSize;
+                continue;
+            }
+        }
+
+        regions.push_back({ page * PageSize, PageSize, pages[page], { 0 } });
+    }
+
+    return regions;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Unit Tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -161,7 +222,7 @@ TEST_F(MemMapTest, CreateSimpleMemoryMap)
 
     MemoryMap specimen;
 
-    ASSERT_TRUE(specimen.initialise(entries, 3));
+    ASSERT_TRUE(specimen.initialise(entries, 3, std::size(entries)));
     ASSERT_EQ(specimen.getRegions(), entries);
     ASSERT_EQ(specimen.getRegionCount(), 3u);
 
@@ -169,8 +230,7 @@ TEST_F(MemMapTest, CreateSimpleMemoryMap)
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x0, 0xA0000, MemType::UsableRAM));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xA0000, 0x60000, MemType::Reserved));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x100000, 0xF00000, MemType::UsableRAM));
-    EXPECT_TRUE(expectUnmodified(0x00, 0x100000));
-    EXPECT_TRUE(expectModified(0x100000, 0xF00000));
+    EXPECT_TRUE(expectUnmodified(0x00, 0x1000000));
 }
 
 TEST_F(MemMapTest, CreateUnorderedMemoryMap)
@@ -188,7 +248,7 @@ TEST_F(MemMapTest, CreateUnorderedMemoryMap)
 
     MemoryMap specimen;
 
-    ASSERT_TRUE(specimen.initialise(entries, 4));
+    ASSERT_TRUE(specimen.initialise(entries, 4, std::size(entries)));
     ASSERT_EQ(specimen.getRegions(), entries);
     ASSERT_EQ(specimen.getRegionCount(), 4u);
 
@@ -197,9 +257,7 @@ TEST_F(MemMapTest, CreateUnorderedMemoryMap)
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xA0000, 0x60000, MemType::Reserved));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x100000, 0xEFF000, MemType::UsableRAM));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xFFF000, 0x1000, MemType::Reserved));
-    EXPECT_TRUE(expectUnmodified(0x00, 0x100000));
-    EXPECT_TRUE(expectModified(0x100000, 0xEFF000));
-    EXPECT_TRUE(expectUnmodified(0xFFF000, 0x1000));
+    EXPECT_TRUE(expectUnmodified(0x00, 0x1000000));
 }
 
 TEST_F(MemMapTest, CreateComplexMemoryMap)
@@ -231,7 +289,7 @@ TEST_F(MemMapTest, CreateComplexMemoryMap)
 
     MemoryMap specimen;
 
-    ASSERT_TRUE(specimen.initialise(entries, 9));
+    ASSERT_TRUE(specimen.initialise(entries, 9, std::size(entries)));
     ASSERT_EQ(specimen.getRegions(), entries);
     ASSERT_EQ(specimen.getRegionCount(), 9u);
 
@@ -245,9 +303,7 @@ TEST_F(MemMapTest, CreateComplexMemoryMap)
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x103000, 0xEED000, MemType::UsableRAM));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xFF0000, 0x10000, MemType::AcpiReclaimable));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xFFFC0000, 0x40000, MemType::Reserved));
-    EXPECT_TRUE(expectUnmodified(0x00, 0x103000));
-    EXPECT_TRUE(expectModified(0x103000, 0xEFD000));
-    EXPECT_TRUE(expectUnmodified(0xFF0000, 0x10000));
+    EXPECT_TRUE(expectUnmodified(0x00, 0x1000000));
 }
 
 
@@ -268,7 +324,7 @@ TEST_F(MemMapTest, MergeConsecutiveRegions)
 
     MemoryMap specimen;
 
-    ASSERT_TRUE(specimen.initialise(entries, 5));
+    ASSERT_TRUE(specimen.initialise(entries, 5, std::size(entries)));
     ASSERT_EQ(specimen.getRegions(), entries);
     ASSERT_EQ(specimen.getRegionCount(), 4u);
 
@@ -277,9 +333,555 @@ TEST_F(MemMapTest, MergeConsecutiveRegions)
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xA0000, 0x60000, MemType::Reserved));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x100000, 0xEFF000, MemType::UsableRAM));
     EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xFFF000, 0x1000, MemType::Reserved));
-    EXPECT_TRUE(expectUnmodified(0x00, 0x100000));
-    EXPECT_TRUE(expectModified(0x100000, 0xEFF000));
-    EXPECT_TRUE(expectUnmodified(0xFFF000, 0x1000));
+    EXPECT_TRUE(expectUnmodified(0x00, 0x1000000));
+}
+
+TEST_F(MemMapTest, CreateLargeFragmentedMemoryMap)
+{
+    // Enough entries to use the radix sort, with reservations punched out of
+    // extended memory every other page, listed in descending order.
+    constexpr uint64_t HoleCount = 200;
+    std::vector<MemMapEntry> entries;
+
+    for (uint64_t i = HoleCount; i > 0; --i)
+    {
+        entries.push_back({ 0xFF000 + (i * 0x2000), 0x1000,
+                            MemType::Reserved, 0 });
+    }
+
+    entries.push_back({ 0x100000, 0xF00000, MemType::UsableRAM, 0 });
+    entries.push_back({ 0x00, 0xA0000, MemType::UsableRAM, 0 });
+    entries.push_back({ 0xA0000, 0x60000, MemType::Reserved, 0 });
+
+    const size_t count = entries.size();
+    entries.resize(count * 2);
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries.data(), count, entries.size()));
+    ASSERT_EQ(specimen.getRegionCount(), 3 + (HoleCount * 2));
+
+    size_t i = 0;
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x0, 0xA0000, MemType::UsableRAM));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xA0000, 0x60000, MemType::Reserved));
+
+    for (uint64_t hole = 1; hole <= HoleCount; ++hole)
+    {
+        uint64_t holeBase = 0xFF000 + (hole * 0x2000);
+
+        EXPECT_TRUE(expectMemoryRegion(entries[i++], holeBase - 0x1000, 0x1000,
+                                       MemType::UsableRAM));
+        EXPECT_TRUE(expectMemoryRegion(entries[i++], holeBase, 0x1000,
+                                       MemType::Reserved));
+    }
+
+    uint64_t tailBase = 0x100000 + (HoleCount * 0x2000);
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], tailBase, 0x1000000 - tailBase,
+                                   MemType::UsableRAM));
+    EXPECT_EQ(i, specimen.getRegionCount());
+}
+
+TEST_F(MemMapTest, ConsolidateGrowingMapInPlace)
+{
+    // Each hole splits extended memory, so the map grows as it is processed.
+    constexpr uint64_t HoleCount = 30;
+    std::vector<MemMapEntry> entries;
+
+    entries.push_back({ 0x100000, 0xF00000, MemType::UsableRAM, 0 });
+
+    for (uint64_t i = 0; i < HoleCount; ++i)
+    {
+        entries.push_back({ 0x101000 + (i * 0x2000), 0x1000, MemType::Reserved, 0 });
+    }
+
+    // Provide just enough slack to hold the consolidated map.
+    const size_t count = entries.size();
+    entries.resize((HoleCount * 2) + 1);
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries.data(), count, entries.size()));
+    ASSERT_EQ(specimen.getRegionCount(), entries.size());
+
+    for (uint64_t i = 0; i < HoleCount; ++i)
+    {
+        uint64_t holeBase = 0x101000 + (i * 0x2000);
+
+        EXPECT_TRUE(expectMemoryRegion(entries[i * 2], holeBase - 0x1000, 0x1000,
+                                       MemType::UsableRAM));
+        EXPECT_TRUE(expectMemoryRegion(entries[(i * 2) + 1], holeBase, 0x1000,
+                                       MemType::Reserved));
+    }
+
+    uint64_t tailBase = 0x100000 + (HoleCount * 0x2000);
+    EXPECT_TRUE(expectMemoryRegion(entries.back(), tailBase, 0x1000000 - tailBase,
+                                   MemType::UsableRAM));
+    EXPECT_TRUE(expectUnmodified(0x00, 0x1000000));
+}
+
+TEST_F(MemMapTest, ConsolidateWithoutSlack)
+{
+    // The holes grow the map early on, but redundant entries at the end
+    // shrink it back to its original size, leaving no slack to grow into.
+    constexpr uint64_t HoleCount = 30;
+    std::vector<MemMapEntry> entries;
+
+    entries.push_back({ 0x100000, 0xF00000, MemType::UsableRAM, 0 });
+
+    for (uint64_t i = 0; i < HoleCount; ++i)
+    {
+        entries.push_back({ 0x101000 + (i * 0x2000), 0x1000, MemType::Reserved, 0 });
+        entries.push_back({ 0xF00000, 0x1000, MemType::UsableRAM, 0 });
+    }
+
+    entries.push_back({ 0xF00000, 0x1000, MemType::UsableRAM, 0 });
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries.data(), entries.size(), entries.size()));
+    ASSERT_EQ(specimen.getRegionCount(), (HoleCount * 2) + 1);
+
+    for (uint64_t i = 0; i < HoleCount; ++i)
+    {
+        uint64_t holeBase = 0x101000 + (i * 0x2000);
+
+        EXPECT_TRUE(expectMemoryRegion(entries[i * 2], holeBase - 0x1000, 0x1000,
+                                       MemType::UsableRAM));
+        EXPECT_TRUE(expectMemoryRegion(entries[(i * 2) + 1], holeBase, 0x1000,
+                                       MemType::Reserved));
+    }
+
+    // The map had to be consolidated via temporary storage in usable RAM.
+    uint64_t tailBase = 0x100000 + (HoleCount * 0x2000);
+    EXPECT_TRUE(expectMemoryRegion(entries[HoleCount * 2], tailBase,
+                                   0x1000000 - tailBase, MemType::UsableRAM));
+    EXPECT_TRUE(expectModified(tailBase, 0x1000000 - tailBase));
+}
+
+TEST_F(MemMapTest, FailWhenCapacityExceeded)
+{
+    MemMapEntry entries[] = {
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+        { 0x200000, 0x1000, MemType::Reserved, 0 },
+    };
+
+    MemoryMap specimen;
+
+    EXPECT_FALSE(specimen.initialise(entries, std::size(entries), std::size(entries)));
+    EXPECT_FALSE(specimen.initialise(entries, std::size(entries), 1));
+}
+
+TEST_F(MemMapTest, ConsolidateThousandsOfOverlappingEntries)
+{
+    constexpr uint64_t PageSize = 0x1000;
+    constexpr uint64_t PageCount = 0x1000000 / PageSize;
+    const MemType types[] = {
+        MemType::UsableRAM, MemType::Reserved, MemType::AcpiReclaimable,
+        MemType::AcpiNvs, MemType::UsableAfterBoot, MemType::KernelImage,
+        MemType::DriverImage,
+    };
+
+    std::vector<MemMapEntry> entries;
+    uint32_t seed = 0x5EED;
+
+    entries.push_back({ 0, 0x1000000, MemType::UsableRAM, 0 });
+
+    // Cluster overlapping entries in the bottom half of memory, leaving the
+    // top half for temporary storage.
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        uint64_t page = (seed >> 8) % (PageCount / 2);
+        seed = (seed * 1103515245u) + 12345u;
+        uint64_t pages = 1 + ((seed >> 8) % 64);
+        seed = (seed * 1103515245u) + 12345u;
+        MemType type = types[(seed >> 8) % std::size(types)];
+
+        if ((page + pages) > (PageCount / 2))
+        {
+            pages = (PageCount / 2) - page;
+        }
+
+        entries.push_back({ page * PageSize, pages * PageSize, type, 0 });
+    }
+
+    std::vector<MemMapEntry> expected = createReferenceMap(entries, PageCount);
+    const size_t count = entries.size();
+    entries.resize(count * 2);
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries.data(), count, entries.size()));
+    ASSERT_EQ(specimen.getRegionCount(), expected.size());
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_TRUE(expectMemoryRegion(entries[i], expected[i].BaseAddress,
+                                       expected[i].Size, expected[i].Type)) <<
+            "Region " << i;
+    }
+}
+
+TEST_F(MemMapTest, ConsolidateNestedUsableRegions)
+{
+    // Each usable region overlaps all those which follow it, which made the
+    // previous search for temporary storage quadratic.
+    constexpr uint64_t Step = 0x100;
+    constexpr uint64_t EntryCount = 20000;
+    std::vector<MemMapEntry> entries;
+
+    for (uint64_t i = 0; i < EntryCount; ++i)
+    {
+        entries.push_back({ i * Step, (i + 2) * Step, MemType::UsableRAM, 0 });
+    }
+
+    entries.push_back({ 0, 0x10000, MemType::UsableAfterBoot, 0 });
+
+    const size_t count = entries.size();
+    entries.resize(count * 2);
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries.data(), count, entries.size()));
+    ASSERT_EQ(specimen.getRegionCount(), 2u);
+
+    const uint64_t end = ((EntryCount - 1) * Step) + ((EntryCount + 1) * Step);
+    EXPECT_TRUE(expectMemoryRegion(entries[0], 0, 0x10000, MemType::UsableAfterBoot));
+    EXPECT_TRUE(expectMemoryRegion(entries[1], 0x10000, end - 0x10000,
+                                   MemType::UsableRAM));
+}
+
+TEST_F(MemMapTest, ConsolidationStepsScaleLinearly)
+{
+    constexpr uint64_t PageSize = 0x1000;
+    constexpr uint64_t PageCount = 0x1000000 / PageSize;
+    const MemType types[] = {
+        MemType::UsableRAM, MemType::Reserved, MemType::AcpiNvs,
+        MemType::UsableAfterBoot, MemType::KernelImage,
+    };
+
+    // Consolidates a map of randomly overlapping entries and returns the
+    // count of steps the sweeps took.
+    auto measureSteps = [&](size_t entryCount) -> size_t
+    {
+        std::vector<MemMapEntry> entries;
+        uint32_t seed = 0xC0DE;
+
+        entries.push_back({ 0, 0x1000000, MemType::UsableRAM, 0 });
+
+        for (size_t i = 1; i < entryCount; ++i)
+        {
+            seed = (seed * 1103515245u) + 12345u;
+            uint64_t page = (seed >> 8) % (PageCount - 64);
+            seed = (seed * 1103515245u) + 12345u;
+            uint64_t pages = 1 + ((seed >> 8) % 64);
+            seed = (seed * 1103515245u) + 12345u;
+            MemType type = types[(seed >> 8) % std::size(types)];
+
+            entries.push_back({ page * PageSize, pages * PageSize, type, 0 });
+        }
+
+        const size_t count = entries.size();
+        entries.resize(count * 2);
+
+        MemoryMap specimen;
+        resetSweepStepCount();
+
+        EXPECT_TRUE(specimen.initialise(entries.data(), count, entries.size()));
+
+        return getSweepStepCount();
+    };
+
+    const size_t smallSteps = measureSteps(1000);
+    const size_t largeSteps = measureSteps(4000);
+
+    // Each entry is read once per sweep and can only disturb a bounded count
+    // of active memory types, so the work must grow with the entry count.
+    EXPECT_GT(smallSteps, 1000u);
+    EXPECT_LE(smallSteps, 1000u * std::size(types) * 8);
+    EXPECT_LE(largeSteps, 4000u * std::size(types) * 8);
+    EXPECT_LE(largeSteps, smallSteps * 5);
+}
+
+TEST_F(MemMapTest, FindRegion)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0xE8000, 0x18000, MemType::Reserved, 0 },
+        { 0x100000, 0xEF0000, MemType::UsableRAM, 0 },
+        { 0xFFFC0000, 0x40000, MemType::Reserved, 0 },
+    };
+
+    MemoryMap specimen;
+
+    EXPECT_EQ(specimen.findRegion(0), nullptr);
+    ASSERT_TRUE(specimen.initialise(entries, std::size(entries), std::size(entries)));
+
+    EXPECT_EQ(specimen.findRegion(0), &entries[0]);
+    EXPECT_EQ(specimen.findRegion(0x9EFFF), &entries[0]);
+    EXPECT_EQ(specimen.findRegion(0x9F000), &entries[1]);
+    EXPECT_EQ(specimen.findRegion(0xA0000), nullptr);
+    EXPECT_EQ(specimen.findRegion(0xE7FFF), nullptr);
+    EXPECT_EQ(specimen.findRegion(0xE8000), &entries[2]);
+    EXPECT_EQ(specimen.findRegion(0x800000), &entries[3]);
+    EXPECT_EQ(specimen.findRegion(0xFF0000), nullptr);
+    EXPECT_EQ(specimen.findRegion(0xFFFFFFFF), &entries[4]);
+    EXPECT_EQ(specimen.findRegion(0x100000000), nullptr);
+    EXPECT_EQ(specimen.findRegion(UINT64_MAX), nullptr);
+}
+
+TEST_F(MemMapTest, FindRegionsInRange)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0xE8000, 0x18000, MemType::Reserved, 0 },
+        { 0x100000, 0xEF0000, MemType::UsableRAM, 0 },
+        { 0xFFFC0000, 0x40000, MemType::Reserved, 0 },
+    };
+
+    MemoryMap specimen;
+    size_t count = 42;
+
+    ASSERT_TRUE(specimen.initialise(entries, std::size(entries), std::size(entries)));
+
+    EXPECT_EQ(specimen.findRegionsInRange(0x1000, 0, count), nullptr);
+    EXPECT_EQ(count, 0u);
+
+    EXPECT_EQ(specimen.findRegionsInRange(0x1000, 0x1000, count), &entries[0]);
+    EXPECT_EQ(count, 1u);
+
+    EXPECT_EQ(specimen.findRegionsInRange(0x9E000, 0x2000, count), &entries[0]);
+    EXPECT_EQ(count, 2u);
+
+    // Ranges spanning gaps only report the regions either side.
+    EXPECT_EQ(specimen.findRegionsInRange(0x9F800, 0x70000, count), &entries[1]);
+    EXPECT_EQ(count, 3u);
+
+    EXPECT_EQ(specimen.findRegionsInRange(0xA0000, 0x48000, count), nullptr);
+    EXPECT_EQ(count, 0u);
+
+    EXPECT_EQ(specimen.findRegionsInRange(0xFF0000, 0x1000, count), nullptr);
+    EXPECT_EQ(count, 0u);
+
+    EXPECT_EQ(specimen.findRegionsInRange(0, UINT64_MAX, count), &entries[0]);
+    EXPECT_EQ(count, 5u);
+
+    EXPECT_EQ(specimen.findRegionsInRange(0xFFFFF000, UINT64_MAX, count), &entries[4]);
+    EXPECT_EQ(count, 1u);
+}
+
+TEST_F(MemMapTest, FindRegionInLargeMap)
+{
+    // Enough regions that lookups need both levels of the index, with a gap
+    // after every third region.
+    constexpr uint64_t RegionCount = 999;
+    std::vector<MemMapEntry> entries;
+
+    for (uint64_t i = 0; i < RegionCount; ++i)
+    {
+        uint64_t base = (i * 0x2000) + ((i / 3) * 0x1000);
+        MemType type = ((i % 3) == 1) ? MemType::Reserved : MemType::UsableRAM;
+
+        entries.push_back({ base, 0x2000, type, 0 });
+    }
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries.data(), entries.size(), entries.size()));
+    ASSERT_EQ(specimen.getRegionCount(), RegionCount);
+
+    for (uint64_t address = 0; address < 0x800000; address += 0x800)
+    {
+        const MemMapEntry *linearMatch = nullptr;
+
+        for (const MemMapEntry &entry : entries)
+        {
+            if ((address >= entry.BaseAddress) &&
+                (address < (entry.BaseAddress + entry.Size)))
+            {
+                linearMatch = &entry;
+                break;
+            }
+        }
+
+        EXPECT_EQ(specimen.findRegion(address), linearMatch) <<
+            "Address 0x" << std::hex << address;
+    }
+
+    size_t count = 0;
+    const MemMapEntry *first = specimen.findRegionsInRange(0x5000, 0x6000, count);
+
+    ASSERT_EQ(first, entries.data() + 2);
+    EXPECT_EQ(count, 3u);
+}
+
+TEST_F(MemMapTest, ReserveSplitsRegion)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0xA0000, MemType::UsableRAM, 0 },
+        { 0xA0000, 0x60000, MemType::Reserved, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries, 3, std::size(entries)));
+    ASSERT_TRUE(specimen.reserve(0x200000, 0x10000, MemType::KernelImage));
+    ASSERT_EQ(specimen.getRegionCount(), 5u);
+
+    size_t i = 0;
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x0, 0xA0000, MemType::UsableRAM));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0xA0000, 0x60000, MemType::Reserved));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x100000, 0x100000, MemType::UsableRAM));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x200000, 0x10000, MemType::KernelImage));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x210000, 0xDF0000, MemType::UsableRAM));
+
+    EXPECT_EQ(specimen.findRegion(0x20FFFF), &entries[3]);
+    EXPECT_EQ(specimen.findRegion(0x210000), &entries[4]);
+}
+
+TEST_F(MemMapTest, ReserveMergesNeighbours)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0xA0000, MemType::UsableRAM, 0 },
+        { 0x100000, 0x3000, MemType::UsableAfterBoot, 0 },
+        { 0x103000, 0xEFD000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries, 3, std::size(entries)));
+
+    // Extend the existing reservation, which should not need a new region.
+    ASSERT_TRUE(specimen.reserve(0x103000, 0x5000, MemType::UsableAfterBoot));
+    ASSERT_EQ(specimen.getRegionCount(), 3u);
+
+    size_t i = 0;
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x0, 0xA0000, MemType::UsableRAM));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x100000, 0x8000, MemType::UsableAfterBoot));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x108000, 0xEF8000, MemType::UsableRAM));
+
+    // Reserve the remainder of extended memory, swallowing the last region.
+    ASSERT_TRUE(specimen.reserve(0x108000, 0xEF8000, MemType::UsableAfterBoot));
+    ASSERT_EQ(specimen.getRegionCount(), 2u);
+    EXPECT_TRUE(expectMemoryRegion(entries[1], 0x100000, 0xF00000, MemType::UsableAfterBoot));
+}
+
+TEST_F(MemMapTest, ReserveCombinesTypes)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries, 2, std::size(entries)));
+
+    // Firmware reservations take precedence over those made by Helix.
+    ASSERT_TRUE(specimen.reserve(0x90000, 0x10000, MemType::DriverImage));
+    ASSERT_EQ(specimen.getRegionCount(), 3u);
+
+    size_t i = 0;
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x0, 0x90000, MemType::UsableRAM));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x90000, 0xF000, MemType::DriverImage));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x9F000, 0x1000, MemType::Reserved));
+
+    // The lowest valued Helix type takes precedence.
+    ASSERT_TRUE(specimen.reserve(0x98000, 0x1000, MemType::UsableAfterBoot));
+    ASSERT_TRUE(specimen.reserve(0x98000, 0x1000, MemType::KernelImage));
+    ASSERT_EQ(specimen.getRegionCount(), 5u);
+    EXPECT_TRUE(expectMemoryRegion(entries[2], 0x98000, 0x1000, MemType::UsableAfterBoot));
+}
+
+TEST_F(MemMapTest, ReserveFailsOutsideMap)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0xA0000, MemType::UsableRAM, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries, 2, std::size(entries)));
+
+    EXPECT_FALSE(specimen.reserve(0x1000, 0, MemType::KernelImage));
+    EXPECT_FALSE(specimen.reserve(0x9F000, 0x2000, MemType::KernelImage));
+    EXPECT_FALSE(specimen.reserve(0xA0000, 0x1000, MemType::KernelImage));
+    EXPECT_FALSE(specimen.reserve(0x90000, 0x80000, MemType::KernelImage));
+    EXPECT_FALSE(specimen.reserve(0xFFF000, 0x2000, MemType::KernelImage));
+    EXPECT_EQ(specimen.getRegionCount(), 2u);
+}
+
+TEST_F(MemMapTest, ReserveFailsWithoutCapacity)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0xA0000, MemType::UsableRAM, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries, 2, std::size(entries)));
+
+    EXPECT_FALSE(specimen.reserve(0x200000, 0x1000, MemType::KernelImage));
+    EXPECT_EQ(specimen.getRegionCount(), 2u);
+
+    // Reserving the start of a region only needs one split.
+    ASSERT_TRUE(specimen.reserve(0x100000, 0x1000, MemType::KernelImage));
+    ASSERT_EQ(specimen.getRegionCount(), 3u);
+    EXPECT_TRUE(expectMemoryRegion(entries[1], 0x100000, 0x1000, MemType::KernelImage));
+    EXPECT_TRUE(expectMemoryRegion(entries[2], 0x101000, 0xEFF000, MemType::UsableRAM));
+}
+
+TEST_F(MemMapTest, ReleaseRestoresUsableRAM)
+{
+    MemMapEntry entries[] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+        { 0x0, 0x0, MemType::Unknown, 0 },
+    };
+
+    MemoryMap specimen;
+
+    ASSERT_TRUE(specimen.initialise(entries, 3, std::size(entries)));
+    ASSERT_TRUE(specimen.reserve(0x200000, 0x10000, MemType::KernelImage));
+    ASSERT_TRUE(specimen.reserve(0x210000, 0x8000, MemType::DriverImage));
+    ASSERT_EQ(specimen.getRegionCount(), 6u);
+
+    // Release part of the kernel image.
+    ASSERT_TRUE(specimen.release(0x208000, 0x8000));
+    ASSERT_EQ(specimen.getRegionCount(), 7u);
+    EXPECT_TRUE(expectMemoryRegion(entries[3], 0x200000, 0x8000, MemType::KernelImage));
+    EXPECT_TRUE(expectMemoryRegion(entries[4], 0x208000, 0x8000, MemType::UsableRAM));
+    EXPECT_TRUE(expectMemoryRegion(entries[5], 0x210000, 0x8000, MemType::DriverImage));
+
+    // Firmware reservations and gaps are left alone.
+    ASSERT_TRUE(specimen.release(0, 0x1000000));
+    ASSERT_EQ(specimen.getRegionCount(), 3u);
+
+    size_t i = 0;
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x0, 0x9F000, MemType::UsableRAM));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x9F000, 0x1000, MemType::Reserved));
+    EXPECT_TRUE(expectMemoryRegion(entries[i++], 0x100000, 0xF00000, MemType::UsableRAM));
+
+    EXPECT_TRUE(specimen.release(0xA0000, 0x1000));
+    EXPECT_EQ(specimen.getRegionCount(), 3u);
 }
 
 } // Anonymous namespace
@@ -0,0 +1,73 @@
+//! @file BootUtils/Test_MemoryTools.cpp
+//! @brief The definition of unit tests for the simple memory block functions.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include "MemoryTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Copies a block between two offsets in word-aligned buffers and
+//! checks that only the block is written.
+void expectCopy(size_t targetOffset, size_t sourceOffset, size_t size)
+{
+    alignas(sizeof(size_t)) uint8_t source[64];
+    alignas(sizeof(size_t)) uint8_t target[64];
+
+    for (size_t i = 0; i < sizeof(source); ++i)
+    {
+        source[i] = static_cast<uint8_t>(i + 1);
+        target[i] = 0xDF;
+    }
+
+    Memory::copy(target + targetOffset, source + sourceOffset, size);
+
+    for (size_t i = 0; i < sizeof(target); ++i)
+    {
+        if ((i >= targetOffset) && (i < targetOffset + size))
+        {
+            EXPECT_EQ(target[i], source[i - targetOffset + sourceOffset]) << "at " << i;
+        }
+        else
+        {
+            EXPECT_EQ(target[i], 0xDF) << "at " << i;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST(MemoryTools, CopyAligned)
+{
+    expectCopy(0, 0, 0);
+    expectCopy(0, 0, 32);
+    expectCopy(8, 16, 27);
+}
+
+TEST(MemoryTools, CopyUnaligned)
+{
+    expectCopy(1, 0, 32);
+    expectCopy(0, 3, 29);
+    expectCopy(5, 5, 21);
+    expectCopy(7, 2, 1);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,282 @@
+//! @file BootUtils/Test_ReadScheduler.cpp
+//! @brief The definition of unit tests for the ReadScheduler class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "ReadScheduler.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+class ReadSchedulerTest : public BootDeviceTest
+{
+protected:
+    static constexpr uint8_t SectorSizePow2 = 9;
+    static constexpr uint32_t WindowSize = 16;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+std::vector<uint64_t> createBuffer(uint32_t sectorCount)
+{
+    return std::vector<uint64_t>((sectorCount * 512) / sizeof(uint64_t), 0xDFDFDFDF);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(ReadSchedulerTest, FailsWithBadParameters)
+{
+    ReadScheduler specimen;
+
+    EXPECT_EQ(specimen.read(nullptr, 0, 1), 0u);
+    EXPECT_FALSE(specimen.queue(nullptr, 0, 1));
+    EXPECT_FALSE(specimen.initialise(_heap, nullptr, SectorSizePow2, WindowSize, 8));
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, SectorSizePow2, 0, 8));
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, 17, WindowSize, 8));
+    EXPECT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 8));
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 8));
+    EXPECT_EQ(specimen.getWindowSize(), WindowSize);
+}
+
+TEST_F(ReadSchedulerTest, RandomReadsGoDirect)
+{
+    ReadScheduler specimen;
+    auto buffer = createBuffer(2);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 0));
+
+    EXPECT_EQ(specimen.read(buffer.data(), 100, 2), 2u);
+    EXPECT_TRUE(expectSectors(buffer, 100, 2));
+    EXPECT_EQ(specimen.read(buffer.data(), 500, 2), 2u);
+    EXPECT_TRUE(expectSectors(buffer, 500, 2));
+    EXPECT_EQ(specimen.read(buffer.data(), 99, 1), 1u);
+    EXPECT_TRUE(expectSectors(buffer, 99, 1));
+
+    const std::vector<DeviceRead> expected = {
+        { 100, 2 }, { 500, 2 }, { 99, 1 },
+    };
+
+    EXPECT_EQ(Reads, expected);
+    EXPECT_EQ(specimen.getModeSwitchCount(), 3u);
+    EXPECT_EQ(specimen.getUnscheduledSwitchCount(), 3u);
+    EXPECT_EQ(specimen.getSavedSwitchCount(), 0u);
+}
+
+TEST_F(ReadSchedulerTest, SequentialReadsPrefetchWindow)
+{
+    ReadScheduler specimen;
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 0));
+
+    for (uint32_t sector = 0; sector < 18; sector += 2)
+    {
+        auto buffer = createBuffer(2);
+
+        EXPECT_EQ(specimen.read(buffer.data(), sector, 2), 2u);
+        EXPECT_TRUE(expectSectors(buffer, sector, 2));
+    }
+
+    // The first read can't be known to be sequential, the second should
+    // read ahead a whole window which satisfies the next seven.
+    const std::vector<DeviceRead> expected = {
+        { 0, 2 }, { 2, WindowSize },
+    };
+
+    EXPECT_EQ(Reads, expected);
+    EXPECT_EQ(specimen.getModeSwitchCount(), 2u);
+    EXPECT_EQ(specimen.getUnscheduledSwitchCount(), 9u);
+    EXPECT_EQ(specimen.getSavedSwitchCount(), 7u);
+
+    // Continuing the sequence should prefetch the next window.
+    auto buffer = createBuffer(4);
+    EXPECT_EQ(specimen.read(buffer.data(), 18, 4), 4u);
+    EXPECT_TRUE(expectSectors(buffer, 18, 4));
+    ASSERT_EQ(Reads.size(), 3u);
+    EXPECT_EQ(Reads.back(), DeviceRead({ 18, WindowSize }));
+}
+
+TEST_F(ReadSchedulerTest, ReadsStraddlingBufferUseIt)
+{
+    ReadScheduler specimen;
+    auto buffer = createBuffer(2);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 0));
+    ASSERT_EQ(specimen.read(buffer.data(), 40, 2), 2u);
+    ASSERT_EQ(specimen.read(buffer.data(), 42, 2), 2u);
+    Reads.clear();
+
+    // Sectors 42-57 are buffered, so only the tail should be fetched.
+    buffer = createBuffer(10);
+    EXPECT_EQ(specimen.read(buffer.data(), 52, 10), 10u);
+    EXPECT_TRUE(expectSectors(buffer, 52, 10));
+
+    const std::vector<DeviceRead> expected = {
+        { 58, 4 },
+    };
+
+    EXPECT_EQ(Reads, expected);
+}
+
+TEST_F(ReadSchedulerTest, LargeSequentialReadsBypassBuffer)
+{
+    ReadScheduler specimen;
+    auto buffer = createBuffer(40);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 0));
+
+    EXPECT_EQ(specimen.read(buffer.data(), 0, 4), 4u);
+    EXPECT_EQ(specimen.read(buffer.data(), 4, 40), 40u);
+    EXPECT_TRUE(expectSectors(buffer, 4, 40));
+
+    const std::vector<DeviceRead> expected = {
+        { 0, 4 }, { 4, 40 },
+    };
+
+    EXPECT_EQ(Reads, expected);
+    EXPECT_EQ(specimen.getModeSwitchCount(), 4u);
+    EXPECT_EQ(specimen.getSavedSwitchCount(), 0u);
+}
+
+TEST_F(ReadSchedulerTest, QueuedReadsAreCoalesced)
+{
+    ReadScheduler specimen;
+    auto first = createBuffer(2);
+    auto second = createBuffer(4);
+    auto third = createBuffer(2);
+    auto fourth = createBuffer(1);
+    auto fifth = createBuffer(3);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 8));
+
+    EXPECT_TRUE(specimen.queue(first.data(), 10, 2));
+    EXPECT_TRUE(specimen.queue(second.data(), 4, 4));
+    EXPECT_TRUE(specimen.queue(third.data(), 8, 2));
+    EXPECT_TRUE(specimen.queue(fourth.data(), 40, 1));
+    EXPECT_TRUE(specimen.queue(fifth.data(), 11, 3));
+    EXPECT_EQ(specimen.getPendingCount(), 5u);
+    EXPECT_TRUE(Reads.empty());
+
+    EXPECT_TRUE(specimen.flush());
+    EXPECT_EQ(specimen.getPendingCount(), 0u);
+    EXPECT_TRUE(expectSectors(first, 10, 2));
+    EXPECT_TRUE(expectSectors(second, 4, 4));
+    EXPECT_TRUE(expectSectors(third, 8, 2));
+    EXPECT_TRUE(expectSectors(fourth, 40, 1));
+    EXPECT_TRUE(expectSectors(fifth, 11, 3));
+
+    const std::vector<DeviceRead> expected = {
+        { 4, 10 }, { 40, 1 },
+    };
+
+    EXPECT_EQ(Reads, expected);
+    EXPECT_EQ(specimen.getModeSwitchCount(), 2u);
+    EXPECT_EQ(specimen.getUnscheduledSwitchCount(), 5u);
+    EXPECT_EQ(specimen.getSavedSwitchCount(), 3u);
+}
+
+TEST_F(ReadSchedulerTest, LargeGroupsSplitIntoWindows)
+{
+    ReadScheduler specimen;
+    auto first = createBuffer(10);
+    auto second = createBuffer(20);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 8));
+
+    EXPECT_TRUE(specimen.queue(second.data(), 10, 20));
+    EXPECT_TRUE(specimen.queue(first.data(), 0, 10));
+    EXPECT_TRUE(specimen.flush());
+    EXPECT_TRUE(expectSectors(first, 0, 10));
+    EXPECT_TRUE(expectSectors(second, 10, 20));
+
+    const std::vector<DeviceRead> expected = {
+        { 0, WindowSize }, { WindowSize, 30 - WindowSize },
+    };
+
+    EXPECT_EQ(Reads, expected);
+    EXPECT_EQ(specimen.getSavedSwitchCount(), 1u);
+}
+
+TEST_F(ReadSchedulerTest, FullQueueRejectsRequests)
+{
+    ReadScheduler specimen;
+    auto buffer = createBuffer(1);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 2));
+
+    EXPECT_TRUE(specimen.queue(buffer.data(), 0, 1));
+    EXPECT_TRUE(specimen.queue(buffer.data(), 1, 1));
+    EXPECT_FALSE(specimen.queue(buffer.data(), 2, 1));
+    EXPECT_EQ(specimen.getPendingCount(), 2u);
+
+    specimen.invalidate();
+    EXPECT_EQ(specimen.getPendingCount(), 0u);
+    EXPECT_TRUE(specimen.flush());
+    EXPECT_TRUE(Reads.empty());
+}
+
+TEST_F(ReadSchedulerTest, DeviceFailureIsReported)
+{
+    ReadScheduler specimen;
+    auto buffer = createBuffer(4);
+
+    SectorLimit = 20;
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 4));
+
+    EXPECT_EQ(specimen.read(buffer.data(), 10, 4), 4u);
+    EXPECT_EQ(specimen.read(buffer.data(), 14, 4), 4u);
+    EXPECT_TRUE(expectSectors(buffer, 14, 4));
+    EXPECT_EQ(specimen.read(buffer.data(), 18, 4), 2u);
+    EXPECT_TRUE(expectSectors(buffer, 18, 2));
+
+    auto queued = createBuffer(10);
+    EXPECT_TRUE(specimen.queue(queued.data(), 15, 10));
+    EXPECT_FALSE(specimen.flush());
+    EXPECT_TRUE(expectSectors(queued, 15, 5));
+}
+
+TEST_F(ReadSchedulerTest, ReadAheadPastEndOfMedia)
+{
+    ReadScheduler specimen;
+    auto buffer = createBuffer(4);
+
+    // The device fails any command which crosses the end of the media, so
+    // the read-ahead window must not stop valid sectors being read.
+    SectorLimit = 20;
+    RejectsPartialReads = true;
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, WindowSize, 4));
+
+    EXPECT_EQ(specimen.read(buffer.data(), 10, 2), 2u);
+    EXPECT_TRUE(expectSectors(buffer, 10, 2));
+    EXPECT_EQ(specimen.read(buffer.data(), 12, 4), 4u);
+    EXPECT_TRUE(expectSectors(buffer, 12, 4));
+    EXPECT_EQ(specimen.read(buffer.data(), 16, 4), 4u);
+    EXPECT_TRUE(expectSectors(buffer, 16, 4));
+    EXPECT_EQ(specimen.read(buffer.data(), 20, 1), 0u);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
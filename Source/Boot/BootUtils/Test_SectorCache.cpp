@@ -0,0 +1,182 @@
+//! @file BootUtils/Test_SectorCache.cpp
+//! @brief The definition of unit tests for the SectorCache class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "SectorCache.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+class SectorCacheTest : public BootDeviceTest
+{
+protected:
+    static constexpr uint8_t SectorSizePow2 = 9;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+std::vector<uint64_t> createBuffer(uint32_t sectorCount)
+{
+    return std::vector<uint64_t>((sectorCount * 512) / sizeof(uint64_t), 0xDFDFDFDF);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(SectorCacheTest, FailsWithBadParameters)
+{
+    SectorCache specimen;
+
+    EXPECT_EQ(specimen.read(nullptr, 0, 1), 0u);
+    EXPECT_FALSE(specimen.initialise(_heap, nullptr, SectorSizePow2, 16));
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, SectorSizePow2, 0));
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, 17, 16));
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, SectorSizePow2, 0x10000));
+    EXPECT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, 16));
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, SectorSizePow2, 16));
+}
+
+TEST_F(SectorCacheTest, ReleaseMemoryOnFailure)
+{
+    SectorCache specimen;
+    size_t usedSize = _heap.getUsedSize();
+
+    // The sector data needs more than the whole heap.
+    EXPECT_FALSE(specimen.initialise(_heap, readSectors, SectorSizePow2, 0x1000));
+    EXPECT_EQ(_heap.getUsedSize(), usedSize);
+    EXPECT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, 16));
+}
+
+TEST_F(SectorCacheTest, RepeatedReadsHitCache)
+{
+    SectorCache specimen;
+    auto buffer = createBuffer(4);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, 16));
+
+    EXPECT_EQ(specimen.read(buffer.data(), 16, 4), 4u);
+    EXPECT_TRUE(expectSectors(buffer, 16, 4));
+    EXPECT_EQ(specimen.getMissCount(), 4u);
+    EXPECT_EQ(specimen.getHitCount(), 0u);
+    EXPECT_EQ(specimen.getCachedCount(), 4u);
+
+    buffer = createBuffer(4);
+    EXPECT_EQ(specimen.read(buffer.data(), 16, 4), 4u);
+    EXPECT_TRUE(expectSectors(buffer, 16, 4));
+    EXPECT_EQ(specimen.getHitCount(), 4u);
+    EXPECT_EQ(specimen.getDeviceReadCount(), 1u);
+    ASSERT_EQ(Reads.size(), 1u);
+}
+
+TEST_F(SectorCacheTest, ReadOnlyMissingRuns)
+{
+    SectorCache specimen;
+    auto buffer = createBuffer(8);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, 16));
+    ASSERT_EQ(specimen.read(buffer.data(), 102, 1), 1u);
+    ASSERT_EQ(specimen.read(buffer.data(), 105, 2), 2u);
+    Reads.clear();
+
+    // Sectors 102, 105 and 106 are cached, so 100-101, 103-104 and 107
+    // should be fetched.
+    buffer = createBuffer(8);
+    EXPECT_EQ(specimen.read(buffer.data(), 100, 8), 8u);
+    EXPECT_TRUE(expectSectors(buffer, 100, 8));
+
+    const std::vector<DeviceRead> expected = {
+        { 100, 2 }, { 103, 2 }, { 107, 1 },
+    };
+
+    EXPECT_EQ(Reads, expected);
+    EXPECT_EQ(specimen.getHitCount(), 3u);
+    EXPECT_EQ(specimen.getMissCount(), 8u);
+    EXPECT_EQ(specimen.getCachedCount(), 8u);
+}
+
+TEST_F(SectorCacheTest, EvictLeastRecentlyUsed)
+{
+    SectorCache specimen;
+    auto buffer = createBuffer(1);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, 4));
+
+    for (uint64_t sector = 0; sector < 4; ++sector)
+    {
+        ASSERT_EQ(specimen.read(buffer.data(), sector * 64, 1), 1u);
+    }
+
+    // Touch sector 0 so that sector 64 becomes the least recently used.
+    ASSERT_EQ(specimen.read(buffer.data(), 0, 1), 1u);
+    ASSERT_EQ(specimen.read(buffer.data(), 1000, 1), 1u);
+
+    EXPECT_EQ(specimen.getCachedCount(), 4u);
+    EXPECT_TRUE(specimen.isCached(0));
+    EXPECT_FALSE(specimen.isCached(64));
+    EXPECT_TRUE(specimen.isCached(128));
+    EXPECT_TRUE(specimen.isCached(192));
+    EXPECT_TRUE(specimen.isCached(1000));
+
+    ASSERT_EQ(specimen.read(buffer.data(), 2000, 1), 1u);
+    EXPECT_FALSE(specimen.isCached(128));
+    EXPECT_TRUE(expectSectors(buffer, 2000, 1));
+}
+
+TEST_F(SectorCacheTest, LongRunsBypassCache)
+{
+    SectorCache specimen;
+    auto buffer = createBuffer(32);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, 16));
+    ASSERT_EQ(specimen.read(buffer.data(), 16, 1), 1u);
+
+    EXPECT_EQ(specimen.read(buffer.data(), 100, 32), 32u);
+    EXPECT_TRUE(expectSectors(buffer, 100, 32));
+    EXPECT_EQ(specimen.getCachedCount(), 1u);
+    EXPECT_TRUE(specimen.isCached(16));
+}
+
+TEST_F(SectorCacheTest, StopOnDeviceFailure)
+{
+    SectorCache specimen;
+    auto buffer = createBuffer(8);
+
+    ASSERT_TRUE(specimen.initialise(_heap, readSectors, SectorSizePow2, 16));
+    SectorLimit = 205;
+
+    EXPECT_EQ(specimen.read(buffer.data(), 200, 8), 5u);
+    EXPECT_TRUE(expectSectors(buffer, 200, 5));
+    EXPECT_TRUE(specimen.isCached(204));
+    EXPECT_FALSE(specimen.isCached(205));
+
+    specimen.invalidate();
+    EXPECT_EQ(specimen.getCachedCount(), 0u);
+    EXPECT_FALSE(specimen.isCached(200));
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
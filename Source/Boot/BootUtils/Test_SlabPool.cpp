@@ -0,0 +1,320 @@
+//! @file BootUtils/Test_SlabPool.cpp
+//! @brief The definition of unit tests for the SlabAllocator, SlabPool and
+//! SizeClassAllocator classes.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "Heap.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+#include "SlabPool.hpp"
+#include "Test_TargetTools.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+class SlabPoolTest : public testing::Test
+{
+private:
+    static constexpr size_t RamSizeInMb = 16;
+    TargetMemoryMap _targetMemory;
+
+protected:
+    static constexpr size_t PoolSize = 0x10000;
+
+    MemMapEntry _entries[8] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+    };
+
+    MemoryMap _memoryMap;
+    Heap _heap;
+
+public:
+    SlabPoolTest() :
+        _targetMemory(RamSizeInMb)
+    {
+    }
+
+    void SetUp()
+    {
+        _targetMemory.fill(0, _targetMemory.getSize(), 0xDF);
+        ASSERT_TRUE(_memoryMap.initialise(_entries, 3, std::size(_entries)));
+        ASSERT_TRUE(_heap.initialise(_memoryMap, 0x20000));
+        ASSERT_TRUE(_heap.createPool(PoolSize));
+    }
+};
+
+//! @brief An object which records its construction and destruction.
+struct TrackedItem
+{
+    static int LiveCount;
+
+    uint32_t Value;
+    uint16_t Tag;
+
+    TrackedItem(uint32_t value, uint16_t tag) :
+        Value(value),
+        Tag(tag)
+    {
+        ++LiveCount;
+    }
+
+    ~TrackedItem()
+    {
+        --LiveCount;
+    }
+};
+
+int TrackedItem::LiveCount = 0;
+
+//! @brief An object with an alignment larger than a pointer.
+struct alignas(32) AlignedItem
+{
+    uint8_t Data[40];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST_F(SlabPoolTest, AllocateWithoutInitialise)
+{
+    SlabAllocator specimen;
+
+    EXPECT_EQ(specimen.allocate(), nullptr);
+    EXPECT_FALSE(specimen.initialise(_heap, 16, 12));
+    EXPECT_FALSE(specimen.initialise(_heap, SlabAllocator::SlabSize));
+}
+
+TEST_F(SlabPoolTest, ObjectsPackDensely)
+{
+    SlabAllocator specimen;
+
+    ASSERT_TRUE(specimen.initialise(_heap, 24, 8));
+    EXPECT_EQ(specimen.getObjectSize(), 24u);
+    EXPECT_EQ(specimen.getSlabCount(), 0u);
+
+    uint8_t *previous = static_cast<uint8_t *>(specimen.allocate());
+    ASSERT_NE(previous, nullptr);
+    EXPECT_EQ(specimen.getSlabCount(), 1u);
+
+    for (size_t i = 1; i < specimen.getObjectsPerSlab(); ++i)
+    {
+        uint8_t *next = static_cast<uint8_t *>(specimen.allocate());
+
+        ASSERT_EQ(next, previous + 24);
+        previous = next;
+    }
+
+    EXPECT_EQ(specimen.getSlabCount(), 1u);
+    EXPECT_GE(specimen.getObjectsPerSlab() * 24, SlabAllocator::SlabSize - 32);
+
+    // The next allocation should require a new slab.
+    EXPECT_NE(specimen.allocate(), nullptr);
+    EXPECT_EQ(specimen.getSlabCount(), 2u);
+    EXPECT_EQ(specimen.getUsedCount(), specimen.getObjectsPerSlab() + 1);
+}
+
+TEST_F(SlabPoolTest, FreedObjectsAreReused)
+{
+    SlabAllocator specimen;
+
+    ASSERT_TRUE(specimen.initialise(_heap, 2));
+    EXPECT_EQ(specimen.getObjectSize(), sizeof(void *));
+
+    void *first = specimen.allocate();
+    void *second = specimen.allocate();
+
+    specimen.free(first);
+    specimen.free(nullptr);
+    EXPECT_EQ(specimen.getUsedCount(), 1u);
+
+    EXPECT_EQ(specimen.allocate(), first);
+    specimen.free(second);
+    EXPECT_EQ(specimen.allocate(), second);
+    EXPECT_EQ(specimen.getSlabCount(), 1u);
+}
+
+TEST_F(SlabPoolTest, ClearReturnsSlabsToHeap)
+{
+    size_t initialFree = _heap.getPoolFreeSize();
+
+    {
+        SlabAllocator specimen;
+        ASSERT_TRUE(specimen.initialise(_heap, 100));
+
+        for (size_t i = 0; i < 200; ++i)
+        {
+            ASSERT_NE(specimen.allocate(), nullptr);
+        }
+
+        EXPECT_GT(specimen.getSlabCount(), 1u);
+        EXPECT_LT(_heap.getPoolFreeSize(), initialFree);
+
+        specimen.clear();
+        EXPECT_EQ(specimen.getSlabCount(), 0u);
+        EXPECT_EQ(specimen.getUsedCount(), 0u);
+        EXPECT_EQ(_heap.getPoolFreeSize(), initialFree);
+
+        // The allocator should still be usable.
+        ASSERT_NE(specimen.allocate(), nullptr);
+        EXPECT_LT(_heap.getPoolFreeSize(), initialFree);
+    }
+
+    // Destruction should also return the slabs.
+    EXPECT_EQ(_heap.getPoolFreeSize(), initialFree);
+}
+
+TEST_F(SlabPoolTest, FailWhenHeapExhausted)
+{
+    SlabAllocator specimen;
+    size_t count = 0;
+
+    ASSERT_TRUE(specimen.initialise(_heap, 512));
+
+    while (specimen.allocate() != nullptr)
+    {
+        ++count;
+    }
+
+    EXPECT_GT(count, 0u);
+    EXPECT_EQ(count, specimen.getSlabCount() * specimen.getObjectsPerSlab());
+    EXPECT_EQ(specimen.getSlabCount(), (PoolSize / SlabAllocator::SlabSize) - 1);
+}
+
+TEST_F(SlabPoolTest, CreateAndDestroyObjects)
+{
+    SlabPool<TrackedItem> specimen;
+
+    EXPECT_EQ(specimen.create(1u, uint16_t(2)), nullptr);
+    ASSERT_TRUE(specimen.initialise(_heap));
+
+    TrackedItem::LiveCount = 0;
+    TrackedItem *first = specimen.create(42u, uint16_t(7));
+    TrackedItem *second = specimen.create(43u, uint16_t(8));
+
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(first->Value, 42u);
+    EXPECT_EQ(first->Tag, 7u);
+    EXPECT_EQ(second->Value, 43u);
+    EXPECT_EQ(TrackedItem::LiveCount, 2);
+    EXPECT_EQ(specimen.getUsedCount(), 2u);
+
+    specimen.destroy(first);
+    specimen.destroy(nullptr);
+    EXPECT_EQ(TrackedItem::LiveCount, 1);
+    EXPECT_EQ(specimen.getUsedCount(), 1u);
+
+    specimen.destroy(second);
+    EXPECT_EQ(TrackedItem::LiveCount, 0);
+}
+
+TEST_F(SlabPoolTest, ObjectsAreAligned)
+{
+    SlabPool<AlignedItem> specimen;
+
+    ASSERT_TRUE(specimen.initialise(_heap));
+
+    for (size_t i = 0; i < 300; ++i)
+    {
+        AlignedItem *item = specimen.create();
+
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(item) % alignof(AlignedItem), 0u);
+    }
+
+    EXPECT_EQ(specimen.getObjectsPerSlab(), (SlabAllocator::SlabSize - 32) / 64);
+    specimen.clear();
+    EXPECT_EQ(specimen.getSlabCount(), 0u);
+}
+
+TEST(SizeClassAllocator, GetClassSize)
+{
+    EXPECT_EQ(SizeClassAllocator::getClassSize(0), 16u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(1), 16u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(16), 16u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(17), 32u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(65), 96u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(129), 192u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(257), 384u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(512), 512u);
+    EXPECT_EQ(SizeClassAllocator::getClassSize(513), 513u);
+
+    for (size_t size = 0; size <= SizeClassAllocator::MaxClassSize; ++size)
+    {
+        EXPECT_GE(SizeClassAllocator::getClassSize(size), size);
+    }
+}
+
+TEST_F(SlabPoolTest, SizeClassesRouteAllocations)
+{
+    SizeClassAllocator specimen;
+
+    EXPECT_EQ(specimen.allocate(8), nullptr);
+    ASSERT_TRUE(specimen.initialise(_heap));
+    EXPECT_FALSE(specimen.initialise(_heap));
+
+    size_t initialFree = _heap.getPoolFreeSize();
+    std::set<uintptr_t> addresses;
+    std::vector<std::pair<void *, size_t>> blocks;
+
+    for (size_t size = 1; size <= 600; size += 37)
+    {
+        void *block = specimen.allocate(size);
+
+        ASSERT_NE(block, nullptr);
+
+        if (size <= SizeClassAllocator::MaxClassSize)
+        {
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % 16, 0u);
+        }
+
+        EXPECT_TRUE(addresses.insert(reinterpret_cast<uintptr_t>(block)).second);
+        blocks.emplace_back(block, size);
+    }
+
+    for (const auto &block : blocks)
+    {
+        specimen.free(block.first, block.second);
+    }
+
+    // Blocks should be reused from the same class.
+    void *reused = specimen.allocate(blocks.front().second);
+    EXPECT_EQ(reused, blocks.front().first);
+    specimen.free(reused, blocks.front().second);
+
+    specimen.clear();
+    EXPECT_EQ(_heap.getPoolFreeSize(), initialFree);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
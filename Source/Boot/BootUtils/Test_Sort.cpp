@@ -12,6 +12,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "CollectionTools.hpp"
 #include "Loader.hpp"
 
@@ -62,10 +65,97 @@ public:
     }
 };
 
+struct MemMapEntryComparer
+{
+    int operator()(const MemMapEntry &lhs, const MemMapEntry &rhs) const
+    {
+        int diff = 0;
+
+        if (lhs.BaseAddress == rhs.BaseAddress)
+        {
+            if (lhs.Size != rhs.Size)
+            {
+                diff = (lhs.Size < rhs.Size) ? -1 : 1;
+            }
+        }
+        else
+        {
+            diff = (lhs.BaseAddress < rhs.BaseAddress) ? -1 : 1;
+        }
+
+        return diff;
+    }
+};
+
+//! @brief An item with a key to sort on and a tag to verify stability.
+struct KeyedItem
+{
+    uint32_t Key;
+    uint32_t Tag;
+};
+
+//! @brief Compares KeyedItem objects by key only, counting the comparisons.
+struct CountingKeyComparer
+{
+    size_t *Count;
+
+    int operator()(const KeyedItem &lhs, const KeyedItem &rhs) const
+    {
+        ++*Count;
+
+        return (lhs.Key < rhs.Key) ? -1 : ((rhs.Key < lhs.Key) ? 1 : 0);
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data
 ////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Sorts items and verifies the result matches std::stable_sort().
+::testing::AssertionResult expectStableSort(std::vector<KeyedItem> items,
+                                            size_t &comparisons)
+{
+    std::vector<KeyedItem> expected = items;
+
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const KeyedItem &lhs, const KeyedItem &rhs)
+                     { return lhs.Key < rhs.Key; });
+
+    comparisons = 0;
+    Collection::sort(items.data(), items.size(),
+                     CountingKeyComparer { &comparisons });
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if ((items[i].Key != expected[i].Key) ||
+            (items[i].Tag != expected[i].Tag))
+        {
+            return ::testing::AssertionFailure() <<
+                "Item " << i << " was { " << items[i].Key << ", " <<
+                items[i].Tag << " }, expected { " << expected[i].Key <<
+                ", " << expected[i].Tag << " }.";
+        }
+    }
+
+    return ::testing::AssertionSuccess();
+}
+
+//! @brief Calculates a comparison budget proportional to n log n.
+size_t getComparisonBudget(size_t count)
+{
+    size_t log2Count = 1;
+
+    while ((size_t(1) << log2Count) < count)
+    {
+        ++log2Count;
+    }
+
+    return 2 * count * log2Count;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Unit Tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -213,6 +303,334 @@ GTEST_TEST(Sort, MemoryRegions)
     EXPECT_EQ(i, std::size(entries));
 }
 
+GTEST_TEST(Sort, SortDuplicates)
+{
+    ByteItemTraits traits;
+    ByteComparer comp;
+
+    uint8_t sample[] = { 30, 10, 20, 10, 30, 20, 10 };
+
+    // Try sorting the items.
+    Collection::sort(&traits, &comp, sample, std::size(sample));
+
+    static_assert(std::size(sample) == 7, "Array results out of sync.");
+
+    EXPECT_EQ(sample[0], 10);
+    EXPECT_EQ(sample[1], 10);
+    EXPECT_EQ(sample[2], 10);
+    EXPECT_EQ(sample[3], 20);
+    EXPECT_EQ(sample[4], 20);
+    EXPECT_EQ(sample[5], 30);
+    EXPECT_EQ(sample[6], 30);
+}
+
+GTEST_TEST(Sort, TypedSortOddNumber)
+{
+    uint8_t sample[] = { 10, 20, 30, 40, 15, 25, 35 };
+
+    // Try sorting the items using the default comparer.
+    Collection::sort(sample, std::size(sample));
+
+    static_assert(std::size(sample) == 7, "Array results out of sync.");
+
+    EXPECT_EQ(sample[0], 10);
+    EXPECT_EQ(sample[1], 15);
+    EXPECT_EQ(sample[2], 20);
+    EXPECT_EQ(sample[3], 25);
+    EXPECT_EQ(sample[4], 30);
+    EXPECT_EQ(sample[5], 35);
+    EXPECT_EQ(sample[6], 40);
+}
+
+GTEST_TEST(Sort, TypedSortMatchesErasedSort)
+{
+    uint32_t typedSample[64];
+    uint32_t erasedSample[64];
+    uint32_t seed = 0x1234567;
+
+    for (size_t i = 0; i < std::size(typedSample); ++i)
+    {
+        // Generate a pseudo-random sequence with plenty of duplicates.
+        seed = (seed * 1103515245u) + 12345u;
+        typedSample[i] = (seed >> 16) % 23;
+        erasedSample[i] = typedSample[i];
+    }
+
+    Collection::ItemTraits<uint32_t> traits;
+    Collection::LessThanComparer<uint32_t> comp;
+
+    Collection::sort(&traits, &comp, erasedSample, std::size(erasedSample));
+    Collection::sort(typedSample, std::size(typedSample),
+                     Collection::LessThan<uint32_t>());
+
+    for (size_t i = 0; i < std::size(typedSample); ++i)
+    {
+        EXPECT_EQ(typedSample[i], erasedSample[i]);
+
+        if (i > 0)
+        {
+            EXPECT_LE(typedSample[i - 1], typedSample[i]);
+        }
+    }
+}
+
+GTEST_TEST(Sort, TypedMemoryRegions)
+{
+    MemMapEntry entries[] = {
+        { 0xFFFC0000, 0x40000, MemType::Reserved, 0 },
+        { 0x100000, 0x3EF000, MemType::UsableRAM, 0 },
+        { 0x0, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x100000, 0x3000, MemType::UsableAfterBoot, 0 },
+        { 0, 0x10000, MemType::UsableAfterBoot, 0 },
+    };
+
+    Collection::sort(entries, std::size(entries), MemMapEntryComparer());
+
+    static_assert(std::size(entries) == 5, "MemMapEntry array out of sync!");
+
+    EXPECT_EQ(entries[0].BaseAddress, 0);
+    EXPECT_EQ(entries[0].Size, 0x10000);
+    EXPECT_EQ(entries[1].BaseAddress, 0);
+    EXPECT_EQ(entries[1].Size, 0x9F000);
+    EXPECT_EQ(entries[2].BaseAddress, 0x100000);
+    EXPECT_EQ(entries[2].Size, 0x3000);
+    EXPECT_EQ(entries[3].BaseAddress, 0x100000);
+    EXPECT_EQ(entries[3].Size, 0x3EF000);
+    EXPECT_EQ(entries[4].BaseAddress, 0xFFFC0000);
+    EXPECT_EQ(entries[4].Size, 0x40000);
+}
+
+GTEST_TEST(Sort, StableWithDuplicateKeys)
+{
+    std::vector<KeyedItem> items;
+    uint32_t seed = 0xC0FFEE;
+
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        items.push_back({ (seed >> 16) % 37, i });
+    }
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+    EXPECT_LE(comparisons, getComparisonBudget(items.size()));
+}
+
+GTEST_TEST(Sort, InterleavedIsNotQuadratic)
+{
+    std::vector<KeyedItem> items;
+    const uint32_t count = 4096;
+
+    // Create two interleaved descending sequences.
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t key = (i & 1) ? (count - i) : (count * 2) - i;
+        items.push_back({ key, i });
+    }
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+    EXPECT_LE(comparisons, getComparisonBudget(items.size()));
+}
+
+GTEST_TEST(Sort, PresortedIsLinear)
+{
+    std::vector<KeyedItem> items;
+    const uint32_t count = 4096;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // Include runs of equal keys which must not be treated as descending.
+        items.push_back({ i / 4, i });
+    }
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+    EXPECT_EQ(comparisons, items.size() - 1);
+}
+
+GTEST_TEST(Sort, StrictlyReversedIsLinear)
+{
+    std::vector<KeyedItem> items;
+    const uint32_t count = 4096;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        items.push_back({ count - i, i });
+    }
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+    EXPECT_EQ(comparisons, items.size() - 1);
+}
+
+GTEST_TEST(Sort, ReversedWithDuplicateKeys)
+{
+    std::vector<KeyedItem> items;
+    const uint32_t count = 1000;
+
+    // Descending but not strictly so, equal items must keep their order.
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        items.push_back({ (count - i) / 3, i });
+    }
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+    EXPECT_LE(comparisons, getComparisonBudget(items.size()));
+}
+
+GTEST_TEST(Sort, SawtoothMergesAtRunBoundaries)
+{
+    std::vector<KeyedItem> items;
+    const uint32_t toothCount = 8;
+    const uint32_t toothSize = 512;
+
+    for (uint32_t tooth = 0; tooth < toothCount; ++tooth)
+    {
+        for (uint32_t i = 0; i < toothSize; ++i)
+        {
+            items.push_back({ (i * 2) + tooth, (tooth * toothSize) + i });
+        }
+    }
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+
+    // Finding the runs costs n - 1 comparisons, merging 8 interleaved runs
+    // should only be proportional to n log2(8), not n log2(n).
+    EXPECT_LE(comparisons, items.size() * 7);
+}
+
+GTEST_TEST(Sort, DescendingSawtooth)
+{
+    std::vector<KeyedItem> items;
+    const uint32_t toothCount = 5;
+    const uint32_t toothSize = 300;
+
+    for (uint32_t tooth = 0; tooth < toothCount; ++tooth)
+    {
+        for (uint32_t i = 0; i < toothSize; ++i)
+        {
+            items.push_back({ (toothSize - i) * 3 + tooth, (tooth * toothSize) + i });
+        }
+    }
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+    EXPECT_LE(comparisons, items.size() * 7);
+}
+
+GTEST_TEST(Sort, NearlySortedMemoryMap)
+{
+    // A sorted firmware map with loader reservations appended.
+    std::vector<KeyedItem> items;
+
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        items.push_back({ i * 16, i });
+    }
+
+    items.push_back({ 0, 200 });
+    items.push_back({ 1000, 201 });
+    items.push_back({ 24, 202 });
+
+    size_t comparisons = 0;
+
+    EXPECT_TRUE(expectStableSort(items, comparisons));
+    EXPECT_LE(comparisons, items.size() * 2);
+}
+
+GTEST_TEST(Sort, RadixSortIntegers)
+{
+    std::vector<uint32_t> items;
+    std::vector<uint32_t> scratch;
+    uint32_t seed = 0xBADF00D;
+
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        items.push_back(seed);
+    }
+
+    std::vector<uint32_t> expected = items;
+    std::sort(expected.begin(), expected.end());
+    scratch.resize(items.size());
+
+    Collection::radixSort(items.data(), items.size(), scratch.data(),
+                          [](uint32_t item) { return item; });
+
+    EXPECT_EQ(items, expected);
+}
+
+GTEST_TEST(Sort, RadixSortIsStable)
+{
+    std::vector<KeyedItem> items;
+    std::vector<KeyedItem> scratch;
+    uint32_t seed = 0xFACADE;
+
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        items.push_back({ ((seed >> 16) % 37) << 20, i });
+    }
+
+    std::vector<KeyedItem> expected = items;
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const KeyedItem &lhs, const KeyedItem &rhs)
+                     { return lhs.Key < rhs.Key; });
+    scratch.resize(items.size());
+
+    Collection::radixSort(items.data(), items.size(), scratch.data(),
+                          [](const KeyedItem &item) { return item.Key; });
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        EXPECT_EQ(items[i].Key, expected[i].Key);
+        EXPECT_EQ(items[i].Tag, expected[i].Tag);
+    }
+}
+
+GTEST_TEST(Sort, RadixSortMemoryRegions)
+{
+    MemMapEntry entries[] = {
+        { 0xFFFC0000, 0x40000, MemType::Reserved, 0 },
+        { 0x100000, 0x3EF000, MemType::UsableRAM, 0 },
+        { 0x0, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x100000, 0x3000, MemType::UsableAfterBoot, 0 },
+        { 0x100000000, 0x3000, MemType::UsableRAM, 0 },
+        { 0, 0x10000, MemType::UsableAfterBoot, 0 },
+    };
+
+    MemMapEntry scratch[std::size(entries)];
+
+    // Sort on size, largest first, then on base address.
+    Collection::radixSort(entries, std::size(entries), scratch,
+                          [](const MemMapEntry &entry) { return ~entry.Size; });
+    Collection::radixSort(entries, std::size(entries), scratch,
+                          [](const MemMapEntry &entry) { return entry.BaseAddress; });
+
+    static_assert(std::size(entries) == 6, "MemMapEntry array out of sync!");
+
+    EXPECT_EQ(entries[0].BaseAddress, 0);
+    EXPECT_EQ(entries[0].Size, 0x9F000);
+    EXPECT_EQ(entries[1].BaseAddress, 0);
+    EXPECT_EQ(entries[1].Size, 0x10000);
+    EXPECT_EQ(entries[2].BaseAddress, 0x100000);
+    EXPECT_EQ(entries[2].Size, 0x3EF000);
+    EXPECT_EQ(entries[3].BaseAddress, 0x100000);
+    EXPECT_EQ(entries[3].Size, 0x3000);
+    EXPECT_EQ(entries[4].BaseAddress, 0xFFFC0000);
+    EXPECT_EQ(entries[5].BaseAddress, 0x100000000);
+}
+
 } // Anonymous namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -15,6 +15,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <iterator>
 
 #include "Test_TargetTools.hpp"
 
@@ -230,6 +231,93 @@ void TargetMemoryMap::fill(size_t startOffset, size_t byteCount, uint8_t pattern
         " was outside the simulated memory map.";
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// BootDeviceTest Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+std::vector<DeviceRead> BootDeviceTest::Reads;
+uint64_t BootDeviceTest::SectorLimit = 0;
+bool BootDeviceTest::RejectsPartialReads = false;
+uint8_t BootDeviceTest::DeviceSectorSizePow2 = 9;
+std::vector<uint8_t> BootDeviceTest::Image;
+
+BootDeviceTest::BootDeviceTest() :
+    _targetMemory(RamSizeInMb)
+{
+}
+
+//! @brief Resets the simulated device to 0x10000 sectors of 512 bytes and
+//! creates a 1 MB heap.
+void BootDeviceTest::SetUp()
+{
+    Reads.clear();
+    SectorLimit = 0x10000;
+    RejectsPartialReads = false;
+    DeviceSectorSizePow2 = 9;
+    Image.clear();
+
+    ASSERT_TRUE(_memoryMap.initialise(_entries, 3, std::size(_entries)));
+    ASSERT_TRUE(_heap.initialise(_memoryMap, 0x100000));
+}
+
+//! @brief Simulates reading from the boot device, recording the call.
+uint32_t BootDeviceTest::readSectors(void *destination, uint64_t startSector,
+                                     uint32_t sectorCount)
+{
+    Reads.push_back({ startSector, sectorCount });
+
+    const size_t sectorSize = static_cast<size_t>(1) << DeviceSectorSizePow2;
+    const uint64_t sectorLimit = Image.empty() ? SectorLimit :
+                                                 (Image.size() >> DeviceSectorSizePow2);
+    uint8_t *target = static_cast<uint8_t *>(destination);
+    uint32_t count = 0;
+
+    if (RejectsPartialReads && ((startSector + sectorCount) > sectorLimit))
+        return 0;
+
+    for (; (count < sectorCount) && ((startSector + count) < sectorLimit); ++count)
+    {
+        uint8_t *sector = target + (count * sectorSize);
+
+        if (Image.empty())
+        {
+            uint64_t *words = reinterpret_cast<uint64_t *>(sector);
+
+            std::fill_n(words, sectorSize / sizeof(uint64_t), startSector + count);
+        }
+        else
+        {
+            std::copy_n(Image.data() + ((startSector + count) * sectorSize),
+                        sectorSize, sector);
+        }
+    }
+
+    return count;
+}
+
+//! @brief Verifies the contents of sectors read into a buffer from a device
+//! with no image set.
+::testing::AssertionResult BootDeviceTest::expectSectors(const std::vector<uint64_t> &buffer,
+                                                         uint64_t startSector,
+                                                         uint32_t sectorCount)
+{
+    const size_t wordsPerSector = (static_cast<size_t>(1) << DeviceSectorSizePow2) /
+                                  sizeof(uint64_t);
+
+    for (uint32_t sector = 0; sector < sectorCount; ++sector)
+    {
+        for (size_t i = 0; i < wordsPerSector; ++i)
+        {
+            if (buffer[(sector * wordsPerSector) + i] != (startSector + sector))
+            {
+                return ::testing::AssertionFailure() << "Sector " << (startSector + sector)
+                                                     << " has the wrong contents.";
+            }
+        }
+    }
+
+    return ::testing::AssertionSuccess();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Global Function Definitions
 ////////////////////////////////////////////////////////////////////////////////
@@ -16,8 +16,14 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <cstdint>
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "Heap.hpp"
+#include "Loader.hpp"
+#include "MemoryMap.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
 // Macro Definitions
 ////////////////////////////////////////////////////////////////////////////////
@@ -25,6 +31,17 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Data Type Declarations
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief A call made to the simulated boot device.
+struct DeviceRead
+{
+    uint64_t StartSector;
+    uint32_t SectorCount;
+
+    bool operator==(const DeviceRead &rhs) const
+    {
+        return (StartSector == rhs.StartSector) && (SectorCount == rhs.SectorCount);
+    }
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class Declarations
@@ -60,6 +77,63 @@ private:
     void *_memoryMap;
 };
 
+//! @brief A test fixture which provides a boot-time heap in simulated target
+//! memory and a simulated boot device to read from.
+//! @details
+//! The device is described by static members as ReadBootSectorsFn has no
+//! context parameter. Unless an image is set, every word of a sector holds
+//! the index of the sector.
+class BootDeviceTest : public testing::Test
+{
+private:
+    // Internal Constants
+    static constexpr size_t RamSizeInMb = 16;
+
+    // Internal Fields
+    TargetMemoryMap _targetMemory;
+
+protected:
+    // Internal Fields
+    MemMapEntry _entries[8] = {
+        { 0x00, 0x9F000, MemType::UsableRAM, 0 },
+        { 0x9F000, 0x1000, MemType::Reserved, 0 },
+        { 0x100000, 0xF00000, MemType::UsableRAM, 0 },
+    };
+
+    MemoryMap _memoryMap;
+    Heap _heap;
+
+public:
+    // Public Fields
+    //! @brief The calls made to the simulated device.
+    static std::vector<DeviceRead> Reads;
+
+    //! @brief The count of sectors on the simulated device if no image is set.
+    static uint64_t SectorLimit;
+
+    //! @brief True if the simulated device reads nothing when a request
+    //! crosses its last sector, rather than reading as far as it can.
+    static bool RejectsPartialReads;
+
+    //! @brief The size of the sectors of the simulated device as a power of 2.
+    static uint8_t DeviceSectorSizePow2;
+
+    //! @brief The contents of the simulated device, if not empty.
+    static std::vector<uint8_t> Image;
+
+    // Construction/Destruction
+    BootDeviceTest();
+
+    // Operations
+    void SetUp() override;
+
+    static uint32_t readSectors(void *destination, uint64_t startSector,
+                                uint32_t sectorCount);
+    static ::testing::AssertionResult expectSectors(const std::vector<uint64_t> &buffer,
+                                                    uint64_t startSector,
+                                                    uint32_t sectorCount);
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Function Declarations
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,291 @@
+//! @file BootUtils/Test_Tlsf.cpp
+//! @brief The definition of unit tests for the Tlsf class.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "Tlsf.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+class TlsfTest : public testing::Test
+{
+protected:
+    static constexpr size_t PoolSize = 0x40000;
+    std::vector<uint64_t> _memory;
+    Tlsf *_specimen;
+
+public:
+    TlsfTest() :
+        _memory(PoolSize / sizeof(uint64_t), 0xDFDFDFDFDFDFDFDF),
+        _specimen(nullptr)
+    {
+    }
+
+    void SetUp()
+    {
+        _specimen = Tlsf::create(_memory.data(), PoolSize);
+        ASSERT_NE(_specimen, nullptr);
+        ASSERT_TRUE(_specimen->isConsistent());
+    }
+
+    //! @brief Determines whether a block lies entirely within the pool.
+    bool isInPool(const void *block, size_t size) const
+    {
+        const uint8_t *start = reinterpret_cast<const uint8_t *>(_memory.data());
+        const uint8_t *blockStart = static_cast<const uint8_t *>(block);
+
+        return (blockStart >= start) && ((blockStart + size) <= (start + PoolSize));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Unit Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST(Tlsf, CreateFailsWithTooLittleMemory)
+{
+    uint64_t memory[16];
+
+    EXPECT_EQ(Tlsf::create(nullptr, 0x1000), nullptr);
+    EXPECT_EQ(Tlsf::create(memory, sizeof(memory)), nullptr);
+}
+
+TEST_F(TlsfTest, AllocateAligned)
+{
+    size_t initialFree = _specimen->getFreeSize();
+
+    EXPECT_GT(initialFree, PoolSize - 0x1000);
+    EXPECT_EQ(_specimen->allocate(0), nullptr);
+
+    for (size_t size = 1; size < 300; size += 7)
+    {
+        void *block = _specimen->allocate(size);
+
+        ASSERT_NE(block, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % Tlsf::Alignment, 0u);
+        EXPECT_GE(Tlsf::getBlockSize(block), size);
+        EXPECT_TRUE(isInPool(block, size));
+    }
+
+    EXPECT_LT(_specimen->getFreeSize(), initialFree);
+    EXPECT_TRUE(_specimen->isConsistent());
+}
+
+TEST_F(TlsfTest, FreeMergesNeighbours)
+{
+    size_t initialFree = _specimen->getFreeSize();
+    void *first = _specimen->allocate(100);
+    void *second = _specimen->allocate(2000);
+    void *third = _specimen->allocate(40);
+
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    ASSERT_NE(third, nullptr);
+
+    // Free in an order which exercises merging with both neighbours.
+    _specimen->free(first);
+    EXPECT_TRUE(_specimen->isConsistent());
+    _specimen->free(third);
+    EXPECT_TRUE(_specimen->isConsistent());
+    _specimen->free(second);
+    EXPECT_TRUE(_specimen->isConsistent());
+
+    EXPECT_EQ(_specimen->getFreeSize(), initialFree);
+
+    // Nearly the whole pool should be available as a single block again,
+    // requests are rounded up to the next size class boundary.
+    void *all = _specimen->allocate(initialFree - 0x8000);
+    EXPECT_NE(all, nullptr);
+}
+
+TEST_F(TlsfTest, IgnoreDoubleFree)
+{
+    void *block = _specimen->allocate(64);
+    void *other = _specimen->allocate(64);
+
+    ASSERT_NE(block, nullptr);
+    ASSERT_NE(other, nullptr);
+
+    _specimen->free(block);
+    size_t freeSize = _specimen->getFreeSize();
+
+    _specimen->free(block);
+    _specimen->free(nullptr);
+
+    EXPECT_EQ(_specimen->getFreeSize(), freeSize);
+    EXPECT_TRUE(_specimen->isConsistent());
+}
+
+TEST_F(TlsfTest, FailWhenExhausted)
+{
+    std::vector<void *> blocks;
+
+    for (void *block = _specimen->allocate(0x1000); block != nullptr;
+         block = _specimen->allocate(0x1000))
+    {
+        blocks.push_back(block);
+    }
+
+    EXPECT_GT(blocks.size(), 0x30u);
+    EXPECT_EQ(_specimen->allocate(PoolSize), nullptr);
+    EXPECT_TRUE(_specimen->isConsistent());
+
+    for (void *block : blocks)
+    {
+        _specimen->free(block);
+    }
+
+    EXPECT_TRUE(_specimen->isConsistent());
+    EXPECT_NE(_specimen->allocate(0x1000), nullptr);
+}
+
+TEST_F(TlsfTest, ReallocateInPlace)
+{
+    uint8_t *block = static_cast<uint8_t *>(_specimen->allocate(100));
+
+    ASSERT_NE(block, nullptr);
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        block[i] = static_cast<uint8_t>(i);
+    }
+
+    // The block is followed by free space, so can grow without moving.
+    EXPECT_EQ(_specimen->reallocate(block, 1000), block);
+    EXPECT_GE(Tlsf::getBlockSize(block), 1000u);
+    EXPECT_TRUE(_specimen->isConsistent());
+
+    // Shrinking never moves the block.
+    EXPECT_EQ(_specimen->reallocate(block, 50), block);
+    EXPECT_LT(Tlsf::getBlockSize(block), 100u);
+    EXPECT_TRUE(_specimen->isConsistent());
+
+    for (size_t i = 0; i < 50; ++i)
+    {
+        EXPECT_EQ(block[i], static_cast<uint8_t>(i));
+    }
+}
+
+TEST_F(TlsfTest, ReallocateMovesBlock)
+{
+    uint8_t *block = static_cast<uint8_t *>(_specimen->allocate(101));
+    void *barrier = _specimen->allocate(16);
+
+    ASSERT_NE(block, nullptr);
+    ASSERT_NE(barrier, nullptr);
+
+    for (size_t i = 0; i < 101; ++i)
+    {
+        block[i] = static_cast<uint8_t>(i * 3);
+    }
+
+    uint8_t *moved = static_cast<uint8_t *>(_specimen->reallocate(block, 5000));
+
+    ASSERT_NE(moved, nullptr);
+    EXPECT_NE(moved, block);
+    EXPECT_TRUE(_specimen->isConsistent());
+
+    for (size_t i = 0; i < 101; ++i)
+    {
+        EXPECT_EQ(moved[i], static_cast<uint8_t>(i * 3));
+    }
+
+    // A request which can't be satisfied leaves the block intact.
+    EXPECT_EQ(_specimen->reallocate(moved, PoolSize), nullptr);
+    EXPECT_EQ(moved[100], static_cast<uint8_t>(300));
+
+    EXPECT_EQ(_specimen->reallocate(moved, 0), nullptr);
+    EXPECT_TRUE(_specimen->isConsistent());
+}
+
+TEST_F(TlsfTest, RandomWorkloadStaysConsistent)
+{
+    std::mt19937 random(0x7151F);
+    std::vector<uint8_t *> blocks(256, nullptr);
+    std::vector<size_t> sizes(blocks.size(), 0);
+    size_t initialFree = _specimen->getFreeSize();
+
+    for (size_t step = 0; step < 20000; ++step)
+    {
+        size_t slot = random() % blocks.size();
+
+        if (blocks[slot] == nullptr)
+        {
+            sizes[slot] = 1 + (random() % 2000);
+            blocks[slot] = static_cast<uint8_t *>(_specimen->allocate(sizes[slot]));
+
+            if (blocks[slot] != nullptr)
+            {
+                blocks[slot][0] = static_cast<uint8_t>(slot);
+                blocks[slot][sizes[slot] - 1] = static_cast<uint8_t>(slot);
+            }
+        }
+        else
+        {
+            ASSERT_EQ(blocks[slot][0], static_cast<uint8_t>(slot));
+            ASSERT_EQ(blocks[slot][sizes[slot] - 1], static_cast<uint8_t>(slot));
+
+            if ((random() % 4) == 0)
+            {
+                size_t newSize = 1 + (random() % 4000);
+                uint8_t *resized = static_cast<uint8_t *>(_specimen->reallocate(blocks[slot],
+                                                                                newSize));
+
+                if (resized != nullptr)
+                {
+                    ASSERT_EQ(resized[0], static_cast<uint8_t>(slot));
+                    blocks[slot] = resized;
+                    sizes[slot] = newSize;
+                    resized[newSize - 1] = static_cast<uint8_t>(slot);
+                }
+            }
+            else
+            {
+                _specimen->free(blocks[slot]);
+                blocks[slot] = nullptr;
+            }
+        }
+
+        if ((step % 1000) == 0)
+        {
+            ASSERT_TRUE(_specimen->isConsistent());
+        }
+    }
+
+    for (uint8_t *block : blocks)
+    {
+        _specimen->free(block);
+    }
+
+    EXPECT_TRUE(_specimen->isConsistent());
+    EXPECT_EQ(_specimen->getFreeSize(), initialFree);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,618 @@
+//! @file BootUtils/Tlsf.cpp
+//! @brief The definition of a two-level segregated fit memory allocator.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Header File Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "BitTools.hpp"
+#include "MemoryTools.hpp"
+#include "Tlsf.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+////////////////////////////////////////////////////////////////////////////////
+// Local Data Types
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Data
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Local Functions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Rounds a value up to a power of 2 boundary.
+constexpr size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+//! @brief Rounds a value down to a power of 2 boundary.
+constexpr size_t alignDown(size_t value, size_t alignment)
+{
+    return value & ~(alignment - 1);
+}
+
+} // Anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Tlsf Member Definitions
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Creates an allocator in a block of memory.
+//! @param[in] memory The memory to manage. The allocator's own control data
+//! is placed at the start of it.
+//! @param[in] size The count of bytes in \p memory.
+//! @return A pointer to the new allocator or nullptr if the memory was too
+//! small or too large to manage.
+Tlsf *Tlsf::create(void *memory, size_t size)
+{
+    if (memory == nullptr)
+        return nullptr;
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(memory);
+    uintptr_t end = start + size;
+    uintptr_t controlStart = alignUp(start, alignof(Tlsf));
+    uintptr_t poolStart = alignUp(controlStart + sizeof(Tlsf), Alignment);
+
+    if ((end < start) || (poolStart >= end))
+        return nullptr;
+
+    // The pool needs room for one free block and the sentinel at its end.
+    size_t available = static_cast<size_t>(end - poolStart);
+
+    if (available < (MinBlockSize + (HeaderOverhead * 2)))
+        return nullptr;
+
+    size_t poolSize = alignDown(available - (HeaderOverhead * 2), Alignment);
+
+    if (poolSize >= MaxBlockSize)
+        return nullptr;
+
+    Tlsf *allocator = reinterpret_cast<Tlsf *>(controlStart);
+    allocator->initialise(reinterpret_cast<void *>(poolStart), poolSize);
+
+    return allocator;
+}
+
+//! @brief Gets the total count of bytes in free blocks.
+size_t Tlsf::getFreeSize() const { return _freeSize; }
+
+//! @brief Gets the size of the largest free block.
+//! @note Only the free list holding the largest blocks is searched.
+size_t Tlsf::getLargestFreeSize() const
+{
+    if (_firstLevelMap == 0)
+        return 0;
+
+    uint32_t firstLevel = Bits::getHighestSetBit(_firstLevelMap);
+    uint32_t secondLevel = Bits::getHighestSetBit(_secondLevelMaps[firstLevel]);
+    size_t largest = 0;
+
+    for (const BlockHeader *block = _freeLists[firstLevel][secondLevel];
+         block != &_nullBlock; block = block->NextFree)
+    {
+        if (getSize(block) > largest)
+        {
+            largest = getSize(block);
+        }
+    }
+
+    return largest;
+}
+
+//! @brief Gets the usable size of an allocated block, which may be larger
+//! than the size requested.
+//! @param[in] block A block returned by allocate() or reallocate().
+size_t Tlsf::getBlockSize(const void *block)
+{
+    return (block == nullptr) ? 0 : getSize(fromPointer(block));
+}
+
+//! @brief Verifies the internal structure of the pool, for diagnostic
+//! purposes.
+//! @retval true The pool and free lists are consistent.
+//! @retval false Corruption was detected.
+bool Tlsf::isConsistent() const
+{
+    size_t freeSize = 0;
+    bool isPrevFree = false;
+    const BlockHeader *block = _firstBlock;
+
+    // Walk the pool checking that blocks link and that no two free blocks
+    // are adjacent.
+    while (getSize(block) != 0)
+    {
+        bool isFree = (block->Size & IsFreeBit) != 0;
+
+        if ((((block->Size & IsPrevFreeBit) != 0) != isPrevFree) ||
+            (isFree && isPrevFree))
+        {
+            return false;
+        }
+
+        BlockHeader *next = getNextPhysical(block);
+
+        if (isFree)
+        {
+            freeSize += getSize(block);
+
+            if (next->PrevPhysical != block)
+                return false;
+        }
+
+        isPrevFree = isFree;
+        block = next;
+    }
+
+    if (((block->Size & IsPrevFreeBit) != 0) != isPrevFree)
+        return false;
+
+    // Check that each free list holds blocks of the right size, and agrees
+    // with the bitmaps.
+    size_t listedSize = 0;
+
+    for (uint32_t firstLevel = 0; firstLevel < FirstLevelCount; ++firstLevel)
+    {
+        for (uint32_t secondLevel = 0; secondLevel < SecondLevelCount; ++secondLevel)
+        {
+            const BlockHeader *item = _freeLists[firstLevel][secondLevel];
+            bool hasBit = (_secondLevelMaps[firstLevel] & (1u << secondLevel)) != 0;
+
+            if (hasBit != (item != &_nullBlock))
+                return false;
+
+            while (item != &_nullBlock)
+            {
+                uint32_t itemFirst, itemSecond;
+                mapSize(getSize(item), itemFirst, itemSecond);
+
+                if ((itemFirst != firstLevel) || (itemSecond != secondLevel) ||
+                    ((item->Size & IsFreeBit) == 0))
+                {
+                    return false;
+                }
+
+                listedSize += getSize(item);
+                item = item->NextFree;
+            }
+        }
+
+        if (((_firstLevelMap & (1u << firstLevel)) != 0) !=
+            (_secondLevelMaps[firstLevel] != 0))
+        {
+            return false;
+        }
+    }
+
+    return (freeSize == _freeSize) && (listedSize == _freeSize);
+}
+
+//! @brief Allocates a block of memory.
+//! @param[in] size The count of bytes required.
+//! @return A pointer to a block aligned to Alignment or nullptr if no block
+//! large enough was available.
+void *Tlsf::allocate(size_t size)
+{
+    size_t adjustedSize = adjustRequestSize(size);
+    BlockHeader *block = locateFree(adjustedSize);
+
+    if (block == nullptr)
+        return nullptr;
+
+    trimFree(block, adjustedSize);
+    markAsUsed(block);
+
+    return toPointer(block);
+}
+
+//! @brief Returns a block to the allocator, merging it with any free
+//! neighbours.
+//! @param[in] block A block returned by allocate() or reallocate(), or
+//! nullptr. Blocks which are already free are ignored.
+void Tlsf::free(void *block)
+{
+    if (block == nullptr)
+        return;
+
+    BlockHeader *header = fromPointer(block);
+
+    if ((header->Size & IsFreeBit) != 0)
+        return;
+
+    markAsFree(header);
+    header = mergePrevious(header);
+    header = mergeNext(header);
+    insertBlock(header);
+}
+
+//! @brief Changes the size of a block, in place if possible.
+//! @param[in] block The block to resize or nullptr to allocate a new block.
+//! @param[in] size The new count of bytes required, or 0 to free the block.
+//! @return A pointer to the resized block, which may have moved, or nullptr
+//! if it couldn't be resized, in which case the original is left intact.
+void *Tlsf::reallocate(void *block, size_t size)
+{
+    if (block == nullptr)
+        return allocate(size);
+
+    if (size == 0)
+    {
+        free(block);
+        return nullptr;
+    }
+
+    BlockHeader *header = fromPointer(block);
+    BlockHeader *next = getNextPhysical(header);
+    size_t currentSize = getSize(header);
+    size_t combinedSize = currentSize + getSize(next) + HeaderOverhead;
+    size_t adjustedSize = adjustRequestSize(size);
+
+    if (adjustedSize == 0)
+        return nullptr;
+
+    if ((adjustedSize > currentSize) &&
+        (((next->Size & IsFreeBit) == 0) || (adjustedSize > combinedSize)))
+    {
+        // The block can't grow in place, so move it.
+        void *newBlock = allocate(size);
+
+        if (newBlock != nullptr)
+        {
+            Memory::copy(newBlock, block, (currentSize < size) ? currentSize : size);
+            free(block);
+        }
+
+        return newBlock;
+    }
+
+    if (adjustedSize > currentSize)
+    {
+        mergeNext(header);
+        markAsUsed(header);
+    }
+
+    // Return any excess to the pool.
+    trimUsed(header, adjustedSize);
+
+    return block;
+}
+
+//! @brief Gets the count of bytes in a block, excluding its flags.
+size_t Tlsf::getSize(const BlockHeader *block)
+{
+    return block->Size & SizeMask;
+}
+
+//! @brief Gets the header of a block from a pointer to its data.
+Tlsf::BlockHeader *Tlsf::fromPointer(const void *data)
+{
+    return reinterpret_cast<BlockHeader *>(reinterpret_cast<uintptr_t>(data) - DataOffset);
+}
+
+//! @brief Gets a pointer to the data of a block from its header.
+void *Tlsf::toPointer(const BlockHeader *block)
+{
+    return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(block) + DataOffset);
+}
+
+//! @brief Gets the header of the block physically following another.
+Tlsf::BlockHeader *Tlsf::getNextPhysical(const BlockHeader *block)
+{
+    return reinterpret_cast<BlockHeader *>(reinterpret_cast<uintptr_t>(toPointer(block)) +
+                                           getSize(block) - HeaderOverhead);
+}
+
+//! @brief Links the block physically following another back to it.
+//! @return The header of the following block.
+Tlsf::BlockHeader *Tlsf::linkNext(BlockHeader *block)
+{
+    BlockHeader *next = getNextPhysical(block);
+    next->PrevPhysical = block;
+
+    return next;
+}
+
+//! @brief Flags a block as free in its own header and that of its successor.
+void Tlsf::markAsFree(BlockHeader *block)
+{
+    BlockHeader *next = linkNext(block);
+
+    next->Size |= IsPrevFreeBit;
+    block->Size |= IsFreeBit;
+}
+
+//! @brief Flags a block as used in its own header and that of its successor.
+void Tlsf::markAsUsed(BlockHeader *block)
+{
+    BlockHeader *next = getNextPhysical(block);
+
+    next->Size &= ~IsPrevFreeBit;
+    block->Size &= ~IsFreeBit;
+}
+
+//! @brief Converts a requested size to the size of block required.
+//! @return The block size or 0 if the request can't be satisfied.
+size_t Tlsf::adjustRequestSize(size_t size)
+{
+    if ((size == 0) || (size >= MaxBlockSize))
+        return 0;
+
+    size_t aligned = alignUp(size, Alignment);
+
+    return (aligned < MinBlockSize) ? MinBlockSize : aligned;
+}
+
+//! @brief Calculates the free list indices of blocks of a specific size.
+void Tlsf::mapSize(size_t size, uint32_t &firstLevel, uint32_t &secondLevel)
+{
+    if (size < SmallBlockSize)
+    {
+        // Small blocks are binned linearly in the first list.
+        firstLevel = 0;
+        secondLevel = static_cast<uint32_t>(size / (SmallBlockSize / SecondLevelCount));
+    }
+    else
+    {
+        uint32_t highBit = Bits::getHighestSetBit(size);
+
+        secondLevel = static_cast<uint32_t>(size >> (highBit - SecondLevelCountPow2)) ^
+                      SecondLevelCount;
+        firstLevel = highBit - (FirstLevelShift - 1);
+    }
+}
+
+//! @brief Sets up the free lists and the initial free block of a pool.
+//! @param[in] pool The aligned memory to manage.
+//! @param[in] size The count of bytes in the initial free block, leaving room
+//! for the headers of the block and the sentinel at the end of the pool.
+void Tlsf::initialise(void *pool, size_t size)
+{
+    _nullBlock.PrevPhysical = nullptr;
+    _nullBlock.Size = 0;
+    _nullBlock.NextFree = &_nullBlock;
+    _nullBlock.PrevFree = &_nullBlock;
+    _freeSize = 0;
+    _firstLevelMap = 0;
+
+    for (uint32_t firstLevel = 0; firstLevel < FirstLevelCount; ++firstLevel)
+    {
+        _secondLevelMaps[firstLevel] = 0;
+
+        for (uint32_t secondLevel = 0; secondLevel < SecondLevelCount; ++secondLevel)
+        {
+            _freeLists[firstLevel][secondLevel] = &_nullBlock;
+        }
+    }
+
+    // The header of the first block starts before the pool so that its size
+    // is the first word of it, its PrevPhysical field is never used.
+    BlockHeader *block = reinterpret_cast<BlockHeader *>(reinterpret_cast<uintptr_t>(pool) -
+                                                         HeaderOverhead);
+    block->Size = size | IsFreeBit;
+    _firstBlock = block;
+    insertBlock(block);
+
+    // Terminate the pool with a zero-sized used block.
+    BlockHeader *sentinel = linkNext(block);
+    sentinel->Size = IsPrevFreeBit;
+}
+
+//! @brief Finds a non-empty free list holding blocks at least as large as
+//! those mapped to a pair of indices.
+//! @param[in,out] firstLevel The first level index to search from, updated
+//! with that of the list found.
+//! @param[in,out] secondLevel The second level index to search from, updated
+//! with that of the list found.
+//! @return The first block in the list or nullptr if there was none.
+Tlsf::BlockHeader *Tlsf::findSuitableBlock(uint32_t &firstLevel,
+                                           uint32_t &secondLevel) const
+{
+    uint32_t secondLevelMap = _secondLevelMaps[firstLevel] & (~0u << secondLevel);
+
+    if (secondLevelMap == 0)
+    {
+        // Move to the next larger first level list with free blocks.
+        uint32_t firstLevelMap = ((firstLevel + 1) < 32) ?
+            (_firstLevelMap & (~0u << (firstLevel + 1))) : 0;
+
+        if (firstLevelMap == 0)
+            return nullptr;
+
+        firstLevel = Bits::countTrailingZeros(firstLevelMap);
+        secondLevelMap = _secondLevelMaps[firstLevel];
+    }
+
+    secondLevel = Bits::countTrailingZeros(secondLevelMap);
+
+    return _freeLists[firstLevel][secondLevel];
+}
+
+//! @brief Removes a block from a specific free list.
+void Tlsf::removeFreeBlock(BlockHeader *block, uint32_t firstLevel, uint32_t secondLevel)
+{
+    BlockHeader *previous = block->PrevFree;
+    BlockHeader *next = block->NextFree;
+
+    next->PrevFree = previous;
+    previous->NextFree = next;
+
+    if (_freeLists[firstLevel][secondLevel] == block)
+    {
+        _freeLists[firstLevel][secondLevel] = next;
+
+        if (next == &_nullBlock)
+        {
+            _secondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+
+            if (_secondLevelMaps[firstLevel] == 0)
+            {
+                _firstLevelMap &= ~(1u << firstLevel);
+            }
+        }
+    }
+
+    _freeSize -= getSize(block);
+}
+
+//! @brief Adds a block to the head of a specific free list.
+void Tlsf::insertFreeBlock(BlockHeader *block, uint32_t firstLevel, uint32_t secondLevel)
+{
+    BlockHeader *current = _freeLists[firstLevel][secondLevel];
+
+    block->NextFree = current;
+    block->PrevFree = &_nullBlock;
+    current->PrevFree = block;
+
+    _freeLists[firstLevel][secondLevel] = block;
+    _firstLevelMap |= 1u << firstLevel;
+    _secondLevelMaps[firstLevel] |= 1u << secondLevel;
+    _freeSize += getSize(block);
+}
+
+//! @brief Removes a free block from the list appropriate to its size.
+void Tlsf::removeBlock(BlockHeader *block)
+{
+    uint32_t firstLevel, secondLevel;
+
+    mapSize(getSize(block), firstLevel, secondLevel);
+    removeFreeBlock(block, firstLevel, secondLevel);
+}
+
+//! @brief Adds a free block to the list appropriate to its size.
+void Tlsf::insertBlock(BlockHeader *block)
+{
+    uint32_t firstLevel, secondLevel;
+
+    mapSize(getSize(block), firstLevel, secondLevel);
+    insertFreeBlock(block, firstLevel, secondLevel);
+}
+
+//! @brief Splits the end off a block.
+//! @param[in] block The block to split.
+//! @param[in] size The size to reduce the block to.
+//! @return The new block holding the remainder, marked as free.
+Tlsf::BlockHeader *Tlsf::splitBlock(BlockHeader *block, size_t size)
+{
+    BlockHeader *remaining = reinterpret_cast<BlockHeader *>(
+        reinterpret_cast<uintptr_t>(toPointer(block)) + size - HeaderOverhead);
+    size_t remainingSize = getSize(block) - (size + HeaderOverhead);
+
+    remaining->Size = remainingSize;
+    block->Size = size | (block->Size & ~SizeMask);
+    markAsFree(remaining);
+
+    return remaining;
+}
+
+//! @brief Merges a block into the block physically preceding it.
+//! @return The merged block.
+Tlsf::BlockHeader *Tlsf::absorbBlock(BlockHeader *previous, BlockHeader *block)
+{
+    previous->Size += getSize(block) + HeaderOverhead;
+    linkNext(previous);
+
+    return previous;
+}
+
+//! @brief Merges a block with the block physically preceding it, if free.
+//! @return The merged block.
+Tlsf::BlockHeader *Tlsf::mergePrevious(BlockHeader *block)
+{
+    if ((block->Size & IsPrevFreeBit) != 0)
+    {
+        BlockHeader *previous = block->PrevPhysical;
+
+        removeBlock(previous);
+        block = absorbBlock(previous, block);
+    }
+
+    return block;
+}
+
+//! @brief Merges a block with the block physically following it, if free.
+//! @return The merged block.
+Tlsf::BlockHeader *Tlsf::mergeNext(BlockHeader *block)
+{
+    BlockHeader *next = getNextPhysical(block);
+
+    if ((next->Size & IsFreeBit) != 0)
+    {
+        removeBlock(next);
+        block = absorbBlock(block, next);
+    }
+
+    return block;
+}
+
+//! @brief Returns the excess of a free block about to be used to the pool.
+void Tlsf::trimFree(BlockHeader *block, size_t size)
+{
+    if (getSize(block) >= (sizeof(BlockHeader) + size))
+    {
+        BlockHeader *remaining = splitBlock(block, size);
+
+        linkNext(block);
+        remaining->Size |= IsPrevFreeBit;
+        insertBlock(remaining);
+    }
+}
+
+//! @brief Returns the excess of a used block to the pool.
+void Tlsf::trimUsed(BlockHeader *block, size_t size)
+{
+    if (getSize(block) >= (sizeof(BlockHeader) + size))
+    {
+        BlockHeader *remaining = splitBlock(block, size);
+
+        remaining->Size &= ~IsPrevFreeBit;
+        remaining = mergeNext(remaining);
+        insertBlock(remaining);
+    }
+}
+
+//! @brief Finds and removes a free block of at least a specified size.
+//! @return The block or nullptr if none was large enough.
+Tlsf::BlockHeader *Tlsf::locateFree(size_t size)
+{
+    if (size == 0)
+        return nullptr;
+
+    // Round the size up to the next list boundary so that any block in the
+    // list found will be large enough.
+    if (size >= SmallBlockSize)
+    {
+        size_t round = (static_cast<size_t>(1) <<
+                        (Bits::getHighestSetBit(size) - SecondLevelCountPow2)) - 1;
+        size += round;
+    }
+
+    uint32_t firstLevel, secondLevel;
+    mapSize(size, firstLevel, secondLevel);
+
+    if (firstLevel >= FirstLevelCount)
+        return nullptr;
+
+    BlockHeader *block = findSuitableBlock(firstLevel, secondLevel);
+
+    if (block != nullptr)
+    {
+        removeFreeBlock(block, firstLevel, secondLevel);
+    }
+
+    return block;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global Function Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,145 @@
+//! @file BootUtils/Tlsf.hpp
+//! @brief The declaration of a two-level segregated fit memory allocator.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_UTILS_TLSF_HPP__
+#define __BOOT_UTILS_TLSF_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A general purpose allocator using the two-level segregated fit
+//! algorithm, which allocates, frees and reallocates in O(1) time.
+//! @details
+//! Free blocks are binned by the position of the most significant bit of
+//! their size and then by the next few bits below it. A bitmap at each level
+//! allows a suitable bin to be found with a couple of bit scans. Blocks carry
+//! a header linking them to their physical neighbours so that they can be
+//! merged as soon as they are freed, which bounds fragmentation.
+//!
+//! The object manages a single pool and is created at the start of the memory
+//! it manages, so it must never be copied.
+class Tlsf
+{
+public:
+    // Public Constants
+    //! @brief The alignment of all blocks returned by the allocator, the
+    //! native word size.
+    static constexpr size_t Alignment = sizeof(size_t);
+
+    // Construction/Destruction
+    static Tlsf *create(void *memory, size_t size);
+    Tlsf(const Tlsf &) = delete;
+    Tlsf &operator=(const Tlsf &) = delete;
+
+    // Accessors
+    size_t getFreeSize() const;
+    size_t getLargestFreeSize() const;
+    static size_t getBlockSize(const void *block);
+    bool isConsistent() const;
+
+    // Operations
+    void *allocate(size_t size);
+    void free(void *block);
+    void *reallocate(void *block, size_t size);
+
+private:
+    // Internal Types
+    //! @brief The header which precedes each block of memory.
+    //! @details
+    //! The PrevPhysical field is held in the last word of the preceding block
+    //! and is only valid while that block is free. The NextFree and PrevFree
+    //! fields overlap the data of the block and are only valid while the
+    //! block itself is free.
+    struct BlockHeader
+    {
+        BlockHeader *PrevPhysical;
+        size_t Size;
+        BlockHeader *NextFree;
+        BlockHeader *PrevFree;
+    };
+
+    // Internal Constants
+    static constexpr uint32_t AlignmentPow2 = (sizeof(size_t) == 8) ? 3 : 2;
+    static constexpr uint32_t SecondLevelCountPow2 = 4;
+    static constexpr uint32_t SecondLevelCount = 1u << SecondLevelCountPow2;
+    static constexpr uint32_t FirstLevelShift = SecondLevelCountPow2 + AlignmentPow2;
+    static constexpr uint32_t FirstLevelMax = 30;
+    static constexpr uint32_t FirstLevelCount = FirstLevelMax - FirstLevelShift + 1;
+    static constexpr size_t SmallBlockSize = static_cast<size_t>(1) << FirstLevelShift;
+
+    static constexpr size_t IsFreeBit = 1;
+    static constexpr size_t IsPrevFreeBit = 2;
+    static constexpr size_t SizeMask = ~(IsFreeBit | IsPrevFreeBit);
+
+    static constexpr size_t HeaderOverhead = sizeof(size_t);
+    static constexpr size_t DataOffset = sizeof(BlockHeader *) + sizeof(size_t);
+    static constexpr size_t MinBlockSize = sizeof(BlockHeader) - sizeof(BlockHeader *);
+    static constexpr size_t MaxBlockSize = static_cast<size_t>(1) << FirstLevelMax;
+
+    // Construction
+    Tlsf() = default;
+
+    // Internal Functions
+    static size_t getSize(const BlockHeader *block);
+    static BlockHeader *fromPointer(const void *data);
+    static void *toPointer(const BlockHeader *block);
+    static BlockHeader *getNextPhysical(const BlockHeader *block);
+    static BlockHeader *linkNext(BlockHeader *block);
+    static void markAsFree(BlockHeader *block);
+    static void markAsUsed(BlockHeader *block);
+    static size_t adjustRequestSize(size_t size);
+    static void mapSize(size_t size, uint32_t &firstLevel, uint32_t &secondLevel);
+
+    void initialise(void *pool, size_t size);
+    BlockHeader *findSuitableBlock(uint32_t &firstLevel, uint32_t &secondLevel) const;
+    void removeFreeBlock(BlockHeader *block, uint32_t firstLevel, uint32_t secondLevel);
+    void insertFreeBlock(BlockHeader *block, uint32_t firstLevel, uint32_t secondLevel);
+    void removeBlock(BlockHeader *block);
+    void insertBlock(BlockHeader *block);
+    BlockHeader *splitBlock(BlockHeader *block, size_t size);
+    BlockHeader *absorbBlock(BlockHeader *previous, BlockHeader *block);
+    BlockHeader *mergePrevious(BlockHeader *block);
+    BlockHeader *mergeNext(BlockHeader *block);
+    void trimFree(BlockHeader *block, size_t size);
+    void trimUsed(BlockHeader *block, size_t size);
+    BlockHeader *locateFree(size_t size);
+
+    // Internal Fields
+    BlockHeader _nullBlock;
+    BlockHeader *_firstBlock;
+    size_t _freeSize;
+    uint32_t _firstLevelMap;
+    uint32_t _secondLevelMaps[FirstLevelCount];
+    BlockHeader *_freeLists[FirstLevelCount][SecondLevelCount];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -14,9 +14,18 @@
 // Dependent Header Files
 ////////////////////////////////////////////////////////////////////////////////
 // Public library headers in approximate dependency order.
+#include "../BootUtils/BitTools.hpp"
 #include "../BootUtils/CollectionTools.hpp"
+#include "../BootUtils/MemoryTools.hpp"
 #include "../BootUtils/MemoryMap.hpp"
+#include "../BootUtils/FrameAllocator.hpp"
+#include "../BootUtils/BuddyAllocator.hpp"
+#include "../BootUtils/Tlsf.hpp"
 #include "../BootUtils/Heap.hpp"
+#include "../BootUtils/SlabPool.hpp"
+#include "../BootUtils/SectorCache.hpp"
+#include "../BootUtils/ReadScheduler.hpp"
+#include "../BootUtils/IsoImage.hpp"
 
 #endif // Header guard
 ////////////////////////////////////////////////////////////////////////////////
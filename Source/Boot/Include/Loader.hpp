@@ -24,6 +24,11 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Data Type Declarations
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief The count of allocation size buckets in HeapStats. Bucket 0 counts
+//! blocks of up to 16 bytes, each further bucket counts blocks of up to twice
+//! the size of the last and the final bucket counts all larger blocks.
+constexpr uint32_t HeapStatsBucketCount = 10;
+
 //! @brief Classifies different blocks of memory.
 enum class MemType : uint8_t
 {
@@ -89,6 +94,56 @@ struct MemMapEntry
     uint8_t Padding[sizeof(uint32_t) - sizeof(MemType)];
 };
 
+//! @brief A structure describing the bitmap of free physical page frames
+//! passed on to the kernel.
+struct FrameBitmap
+{
+    //! @brief The physical address of the bitmap.
+    //! @details
+    //! Bit (n % 8) of byte (n / 8) describes the 4 KB page frame starting at
+    //! physical address (n * 4096). The bit is set if the frame is free.
+    uint64_t BitmapAddress;
+
+    //! @brief The count of bytes in the bitmap.
+    uint32_t BitmapSize;
+
+    //! @brief The count of frames described by the bitmap.
+    uint32_t FrameCount;
+
+    //! @brief The count of frames which were free when the bitmap was passed on.
+    uint32_t FreeFrameCount;
+};
+
+//! @brief A snapshot of boot-time heap usage passed on to the kernel.
+struct HeapStats
+{
+    //! @brief The count of allocations in each size bucket.
+    uint32_t AllocationCounts[HeapStatsBucketCount];
+
+    //! @brief The count of individual frees in each size bucket.
+    uint32_t FreeCounts[HeapStatsBucketCount];
+
+    //! @brief The count of bytes allocated when the snapshot was taken.
+    uint32_t BytesInUse;
+
+    //! @brief The largest count of bytes allocated at any one time.
+    uint32_t PeakBytesInUse;
+
+    //! @brief The count of bytes set aside for blocks which can be freed
+    //! individually.
+    uint32_t PoolSize;
+
+    //! @brief The count of free bytes in the pool.
+    uint32_t PoolFreeSize;
+
+    //! @brief The size of the largest free block in the pool.
+    uint32_t LargestFreeBlock;
+
+    //! @brief The proportion of free pool memory which is not part of the
+    //! largest free block, in parts per thousand.
+    uint32_t FragmentationPerMille;
+};
+
 //! @brief A pointer to a function which reads raw blocks from the boot device.
 //! @param[in] destination A pointer to the memory to receive the sectors read.
 //! @param[in] startSector The (0-based?) index of the first sector to read.
@@ -97,6 +152,29 @@ struct MemMapEntry
 using ReadBootSectorsFn = uint32_t (*)(void *destination, uint64_t startSector,
                                        uint32_t sectorCount);
 
+//! @brief A pointer to a function which starts reading raw blocks from the
+//! boot device and returns without waiting for them to arrive.
+//! @param[in] destination A pointer to the memory to receive the sectors
+//! read, which must be left alone until the read completes.
+//! @param[in] startSector The (0-based?) index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @retval true The read was started, or completed if the device can only
+//! read synchronously.
+//! @retval false A read is already in progress or the read can't be started.
+using SubmitBootReadFn = bool (*)(void *destination, uint64_t startSector,
+                                  uint32_t sectorCount);
+
+//! @brief A pointer to a function which advances the read last submitted to
+//! the boot device without waiting.
+//! @retval true The read has finished.
+//! @retval false The read is still in progress.
+using PollBootReadFn = bool (*)();
+
+//! @brief A pointer to a function which waits for the read last submitted
+//! to the boot device to finish.
+//! @return The count of sectors read.
+using WaitBootReadFn = uint32_t (*)();
+
 //! @brief A structure which describes the device used to read further data
 //! at boot time: a kernel, drivers, configuration files, etc.
 struct BootDeviceInfo
@@ -115,6 +193,19 @@ struct BootDeviceInfo
     //! boot device.
     ReadBootSectorsFn ReadBootSectors;
 
+    //! @brief A pointer to a function which starts reading further blocks
+    //! from the boot device, or nullptr before a driver is selected.
+    //! @details
+    //! Only one read can be in progress at a time. It must be finished using
+    //! PollRead or WaitRead before ReadBootSectors is called again.
+    SubmitBootReadFn SubmitRead;
+
+    //! @brief A pointer to a function which advances the read in progress.
+    PollBootReadFn PollRead;
+
+    //! @brief A pointer to a function which finishes the read in progress.
+    WaitBootReadFn WaitRead;
+
     //! @brief The type of device used for booting.
     BootDeviceType DeviceType;
 
@@ -145,6 +236,14 @@ struct BootInfo
     //! with a leading slash '\' character within a quoted section.
     char *BootCommand;
 
+    //! @brief A pointer to statistics describing boot-time memory allocation,
+    //! or nullptr if they were not collected.
+    HeapStats *HeapUsage;
+
+    //! @brief A pointer to the bitmap of free physical page frames, or
+    //! nullptr if the loader did not build one.
+    FrameBitmap *FreeFrames;
+
     //! @brief Defines the count of entries in the MemoryMap array.
     uint16_t MemoryMapCount;
 };
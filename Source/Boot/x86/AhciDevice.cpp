@@ -0,0 +1,664 @@
+//! @file AhciDevice.cpp
+//! @brief The definition of an object which reads from a SATA device
+//! attached to an AHCI host bus adapter.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "AhciDevice.hpp"
+#include "Loader_x86.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data Type Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief An entry in the command list of a port.
+struct CommandHeader
+{
+    //! @brief The length of the command FIS in 32-bit words and flags.
+    uint16_t Flags;
+
+    //! @brief The count of entries in the physical region descriptor table.
+    uint16_t PrdCount;
+
+    //! @brief The count of bytes transferred, updated by the HBA.
+    uint32_t BytesTransferred;
+
+    //! @brief The physical address of the command table.
+    uint32_t TableAddress;
+    uint32_t TableAddressHigh;
+    uint32_t Reserved[4];
+};
+
+//! @brief A physical region descriptor which describes one run of memory
+//! the HBA transfers data to.
+struct PrdEntry
+{
+    //! @brief The physical address of the run, which must be even.
+    uint32_t Address;
+    uint32_t AddressHigh;
+    uint32_t Reserved;
+
+    //! @brief The count of bytes in the run less 1.
+    uint32_t ByteCount;
+};
+
+//! @brief The command to send to the device and where to transfer its data.
+struct alignas(128) CommandTable
+{
+    uint8_t CommandFis[64];
+    uint8_t AtapiCommand[16];
+    uint8_t Reserved[48];
+    PrdEntry Prd;
+};
+
+//! @brief The memory the HBA uses to process commands for a port.
+struct PortMemory
+{
+    alignas(1024) CommandHeader CommandList[AhciDevice::MaxPortCount];
+    alignas(256) uint8_t ReceivedFis[256];
+    CommandTable Tables[AhciDevice::MaxQueueDepth];
+    uint16_t IdentifyData[AtaChannel::IdentifyWordCount];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The offsets of the generic host control registers.
+constexpr uint32_t HostCapabilities = 0x00;
+constexpr uint32_t GlobalHostControl = 0x04;
+constexpr uint32_t PortsImplemented = 0x0C;
+
+constexpr uint32_t CapabilitySlotCountShift = 8;
+constexpr uint32_t CapabilitySlotCountMask = 0x1F;
+constexpr uint32_t CapabilityNcq = 0x40000000;
+constexpr uint32_t GlobalAhciEnable = 0x80000000;
+
+//! @brief The offsets of the registers of a port from the start of the port.
+constexpr uint32_t PortRegistersBase = 0x100;
+constexpr uint32_t PortRegistersSize = 0x80;
+
+constexpr uint32_t PortCommandList = 0x00;
+constexpr uint32_t PortCommandListHigh = 0x04;
+constexpr uint32_t PortReceivedFis = 0x08;
+constexpr uint32_t PortReceivedFisHigh = 0x0C;
+constexpr uint32_t PortInterruptStatus = 0x10;
+constexpr uint32_t PortInterruptEnable = 0x14;
+constexpr uint32_t PortCommand = 0x18;
+constexpr uint32_t PortTaskFileData = 0x20;
+constexpr uint32_t PortSignature = 0x24;
+constexpr uint32_t PortSataStatus = 0x28;
+constexpr uint32_t PortSataError = 0x30;
+constexpr uint32_t PortSataActive = 0x34;
+constexpr uint32_t PortCommandIssue = 0x38;
+
+constexpr uint32_t CommandStart = 0x0001;
+constexpr uint32_t CommandFisReceiveEnable = 0x0010;
+constexpr uint32_t CommandFisReceiveRunning = 0x4000;
+constexpr uint32_t CommandListRunning = 0x8000;
+
+constexpr uint32_t InterruptTaskFileError = 0x40000000;
+
+constexpr uint32_t SataStatusDetectMask = 0x0F;
+constexpr uint32_t SataStatusDevicePresent = 0x03;
+
+constexpr uint32_t AtaSignature = 0x00000101;
+constexpr uint32_t AtapiSignature = 0xEB140101;
+
+//! @brief The programming interface of a PCI SATA controller using AHCI.
+constexpr uint8_t ProgInterfaceAhci = 0x01;
+
+//! @brief The most bytes transferred by a single command, small enough to
+//! keep several commands in flight for typical reads.
+constexpr uint32_t MaxBytesPerCommand = 0x20000;
+
+//! @brief The count of times to poll the port before giving up.
+constexpr uint32_t PollLimit = 0x400000;
+
+constexpr uint16_t HeaderCommandFisWords = 5;
+constexpr uint16_t HeaderAtapi = 0x0020;
+
+constexpr uint8_t FisTypeRegisterHostToDevice = 0x27;
+constexpr uint8_t FisCommandUpdate = 0x80;
+constexpr uint8_t DeviceLbaMode = 0x40;
+constexpr uint8_t FeaturesDma = 0x01;
+
+constexpr uint8_t IdentifyCommand = 0xEC;
+constexpr uint8_t IdentifyPacketCommand = 0xA1;
+constexpr uint8_t PacketCommand = 0xA0;
+constexpr uint8_t ReadDmaExtCommand = 0x25;
+constexpr uint8_t ReadFpdmaQueuedCommand = 0x60;
+
+//! @brief The identify word and bit which show 48-bit addressing is supported.
+constexpr uint32_t IdentifyCommandSets = 83;
+constexpr uint16_t CommandSetLba48 = 0x0400;
+
+//! @brief The identify words which describe native command queuing support.
+constexpr uint32_t IdentifyQueueDepth = 75;
+constexpr uint32_t IdentifySataCapabilities = 76;
+constexpr uint16_t QueueDepthMask = 0x1F;
+constexpr uint16_t SataCapabilityNcq = 0x0100;
+
+//! @brief The memory shared by all ports, so only one port can be used at
+//! a time.
+PortMemory portMemory;
+
+static_assert(sizeof(CommandTable) == 0x100, "Unexpected command table size.");
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stops the compiler moving accesses to memory shared with the HBA
+//! past accesses to its registers.
+inline void memoryBarrier() { __asm__ volatile("" ::: "memory"); }
+
+//! @brief Gets the physical address of an object in memory.
+uint32_t getPhysicalAddress(const void *data)
+{
+    // The loader runs with paging disabled.
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(data));
+}
+
+//! @brief Gets the registers of an AHCI host bus adapter.
+//! @returns A pointer to the memory mapped registers or nullptr if the
+//! function isn't a usable AHCI controller.
+volatile uint32_t *getHostRegisters(const PciAddress &controller)
+{
+    if (readPciConfig8(controller, PciConfig::ProgInterface) != ProgInterfaceAhci)
+        return nullptr;
+
+    // The registers must be mapped into memory space.
+    uint32_t bar = readPciConfig32(controller, PciConfig::Bar5);
+
+    if ((bar & 1) || ((bar & 0xFFFFFFF0) == 0))
+        return nullptr;
+
+    enablePciFunction(controller, PciCommandMemorySpace | PciCommandBusMaster);
+
+    return reinterpret_cast<volatile uint32_t *>(static_cast<uintptr_t>(bar & 0xFFFFFFF0));
+}
+
+//! @brief Prepares a command slot to transfer data into a single run of
+//! memory.
+//! @param[in] slot The index of the command slot to use.
+//! @param[in] command The ATA command to send.
+//! @param[in] destination The physical address of the memory to fill.
+//! @param[in] byteCount The count of bytes to transfer.
+//! @param[in] isPacket True if the command table holds a SCSI packet.
+//! @return A pointer to the command FIS, with the ATAPI command 64 bytes
+//! after it, for the caller to complete.
+uint8_t *prepareCommand(uint32_t slot, uint8_t command, uint32_t destination,
+                        uint32_t byteCount, bool isPacket)
+{
+    CommandHeader &header = portMemory.CommandList[slot];
+    CommandTable &table = portMemory.Tables[slot];
+
+    header.Flags = HeaderCommandFisWords | (isPacket ? HeaderAtapi : 0);
+    header.PrdCount = 1;
+    header.BytesTransferred = 0;
+    header.TableAddress = getPhysicalAddress(&table);
+    header.TableAddressHigh = 0;
+
+    for (uint8_t &value : table.CommandFis)
+    {
+        value = 0;
+    }
+
+    for (uint8_t &value : table.AtapiCommand)
+    {
+        value = 0;
+    }
+
+    table.Prd.Address = destination;
+    table.Prd.AddressHigh = 0;
+    table.Prd.Reserved = 0;
+    table.Prd.ByteCount = byteCount - 1;
+
+    table.CommandFis[0] = FisTypeRegisterHostToDevice;
+    table.CommandFis[1] = FisCommandUpdate;
+    table.CommandFis[2] = command;
+
+    return table.CommandFis;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// AhciDevice Member Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Determines whether a device which can be read was found.
+bool AhciDevice::isValid() const { return _type != AtaDeviceType::None; }
+
+//! @brief Gets the type of device found.
+AtaDeviceType AhciDevice::getType() const { return _type; }
+
+//! @brief Gets the size of the sectors the device reads as a power of 2.
+uint8_t AhciDevice::getSectorSizePow2() const { return _sectorSizePow2; }
+
+//! @brief Gets the most read commands which are kept in flight at once.
+uint32_t AhciDevice::getQueueDepth() const { return _queueDepth; }
+
+//! @brief Gets the bit mask of ports implemented by an AHCI controller.
+//! @param[in] controller The address of the SATA controller function.
+//! @return A mask where bit n is set if port n is implemented, 0 if the
+//! function isn't a usable AHCI controller.
+uint32_t AhciDevice::getImplementedPorts(const PciAddress &controller)
+{
+    volatile uint32_t *host = getHostRegisters(controller);
+
+    return (host == nullptr) ? 0 : host[PortsImplemented / sizeof(uint32_t)];
+}
+
+//! @brief Attempts to find a device on a port of an AHCI controller.
+//! @param[in] controller The address of the SATA controller function.
+//! @param[in] portIndex The index of the port to use.
+//! @retval true A hard disk supporting LBA48 or a CD/DVD drive was found.
+//! @retval false There was no suitable device on the port.
+bool AhciDevice::initialise(const PciAddress &controller, uint32_t portIndex)
+{
+    release();
+
+    volatile uint32_t *host = getHostRegisters(controller);
+
+    if ((host == nullptr) || (portIndex >= MaxPortCount))
+        return false;
+
+    host[GlobalHostControl / sizeof(uint32_t)] |= GlobalAhciEnable;
+
+    uint32_t capabilities = host[HostCapabilities / sizeof(uint32_t)];
+
+    if ((host[PortsImplemented / sizeof(uint32_t)] & (1u << portIndex)) == 0)
+        return false;
+
+    _port = host + ((PortRegistersBase + (portIndex * PortRegistersSize)) / sizeof(uint32_t));
+
+    if ((readPort(PortSataStatus) & SataStatusDetectMask) != SataStatusDevicePresent)
+    {
+        _port = nullptr;
+        return false;
+    }
+
+    // Take over the port from the BIOS, which will need it back if the
+    // device turns out not to hold the boot media.
+    _savedCommandList = readPort(PortCommandList);
+    _savedReceivedFis = readPort(PortReceivedFis);
+    _savedCommand = readPort(PortCommand);
+    _savedInterruptEnable = readPort(PortInterruptEnable);
+
+    if (stopEngine() == false)
+    {
+        _port = nullptr;
+        return false;
+    }
+
+    writePort(PortCommandList, getPhysicalAddress(portMemory.CommandList));
+    writePort(PortCommandListHigh, 0);
+    writePort(PortReceivedFis, getPhysicalAddress(portMemory.ReceivedFis));
+    writePort(PortReceivedFisHigh, 0);
+    writePort(PortInterruptEnable, 0);
+
+    uint32_t signature = readPort(PortSignature);
+
+    if (signature == AtaSignature)
+    {
+        _type = AtaDeviceType::Ata;
+    }
+    else if (signature == AtapiSignature)
+    {
+        _type = AtaDeviceType::Atapi;
+    }
+
+    if ((_type == AtaDeviceType::None) || (startEngine() == false) ||
+        (identify() == false))
+    {
+        release();
+        return false;
+    }
+
+    const uint16_t *identifyData = portMemory.IdentifyData;
+
+    if (_type == AtaDeviceType::Atapi)
+    {
+        if (AtaChannel::isCdRomDrive(identifyData) == false)
+        {
+            release();
+            return false;
+        }
+
+        _sectorSizePow2 = 11;
+        _queueDepth = 1;
+        _useNcq = false;
+    }
+    else
+    {
+        if ((identifyData[IdentifyCommandSets] & CommandSetLba48) == 0)
+        {
+            release();
+            return false;
+        }
+
+        _sectorSizePow2 = 9;
+        _queueDepth = 1;
+
+        // Queue as many commands as the HBA, the device and the command
+        // tables allow.
+        if ((capabilities & CapabilityNcq) &&
+            (identifyData[IdentifySataCapabilities] & SataCapabilityNcq))
+        {
+            uint32_t hostDepth = ((capabilities >> CapabilitySlotCountShift) &
+                                  CapabilitySlotCountMask) + 1;
+            uint32_t deviceDepth = (identifyData[IdentifyQueueDepth] & QueueDepthMask) + 1;
+
+            _queueDepth = (hostDepth < deviceDepth) ? hostDepth : deviceDepth;
+
+            if (_queueDepth > MaxQueueDepth)
+            {
+                _queueDepth = MaxQueueDepth;
+            }
+        }
+
+        _useNcq = _queueDepth > 1;
+    }
+
+    return true;
+}
+
+//! @brief Returns the port to the state the BIOS left it in.
+void AhciDevice::release()
+{
+    if (_port == nullptr)
+        return;
+
+    stopEngine();
+    writePort(PortCommandList, _savedCommandList);
+    writePort(PortReceivedFis, _savedReceivedFis);
+    writePort(PortSataError, UINT32_MAX);
+    writePort(PortInterruptStatus, UINT32_MAX);
+    writePort(PortInterruptEnable, _savedInterruptEnable);
+
+    if (_savedCommand & CommandFisReceiveEnable)
+    {
+        writePort(PortCommand, readPort(PortCommand) | CommandFisReceiveEnable);
+    }
+
+    if (_savedCommand & CommandStart)
+    {
+        writePort(PortCommand, readPort(PortCommand) | CommandStart);
+    }
+
+    _port = nullptr;
+    _type = AtaDeviceType::None;
+    _queueDepth = 0;
+    _useNcq = false;
+}
+
+//! @brief Reads sectors from the device, keeping as many commands in flight
+//! as the queue depth allows.
+//! @param[in] destination The memory to receive the sectors, which must be
+//! 2-byte aligned.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @return The count of sectors read.
+uint32_t AhciDevice::read(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    uintptr_t target = reinterpret_cast<uintptr_t>(destination);
+
+    if ((isValid() == false) || (target & 1))
+        return 0;
+
+    if (_type == AtaDeviceType::Atapi)
+    {
+        // READ(12) only addresses 32-bit logical blocks.
+        if (startSector > UINT32_MAX)
+            return 0;
+
+        uint64_t available = (static_cast<uint64_t>(UINT32_MAX) + 1) - startSector;
+
+        if (sectorCount > available)
+        {
+            sectorCount = static_cast<uint32_t>(available);
+        }
+    }
+
+    const uint32_t maxPerCommand = MaxBytesPerCommand >> _sectorSizePow2;
+    uint32_t slotOffsets[MaxQueueDepth];
+    uint32_t inFlight = 0;
+    uint32_t issued = 0;
+
+    while ((issued < sectorCount) || (inFlight != 0))
+    {
+        // Fill every free slot.
+        for (uint32_t slot = 0; (slot < _queueDepth) && (issued < sectorCount); ++slot)
+        {
+            uint32_t slotMask = 1u << slot;
+
+            if (inFlight & slotMask)
+                continue;
+
+            uint32_t count = sectorCount - issued;
+
+            if (count > maxPerCommand)
+            {
+                count = maxPerCommand;
+            }
+
+            issueRead(slot, startSector + issued, count,
+                      target + (static_cast<uintptr_t>(issued) << _sectorSizePow2));
+
+            slotOffsets[slot] = issued;
+            inFlight |= slotMask;
+            issued += count;
+        }
+
+        uint32_t completed = waitForCompletion(inFlight);
+
+        if (completed == 0)
+        {
+            // Everything before the earliest command still in flight has
+            // been transferred.
+            uint32_t sectorsRead = issued;
+
+            for (uint32_t slot = 0; slot < _queueDepth; ++slot)
+            {
+                if ((inFlight & (1u << slot)) && (slotOffsets[slot] < sectorsRead))
+                {
+                    sectorsRead = slotOffsets[slot];
+                }
+            }
+
+            recover();
+            return sectorsRead;
+        }
+
+        inFlight &= ~completed;
+    }
+
+    return issued;
+}
+
+//! @brief Reads a register of the port.
+//! @param[in] offset The offset of the register from the start of the port.
+uint32_t AhciDevice::readPort(uint32_t offset) const
+{
+    return _port[offset / sizeof(uint32_t)];
+}
+
+//! @brief Writes to a register of the port.
+//! @param[in] offset The offset of the register from the start of the port.
+//! @param[in] value The value to write.
+void AhciDevice::writePort(uint32_t offset, uint32_t value)
+{
+    _port[offset / sizeof(uint32_t)] = value;
+}
+
+//! @brief Stops the port processing commands and receiving FISes.
+//! @retval true The port is idle.
+//! @retval false The port didn't stop in time.
+bool AhciDevice::stopEngine()
+{
+    writePort(PortCommand, readPort(PortCommand) & ~CommandStart);
+
+    uint32_t i = 0;
+
+    while ((readPort(PortCommand) & CommandListRunning) && (i < PollLimit))
+    {
+        ++i;
+    }
+
+    writePort(PortCommand, readPort(PortCommand) & ~CommandFisReceiveEnable);
+
+    while ((readPort(PortCommand) & CommandFisReceiveRunning) && (i < PollLimit))
+    {
+        ++i;
+    }
+
+    return i < PollLimit;
+}
+
+//! @brief Starts the port processing commands once the device is idle.
+//! @retval true The port is running.
+//! @retval false The device remained busy.
+bool AhciDevice::startEngine()
+{
+    writePort(PortSataError, UINT32_MAX);
+    writePort(PortInterruptStatus, UINT32_MAX);
+    writePort(PortCommand, readPort(PortCommand) | CommandFisReceiveEnable);
+
+    const uint32_t busyMask = AtaChannel::StatusBusy | AtaChannel::StatusDataRequest;
+    uint32_t i = 0;
+
+    while ((readPort(PortTaskFileData) & busyMask) && (i < PollLimit))
+    {
+        ++i;
+    }
+
+    if (i == PollLimit)
+        return false;
+
+    writePort(PortCommand, readPort(PortCommand) | CommandStart);
+
+    return true;
+}
+
+//! @brief Restarts the port after a command failed, which abandons all
+//! commands in flight.
+//! @retval true The port is ready for further commands.
+//! @retval false The port can't be used any more.
+bool AhciDevice::recover()
+{
+    if (stopEngine() && startEngine())
+        return true;
+
+    _type = AtaDeviceType::None;
+    return false;
+}
+
+//! @brief Reads the identify data of the device into the shared memory.
+bool AhciDevice::identify()
+{
+    uint8_t command = (_type == AtaDeviceType::Atapi) ? IdentifyPacketCommand :
+                                                        IdentifyCommand;
+
+    prepareCommand(0, command, getPhysicalAddress(portMemory.IdentifyData),
+                   sizeof(portMemory.IdentifyData), false);
+
+    memoryBarrier();
+    writePort(PortCommandIssue, 1);
+
+    return waitForCompletion(1) != 0;
+}
+
+//! @brief Sends a command to read a run of sectors using a command slot.
+//! @param[in] slot The index of a command slot not in use.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of sectors to read, no more than
+//! MaxBytesPerCommand covers.
+//! @param[in] destination The physical address of the memory to fill.
+void AhciDevice::issueRead(uint32_t slot, uint64_t startSector, uint32_t sectorCount,
+                           uintptr_t destination)
+{
+    bool isPacket = (_type == AtaDeviceType::Atapi);
+    uint8_t command = isPacket ? PacketCommand :
+                      (_useNcq ? ReadFpdmaQueuedCommand : ReadDmaExtCommand);
+
+    uint8_t *fis = prepareCommand(slot, command, static_cast<uint32_t>(destination),
+                                  sectorCount << _sectorSizePow2, isPacket);
+
+    if (isPacket)
+    {
+        fis[3] = FeaturesDma;
+        AtaChannel::createRead12Packet(fis + 64, static_cast<uint32_t>(startSector),
+                                       sectorCount);
+    }
+    else
+    {
+        fis[4] = static_cast<uint8_t>(startSector);
+        fis[5] = static_cast<uint8_t>(startSector >> 8);
+        fis[6] = static_cast<uint8_t>(startSector >> 16);
+        fis[7] = DeviceLbaMode;
+        fis[8] = static_cast<uint8_t>(startSector >> 24);
+        fis[9] = static_cast<uint8_t>(startSector >> 32);
+        fis[10] = static_cast<uint8_t>(startSector >> 40);
+
+        if (_useNcq)
+        {
+            // The count goes in the features registers and the tag, which
+            // matches the slot, in the count register.
+            fis[3] = static_cast<uint8_t>(sectorCount);
+            fis[11] = static_cast<uint8_t>(sectorCount >> 8);
+            fis[12] = static_cast<uint8_t>(slot << 3);
+        }
+        else
+        {
+            fis[12] = static_cast<uint8_t>(sectorCount);
+            fis[13] = static_cast<uint8_t>(sectorCount >> 8);
+        }
+    }
+
+    memoryBarrier();
+
+    if (_useNcq)
+    {
+        writePort(PortSataActive, 1u << slot);
+    }
+
+    writePort(PortCommandIssue, 1u << slot);
+}
+
+//! @brief Waits for at least one of a set of commands to complete.
+//! @param[in] slotMask The mask of slots holding commands in flight.
+//! @return The mask of slots whose commands completed or 0 if a command
+//! failed or the device stopped responding.
+uint32_t AhciDevice::waitForCompletion(uint32_t slotMask)
+{
+    // Interrupts are disabled, so poll the port. Queued commands stay
+    // active after they leave the command issue register.
+    for (uint32_t i = 0; i < PollLimit; ++i)
+    {
+        if (readPort(PortInterruptStatus) & InterruptTaskFileError)
+            break;
+
+        uint32_t pending = readPort(PortCommandIssue) | readPort(PortSataActive);
+        uint32_t completed = slotMask & ~pending;
+
+        if (completed != 0)
+        {
+            memoryBarrier();
+            return completed;
+        }
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
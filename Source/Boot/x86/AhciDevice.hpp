@@ -0,0 +1,108 @@
+//! @file AhciDevice.hpp
+//! @brief The declaration of an object which reads from a SATA device
+//! attached to an AHCI host bus adapter.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_AHCI_DEVICE_HPP__
+#define __BOOT_AHCI_DEVICE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AtaChannel.hpp"
+#include "Pci.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which reads from a SATA hard disk or CD/DVD drive
+//! attached to a port of an AHCI host bus adapter.
+//! @details
+//! Disks which support native command queuing have several READ FPDMA QUEUED
+//! commands in flight at once, other devices are read one command at a time.
+//! Physical region descriptors point directly at the destination and the
+//! loader runs with paging disabled, so pointers are physical addresses.
+//!
+//! The command list and FIS receive area are shared by all instances, so
+//! only one port can be in use at a time. The BIOS settings of the port are
+//! restored by release() so that it can be used again if the port isn't
+//! used natively.
+class AhciDevice
+{
+public:
+    // Public Constants
+    //! @brief The most ports an AHCI host bus adapter can implement.
+    static constexpr uint32_t MaxPortCount = 32;
+
+    //! @brief The most read commands kept in flight at once.
+    static constexpr uint32_t MaxQueueDepth = 8;
+
+    // Construction/Destruction
+    //! @brief Constructs an object which must be initialised before use.
+    constexpr AhciDevice() :
+        _port(nullptr),
+        _savedCommandList(0),
+        _savedReceivedFis(0),
+        _savedCommand(0),
+        _savedInterruptEnable(0),
+        _queueDepth(0),
+        _sectorSizePow2(0),
+        _type(AtaDeviceType::None),
+        _useNcq(false)
+    {
+    }
+
+    // Accessors
+    bool isValid() const;
+    AtaDeviceType getType() const;
+    uint8_t getSectorSizePow2() const;
+    uint32_t getQueueDepth() const;
+    static uint32_t getImplementedPorts(const PciAddress &controller);
+
+    // Operations
+    bool initialise(const PciAddress &controller, uint32_t portIndex);
+    void release();
+    uint32_t read(void *destination, uint64_t startSector, uint32_t sectorCount);
+
+private:
+    // Internal Functions
+    uint32_t readPort(uint32_t offset) const;
+    void writePort(uint32_t offset, uint32_t value);
+    bool stopEngine();
+    bool startEngine();
+    bool recover();
+    bool identify();
+    void issueRead(uint32_t slot, uint64_t startSector, uint32_t sectorCount,
+                   uintptr_t destination);
+    uint32_t waitForCompletion(uint32_t slotMask);
+
+    // Internal Fields
+    volatile uint32_t *_port;
+    uint32_t _savedCommandList;
+    uint32_t _savedReceivedFis;
+    uint32_t _savedCommand;
+    uint32_t _savedInterruptEnable;
+    uint32_t _queueDepth;
+    uint8_t _sectorSizePow2;
+    AtaDeviceType _type;
+    bool _useNcq;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
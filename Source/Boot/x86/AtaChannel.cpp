@@ -0,0 +1,356 @@
+//! @file AtaChannel.cpp
+//! @brief The definition of an object which drives the registers of a legacy
+//! ATA (IDE) channel using programmed I/O.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "AtaChannel.hpp"
+#include "Loader_x86.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The count of status polls before giving up on a device, several
+//! seconds given that each port read takes around a microsecond.
+constexpr uint32_t PollLimit = 0x400000;
+
+//! @brief The bit in the device control register which disables interrupts.
+constexpr uint8_t ControlDisableInterrupts = 0x02;
+
+//! @brief The bits always set when writing the device select register.
+constexpr uint8_t DeviceSelectBase = 0xA0;
+
+//! @brief The bit in the device select register which selects LBA addressing.
+constexpr uint8_t DeviceSelectLba = 0x40;
+
+constexpr uint8_t IdentifyDeviceCommand = 0xEC;
+constexpr uint8_t IdentifyPacketDeviceCommand = 0xA1;
+constexpr uint8_t PacketCommand = 0xA0;
+constexpr uint8_t ScsiRead12 = 0xA8;
+
+//! @brief The bit in the features register which requests a DMA transfer
+//! of the data for a PACKET command.
+constexpr uint8_t PacketFeatureDma = 0x01;
+
+//! @brief The values of the LBA mid and high registers after an ATAPI
+//! device aborts IDENTIFY DEVICE.
+constexpr uint8_t AtapiSignatureMid = 0x14;
+constexpr uint8_t AtapiSignatureHigh = 0xEB;
+
+//! @brief The device type in bits 8-12 of identify word 0 for CD/DVD drives.
+constexpr uint16_t CdRomDeviceType = 0x05;
+
+//! @brief The value read from the status register when no device drives
+//! the bus.
+constexpr uint8_t FloatingBus = 0xFF;
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Writes a 32-bit value in the big-endian order SCSI commands use.
+void writeBigEndian32(uint8_t *bytes, uint32_t value)
+{
+    bytes[0] = static_cast<uint8_t>(value >> 24);
+    bytes[1] = static_cast<uint8_t>(value >> 16);
+    bytes[2] = static_cast<uint8_t>(value >> 8);
+    bytes[3] = static_cast<uint8_t>(value);
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// AtaChannel Member Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Determines whether the channel has been initialised.
+bool AtaChannel::isValid() const { return _basePort != 0; }
+
+//! @brief Gets the first of the command block I/O ports.
+uint16_t AtaChannel::getBasePort() const { return _basePort; }
+
+//! @brief Reads the status of the selected device without acknowledging
+//! any pending interrupt.
+uint8_t AtaChannel::getAlternateStatus() const
+{
+    return ReadFromPort8(_controlPort);
+}
+
+//! @brief Reads an 8-bit command block register.
+uint8_t AtaChannel::readRegister(AtaRegister reg) const
+{
+    return ReadFromPort8(_basePort + static_cast<uint16_t>(reg));
+}
+
+//! @brief Prepares to drive a channel with interrupts disabled.
+//! @param[in] basePort The first port of the command block registers.
+//! @param[in] controlPort The port of the device control register.
+//! @retval true Something may be attached to the channel.
+//! @retval false Nothing is attached to the channel.
+bool AtaChannel::initialise(uint16_t basePort, uint16_t controlPort)
+{
+    _basePort = basePort;
+    _controlPort = controlPort;
+    _selectedDevice = 0xFF;
+
+    if (getAlternateStatus() == FloatingBus)
+    {
+        _basePort = 0;
+        return false;
+    }
+
+    setInterruptsEnabled(false);
+
+    return true;
+}
+
+//! @brief Selects the device on the channel which subsequent commands address.
+//! @param[in] device 0 for the master device, 1 for the slave.
+//! @retval true The device was selected and is not busy.
+//! @retval false The device did not become ready in time.
+bool AtaChannel::selectDevice(uint8_t device)
+{
+    if (device != _selectedDevice)
+    {
+        writeRegister(AtaRegister::DeviceSelect,
+                      static_cast<uint8_t>(DeviceSelectBase | ((device & 1) << 4)));
+        delay();
+        _selectedDevice = device;
+    }
+
+    return waitUntilReady();
+}
+
+//! @brief Identifies a device attached to the channel.
+//! @param[in] device 0 for the master device, 1 for the slave.
+//! @param[out] identifyData Receives IdentifyWordCount words of
+//! IDENTIFY (PACKET) DEVICE data if a device was found.
+//! @return The type of device found, if any.
+AtaDeviceType AtaChannel::identify(uint8_t device, uint16_t *identifyData)
+{
+    if ((isValid() == false) || (selectDevice(device) == false))
+        return AtaDeviceType::None;
+
+    writeRegister(AtaRegister::SectorCount, 0);
+    writeRegister(AtaRegister::LbaLow, 0);
+    writeRegister(AtaRegister::LbaMid, 0);
+    writeRegister(AtaRegister::LbaHigh, 0);
+    writeRegister(AtaRegister::Command, IdentifyDeviceCommand);
+    delay();
+
+    uint8_t status = getAlternateStatus();
+
+    if ((status == 0) || (status == FloatingBus) || (waitUntilReady() == false))
+        return AtaDeviceType::None;
+
+    AtaDeviceType type = AtaDeviceType::None;
+    uint8_t mid = readRegister(AtaRegister::LbaMid);
+    uint8_t high = readRegister(AtaRegister::LbaHigh);
+
+    if ((mid == AtapiSignatureMid) && (high == AtapiSignatureHigh))
+    {
+        // The device aborted the command, so ask it the right way.
+        type = AtaDeviceType::Atapi;
+        writeRegister(AtaRegister::Command, IdentifyPacketDeviceCommand);
+        delay();
+    }
+    else if ((mid == 0) && (high == 0))
+    {
+        type = AtaDeviceType::Ata;
+    }
+    else
+    {
+        // Possibly a SATA device behind a controller in legacy mode which
+        // would need a different driver.
+        return AtaDeviceType::None;
+    }
+
+    if (waitForData() == false)
+        return AtaDeviceType::None;
+
+    readData(identifyData, IdentifyWordCount);
+
+    return type;
+}
+
+//! @brief Writes an 8-bit command block register.
+void AtaChannel::writeRegister(AtaRegister reg, uint8_t value)
+{
+    WriteToPort8(_basePort + static_cast<uint16_t>(reg), value);
+}
+
+//! @brief Enables or disables interrupts from the devices on the channel.
+void AtaChannel::setInterruptsEnabled(bool isEnabled)
+{
+    WriteToPort8(_controlPort, isEnabled ? 0 : ControlDisableInterrupts);
+}
+
+//! @brief Loads the 48-bit LBA and sector count registers of the selected
+//! device ready for an extended command.
+//! @param[in] startSector The index of the first sector to transfer.
+//! @param[in] sectorCount The count of sectors to transfer, up to 65536.
+void AtaChannel::setLba48(uint64_t startSector, uint32_t sectorCount)
+{
+    // Each register is a FIFO which takes the high order byte first.
+    writeRegister(AtaRegister::SectorCount, static_cast<uint8_t>(sectorCount >> 8));
+    writeRegister(AtaRegister::LbaLow, static_cast<uint8_t>(startSector >> 24));
+    writeRegister(AtaRegister::LbaMid, static_cast<uint8_t>(startSector >> 32));
+    writeRegister(AtaRegister::LbaHigh, static_cast<uint8_t>(startSector >> 40));
+    writeRegister(AtaRegister::SectorCount, static_cast<uint8_t>(sectorCount));
+    writeRegister(AtaRegister::LbaLow, static_cast<uint8_t>(startSector));
+    writeRegister(AtaRegister::LbaMid, static_cast<uint8_t>(startSector >> 8));
+    writeRegister(AtaRegister::LbaHigh, static_cast<uint8_t>(startSector >> 16));
+    writeRegister(AtaRegister::DeviceSelect,
+                  static_cast<uint8_t>(DeviceSelectBase | DeviceSelectLba |
+                                       ((_selectedDevice & 1) << 4)));
+}
+
+//! @brief Writes the command register of the selected device, then waits
+//! for it to update its status.
+void AtaChannel::issueCommand(uint8_t command)
+{
+    writeRegister(AtaRegister::Command, command);
+    delay();
+}
+
+//! @brief Issues a PACKET command and sends the SCSI command bytes.
+//! @param[in] device 0 for the master device, 1 for the slave.
+//! @param[in] packet The PacketSize bytes of the SCSI command.
+//! @param[in] byteCountLimit The most bytes to transfer per data request
+//! when using programmed I/O.
+//! @param[in] isDma True to transfer the data using the bus master, false to
+//! transfer it using programmed I/O.
+//! @retval true The device accepted the command.
+//! @retval false The device was not ready or rejected the command.
+bool AtaChannel::sendPacket(uint8_t device, const uint8_t *packet,
+                            uint16_t byteCountLimit, bool isDma)
+{
+    if (selectDevice(device) == false)
+        return false;
+
+    writeRegister(AtaRegister::Features, isDma ? PacketFeatureDma : 0);
+    writeRegister(AtaRegister::LbaMid, static_cast<uint8_t>(byteCountLimit));
+    writeRegister(AtaRegister::LbaHigh, static_cast<uint8_t>(byteCountLimit >> 8));
+    writeRegister(AtaRegister::Command, PacketCommand);
+    delay();
+
+    if (waitForData() == false)
+        return false;
+
+    writeData(packet, PacketSize / 2);
+
+    return true;
+}
+
+//! @brief Waits for the selected device to stop being busy.
+//! @retval true The device is no longer busy.
+//! @retval false The device stayed busy for too long.
+bool AtaChannel::waitUntilReady() const
+{
+    for (uint32_t i = 0; i < PollLimit; ++i)
+    {
+        if ((getAlternateStatus() & StatusBusy) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+//! @brief Waits for the selected device to have data to transfer.
+//! @retval true The device is ready to transfer a block of data.
+//! @retval false The device completed the command, failed or timed out.
+bool AtaChannel::waitForData() const
+{
+    if (waitUntilReady() == false)
+        return false;
+
+    // Reading the status register acknowledges the command.
+    uint8_t status = readRegister(AtaRegister::Command);
+
+    return (status & (StatusError | StatusDeviceFault | StatusDataRequest)) ==
+           StatusDataRequest;
+}
+
+//! @brief Waits for the selected device to finish a command.
+//! @retval true The command completed successfully.
+//! @retval false The command failed or the device timed out.
+bool AtaChannel::waitForCompletion() const
+{
+    for (uint32_t i = 0; i < PollLimit; ++i)
+    {
+        uint8_t status = getAlternateStatus();
+
+        if ((status & (StatusBusy | StatusDataRequest)) == 0)
+            return (status & (StatusError | StatusDeviceFault)) == 0;
+    }
+
+    return false;
+}
+
+//! @brief Reads words from the data register.
+void AtaChannel::readData(void *buffer, uint32_t wordCount) const
+{
+    ReadFromPortBlock16(_basePort, buffer, wordCount);
+}
+
+//! @brief Reads pairs of words from the data register using 32-bit accesses,
+//! which not all controllers support.
+void AtaChannel::readDataDoublewords(void *buffer, uint32_t doublewordCount) const
+{
+    ReadFromPortBlock32(_basePort, buffer, doublewordCount);
+}
+
+//! @brief Writes words to the data register.
+void AtaChannel::writeData(const void *buffer, uint32_t wordCount)
+{
+    WriteToPortBlock16(_basePort, buffer, wordCount);
+}
+
+//! @brief Creates a SCSI READ(12) command.
+//! @param[out] packet Receives the PacketSize bytes of the command.
+//! @param[in] startSector The logical block address of the first sector.
+//! @param[in] sectorCount The count of sectors to read.
+void AtaChannel::createRead12Packet(uint8_t *packet, uint32_t startSector,
+                                    uint32_t sectorCount)
+{
+    for (uint32_t i = 0; i < PacketSize; ++i)
+    {
+        packet[i] = 0;
+    }
+
+    packet[0] = ScsiRead12;
+    writeBigEndian32(packet + 2, startSector);
+    writeBigEndian32(packet + 6, sectorCount);
+}
+
+//! @brief Determines whether IDENTIFY PACKET DEVICE data describes a CD/DVD
+//! drive which accepts 12-byte command packets.
+bool AtaChannel::isCdRomDrive(const uint16_t *identifyData)
+{
+    // Bits 0-1 of word 0 are non-zero for 16-byte packet devices.
+    uint16_t config = identifyData[0];
+
+    return ((config & 0x03) == 0) && (((config >> 8) & 0x1F) == CdRomDeviceType);
+}
+
+//! @brief Waits the 400ns a device needs to update its status after a
+//! command or device selection.
+void AtaChannel::delay() const
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        getAlternateStatus();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,132 @@
+//! @file AtaChannel.hpp
+//! @brief The declaration of an object which drives the registers of a legacy
+//! ATA (IDE) channel using programmed I/O.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_ATA_CHANNEL_HPP__
+#define __BOOT_ATA_CHANNEL_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Identifies the kind of device attached to an ATA channel.
+enum class AtaDeviceType : uint8_t
+{
+    //! @brief No device responded.
+    None,
+
+    //! @brief A hard disk which accepts ATA commands.
+    Ata,
+
+    //! @brief A device, such as a CD-ROM drive, which accepts SCSI commands
+    //! wrapped in ATA PACKET commands.
+    Atapi,
+};
+
+//! @brief Identifies the command block registers relative to the base port.
+enum class AtaRegister : uint8_t
+{
+    Data = 0,
+    Features = 1,   // Error when read.
+    SectorCount = 2,
+    LbaLow = 3,
+    LbaMid = 4,     // Byte count low for ATAPI.
+    LbaHigh = 5,    // Byte count high for ATAPI.
+    DeviceSelect = 6,
+    Command = 7,    // Status when read.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which drives a legacy ATA channel, polling for status
+//! rather than waiting for interrupts.
+class AtaChannel
+{
+public:
+    // Public Constants
+    static constexpr uint16_t PrimaryBasePort = 0x1F0;
+    static constexpr uint16_t PrimaryControlPort = 0x3F6;
+    static constexpr uint16_t SecondaryBasePort = 0x170;
+    static constexpr uint16_t SecondaryControlPort = 0x376;
+
+    //! @brief The count of 16-bit words returned by IDENTIFY (PACKET) DEVICE.
+    static constexpr uint32_t IdentifyWordCount = 256;
+
+    //! @brief The size of the SCSI command packets sent to ATAPI devices.
+    static constexpr uint32_t PacketSize = 12;
+
+    static constexpr uint8_t StatusError = 0x01;
+    static constexpr uint8_t StatusDataRequest = 0x08;
+    static constexpr uint8_t StatusDeviceFault = 0x20;
+    static constexpr uint8_t StatusReady = 0x40;
+    static constexpr uint8_t StatusBusy = 0x80;
+
+    // Construction/Destruction
+    //! @brief Constructs an object which must be initialised before use.
+    //! @note The constructor is constexpr so that static instances are built
+    //! at compile time, as the loader runs no global constructors.
+    constexpr AtaChannel() :
+        _basePort(0),
+        _controlPort(0),
+        _selectedDevice(0xFF)
+    {
+    }
+
+    // Accessors
+    bool isValid() const;
+    uint16_t getBasePort() const;
+    uint8_t getAlternateStatus() const;
+    uint8_t readRegister(AtaRegister reg) const;
+
+    // Operations
+    bool initialise(uint16_t basePort, uint16_t controlPort);
+    bool selectDevice(uint8_t device);
+    AtaDeviceType identify(uint8_t device, uint16_t *identifyData);
+    void writeRegister(AtaRegister reg, uint8_t value);
+    void setInterruptsEnabled(bool isEnabled);
+    void setLba48(uint64_t startSector, uint32_t sectorCount);
+    void issueCommand(uint8_t command);
+    bool sendPacket(uint8_t device, const uint8_t *packet, uint16_t byteCountLimit,
+                    bool isDma);
+    bool waitUntilReady() const;
+    bool waitForData() const;
+    bool waitForCompletion() const;
+    void readData(void *buffer, uint32_t wordCount) const;
+    void readDataDoublewords(void *buffer, uint32_t doublewordCount) const;
+    void writeData(const void *buffer, uint32_t wordCount);
+    static void createRead12Packet(uint8_t *packet, uint32_t startSector,
+                                   uint32_t sectorCount);
+    static bool isCdRomDrive(const uint16_t *identifyData);
+
+private:
+    // Internal Functions
+    void delay() const;
+
+    // Internal Fields
+    uint16_t _basePort;
+    uint16_t _controlPort;
+    uint8_t _selectedDevice;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,325 @@
+//! @file AtaPioDevice.cpp
+//! @brief The definition of an object which reads from an ATA hard disk
+//! using programmed I/O.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "AtaPioDevice.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+constexpr uint8_t IdentifyDeviceCommand = 0xEC;
+constexpr uint8_t ReadSectorsExtCommand = 0x24;
+constexpr uint8_t ReadMultipleExtCommand = 0x29;
+constexpr uint8_t SetMultipleModeCommand = 0xC6;
+
+//! @brief The most sectors a 48-bit read command can transfer.
+constexpr uint32_t MaxSectorsPerCommand = 0x10000;
+
+//! @brief The count of bits in a 48-bit logical block address.
+constexpr uint32_t Lba48Bits = 48;
+
+//! @brief The sector size assumed unless the device reports otherwise.
+constexpr uint8_t DefaultSectorSizePow2 = 9;
+
+//! @brief The largest sector size the driver accepts, 32 KB.
+constexpr uint8_t MaxSectorSizePow2 = 15;
+
+//! @brief The identify word holding the most sectors per DRQ block which
+//! READ MULTIPLE can transfer in its low byte.
+constexpr uint32_t IdentifyMaxMultiple = 47;
+
+//! @brief The identify word and bit which show 48-bit addressing is supported.
+constexpr uint32_t IdentifyCommandSets = 83;
+constexpr uint16_t CommandSetLba48 = 0x0400;
+
+//! @brief The identify word describing the physical and logical sector size,
+//! and the bits which show it is valid.
+constexpr uint32_t IdentifySectorSize = 106;
+constexpr uint16_t SectorSizeValidMask = 0xC000;
+constexpr uint16_t SectorSizeValid = 0x4000;
+
+//! @brief The bit of IdentifySectorSize set when logical sectors are longer
+//! than 256 words.
+constexpr uint16_t SectorSizeLongLogical = 0x1000;
+
+//! @brief The first of two identify words holding the count of 16-bit words
+//! in a long logical sector.
+constexpr uint32_t IdentifyLogicalSectorWords = 117;
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Calculates the sector size from the identify data of a hard disk.
+//! @return The sector size as a power of 2, or 0 if it isn't one the driver
+//! can handle.
+uint8_t getLogicalSectorSizePow2(const uint16_t *identifyData)
+{
+    uint16_t info = identifyData[IdentifySectorSize];
+
+    if (((info & SectorSizeValidMask) != SectorSizeValid) ||
+        ((info & SectorSizeLongLogical) == 0))
+    {
+        return DefaultSectorSizePow2;
+    }
+
+    uint32_t sectorWords = static_cast<uint32_t>(identifyData[IdentifyLogicalSectorWords]) |
+                           (static_cast<uint32_t>(identifyData[IdentifyLogicalSectorWords + 1]) << 16);
+    uint32_t sectorSize = sectorWords * 2;
+
+    for (uint8_t pow2 = DefaultSectorSizePow2; pow2 <= MaxSectorSizePow2; ++pow2)
+    {
+        if (sectorSize == (1u << pow2))
+            return pow2;
+    }
+
+    return 0;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// AtaPioDevice Member Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Determines whether a hard disk was found.
+bool AtaPioDevice::isValid() const { return _sectorsPerBlock != 0; }
+
+//! @brief Gets the channel the disk is attached to.
+AtaChannel &AtaPioDevice::getChannel() { return _channel; }
+
+//! @brief Gets the size of the logical sectors of the disk as a power of 2.
+uint8_t AtaPioDevice::getSectorSizePow2() const { return _sectorSizePow2; }
+
+//! @brief Gets the count of sectors transferred per status poll.
+uint8_t AtaPioDevice::getSectorsPerBlock() const { return _sectorsPerBlock; }
+
+//! @brief Determines whether data is read 32 bits at a time.
+bool AtaPioDevice::isDoublewordIo() const { return _isDoublewordIo; }
+
+//! @brief Attempts to find a hard disk at a specific position and configure
+//! it to transfer as many sectors as possible per data request.
+//! @param[in] basePort The first port of the channel's command block.
+//! @param[in] controlPort The port of the channel's device control register.
+//! @param[in] device 0 for the master device, 1 for the slave.
+//! @param[in] sectorSizePow2 The size of the sectors to read in, as a power
+//! of 2, which can't be smaller than the logical sectors of the disk.
+//! @retval true A hard disk which supports 48-bit addressing was found.
+//! @retval false There was no suitable device at the position.
+bool AtaPioDevice::initialise(uint16_t basePort, uint16_t controlPort, uint8_t device,
+                              uint8_t sectorSizePow2)
+{
+    uint16_t identifyData[AtaChannel::IdentifyWordCount];
+
+    _sectorsPerBlock = 0;
+    _device = device;
+    _isDoublewordIo = false;
+
+    if ((_channel.initialise(basePort, controlPort) == false) ||
+        (_channel.identify(device, identifyData) != AtaDeviceType::Ata) ||
+        ((identifyData[IdentifyCommandSets] & CommandSetLba48) == 0))
+    {
+        return false;
+    }
+
+    _sectorSizePow2 = getLogicalSectorSizePow2(identifyData);
+
+    if ((_sectorSizePow2 == 0) || (sectorSizePow2 < _sectorSizePow2))
+        return false;
+
+    _sectorShift = sectorSizePow2 - _sectorSizePow2;
+
+    // SET MULTIPLE MODE only accepts powers of 2, so use the largest which
+    // doesn't exceed the limit of the device.
+    uint8_t maxMultiple = static_cast<uint8_t>(identifyData[IdentifyMaxMultiple]);
+    uint8_t multiple = 0x80;
+
+    while (multiple > maxMultiple)
+    {
+        multiple >>= 1;
+    }
+
+    if ((multiple != 0) && setMultipleMode(multiple))
+    {
+        _sectorsPerBlock = multiple;
+        _readCommand = ReadMultipleExtCommand;
+    }
+    else
+    {
+        // Fall back to a data request per sector.
+        _sectorsPerBlock = 1;
+        _readCommand = ReadSectorsExtCommand;
+    }
+
+    _isDoublewordIo = probeDoublewordIo(identifyData);
+
+    return true;
+}
+
+//! @brief Reads sectors from the disk.
+//! @param[in] destination The memory to receive the sectors.
+//! @param[in] startSector The index of the first sector to read, in the
+//! sector size passed to initialise().
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @return The count of whole sectors read.
+uint32_t AtaPioDevice::read(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    uint8_t *target = static_cast<uint8_t *>(destination);
+    uint32_t sectorsRead = 0;
+
+    if (isValid() == false)
+        return 0;
+
+    // Work in the logical sectors of the disk.
+    if (sectorCount > (UINT32_MAX >> _sectorShift))
+    {
+        sectorCount = UINT32_MAX >> _sectorShift;
+    }
+
+    startSector <<= _sectorShift;
+    sectorCount <<= _sectorShift;
+
+    while (sectorsRead < sectorCount)
+    {
+        uint64_t sector = startSector + sectorsRead;
+
+        if ((sector >> Lba48Bits) != 0)
+            break;
+
+        uint32_t count = sectorCount - sectorsRead;
+
+        if (count > MaxSectorsPerCommand)
+        {
+            count = MaxSectorsPerCommand;
+        }
+
+        uint32_t readCount = readRun(target, sector, count);
+
+        sectorsRead += readCount;
+        target += static_cast<size_t>(readCount) << _sectorSizePow2;
+
+        if (readCount < count)
+            break;
+    }
+
+    return sectorsRead >> _sectorShift;
+}
+
+//! @brief Sets the count of sectors the disk transfers per data request
+//! in response to READ MULTIPLE commands.
+//! @retval true The disk accepted the block size.
+//! @retval false The disk rejected the block size or timed out.
+bool AtaPioDevice::setMultipleMode(uint8_t sectorsPerBlock)
+{
+    if (_channel.selectDevice(_device) == false)
+        return false;
+
+    _channel.writeRegister(AtaRegister::SectorCount, sectorsPerBlock);
+    _channel.issueCommand(SetMultipleModeCommand);
+
+    return _channel.waitForCompletion();
+}
+
+//! @brief Determines whether the controller passes 32-bit accesses to the
+//! data register through to the disk by reading the identify data again.
+//! @param[in] identifyData The identify data read 16 bits at a time.
+//! @retval true Reading 32 bits at a time returns the same data.
+//! @retval false Data must be read 16 bits at a time.
+bool AtaPioDevice::probeDoublewordIo(const uint16_t *identifyData)
+{
+    uint16_t probeData[AtaChannel::IdentifyWordCount];
+
+    if (_channel.selectDevice(_device) == false)
+        return false;
+
+    _channel.issueCommand(IdentifyDeviceCommand);
+
+    if (_channel.waitForData() == false)
+        return false;
+
+    _channel.readDataDoublewords(probeData, AtaChannel::IdentifyWordCount / 2);
+
+    // A controller which splits the accesses may have left words unread,
+    // which must be drained before the disk accepts another command.
+    for (uint32_t i = 0; (i < AtaChannel::IdentifyWordCount) &&
+                         (_channel.getAlternateStatus() & AtaChannel::StatusDataRequest); ++i)
+    {
+        uint16_t discard;
+
+        _channel.readData(&discard, 1);
+    }
+
+    for (uint32_t i = 0; i < AtaChannel::IdentifyWordCount; ++i)
+    {
+        if (probeData[i] != identifyData[i])
+            return false;
+    }
+
+    return true;
+}
+
+//! @brief Reads a run of sectors using a single read command.
+//! @return The count of whole sectors transferred.
+uint32_t AtaPioDevice::readRun(uint8_t *destination, uint64_t startSector,
+                               uint32_t sectorCount)
+{
+    if (_channel.selectDevice(_device) == false)
+        return 0;
+
+    _channel.setLba48(startSector, sectorCount);
+    _channel.issueCommand(_readCommand);
+
+    uint32_t sectorsRead = 0;
+
+    // The disk raises DRQ once per block, the last of which may be short.
+    // It stops raising it if an error occurs, so only sectors received are
+    // counted.
+    while ((sectorsRead < sectorCount) && _channel.waitForData())
+    {
+        uint32_t blockSectors = sectorCount - sectorsRead;
+
+        if (blockSectors > _sectorsPerBlock)
+        {
+            blockSectors = _sectorsPerBlock;
+        }
+
+        readBlock(destination + (static_cast<size_t>(sectorsRead) << _sectorSizePow2),
+                  blockSectors << _sectorSizePow2);
+        sectorsRead += blockSectors;
+    }
+
+    if (sectorsRead == sectorCount)
+    {
+        // Let the disk go idle before the next command is issued.
+        _channel.waitForCompletion();
+    }
+
+    return sectorsRead;
+}
+
+//! @brief Reads the data of a block of sectors from the data register.
+void AtaPioDevice::readBlock(uint8_t *destination, uint32_t byteCount)
+{
+    if (_isDoublewordIo)
+    {
+        _channel.readDataDoublewords(destination, byteCount / 4);
+    }
+    else
+    {
+        _channel.readData(destination, byteCount / 2);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,78 @@
+//! @file AtaPioDevice.hpp
+//! @brief The declaration of an object which reads from an ATA hard disk
+//! using programmed I/O.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_ATA_PIO_DEVICE_HPP__
+#define __BOOT_ATA_PIO_DEVICE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include "AtaChannel.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which reads from an ATA hard disk using 48-bit LBA
+//! READ MULTIPLE EXT commands, so that each status poll transfers a whole
+//! block of sectors, without switching to real mode.
+class AtaPioDevice
+{
+public:
+    // Construction/Destruction
+    //! @brief Constructs an object which must be initialised before use.
+    constexpr AtaPioDevice() :
+        _device(0),
+        _sectorSizePow2(0),
+        _sectorShift(0),
+        _sectorsPerBlock(0),
+        _readCommand(0),
+        _isDoublewordIo(false)
+    {
+    }
+
+    // Accessors
+    bool isValid() const;
+    AtaChannel &getChannel();
+    uint8_t getSectorSizePow2() const;
+    uint8_t getSectorsPerBlock() const;
+    bool isDoublewordIo() const;
+
+    // Operations
+    bool initialise(uint16_t basePort, uint16_t controlPort, uint8_t device,
+                    uint8_t sectorSizePow2);
+    uint32_t read(void *destination, uint64_t startSector, uint32_t sectorCount);
+
+private:
+    // Internal Functions
+    bool setMultipleMode(uint8_t sectorsPerBlock);
+    bool probeDoublewordIo(const uint16_t *identifyData);
+    uint32_t readRun(uint8_t *destination, uint64_t startSector, uint32_t sectorCount);
+    void readBlock(uint8_t *destination, uint32_t byteCount);
+
+    // Internal Fields
+    AtaChannel _channel;
+    uint8_t _device;
+    uint8_t _sectorSizePow2;
+    uint8_t _sectorShift;
+    uint8_t _sectorsPerBlock;
+    uint8_t _readCommand;
+    bool _isDoublewordIo;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,153 @@
+//! @file AtapiDevice.cpp
+//! @brief The definition of an object which reads from an ATAPI CD/DVD
+//! drive using programmed I/O.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "AtapiDevice.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The largest count of bytes the device is asked to transfer per
+//! data request, a whole number of sectors below 64 KB.
+constexpr uint16_t MaxBytesPerRequest = 0xF800;
+
+//! @brief The most sectors read by a single command, which bounds the time
+//! spent polling for its completion.
+constexpr uint32_t MaxSectorsPerCommand = 256;
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// AtapiDevice Member Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Determines whether a CD/DVD drive was found.
+bool AtapiDevice::isValid() const { return _isValid; }
+
+//! @brief Gets the channel the drive is attached to.
+AtaChannel &AtapiDevice::getChannel() { return _channel; }
+
+//! @brief Attempts to find a CD/DVD drive at a specific position.
+//! @param[in] basePort The first port of the channel's command block.
+//! @param[in] controlPort The port of the channel's device control register.
+//! @param[in] device 0 for the master device, 1 for the slave.
+//! @retval true A CD/DVD drive which accepts 12-byte packets was found.
+//! @retval false There was no suitable device at the position.
+bool AtapiDevice::initialise(uint16_t basePort, uint16_t controlPort, uint8_t device)
+{
+    uint16_t identifyData[AtaChannel::IdentifyWordCount];
+
+    _isValid = false;
+    _device = device;
+
+    if ((_channel.initialise(basePort, controlPort) == false) ||
+        (_channel.identify(device, identifyData) != AtaDeviceType::Atapi))
+    {
+        return false;
+    }
+
+    _isValid = AtaChannel::isCdRomDrive(identifyData);
+
+    return _isValid;
+}
+
+//! @brief Reads 2 KB sectors from the drive.
+//! @param[in] destination The memory to receive the sectors.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @return The count of sectors read.
+uint32_t AtapiDevice::read(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    uint8_t *target = static_cast<uint8_t *>(destination);
+    uint32_t sectorsRead = 0;
+
+    if (_isValid == false)
+        return 0;
+
+    while (sectorsRead < sectorCount)
+    {
+        uint64_t sector = startSector + sectorsRead;
+
+        // READ(12) only addresses 32-bit logical blocks.
+        if (sector > UINT32_MAX)
+            break;
+
+        uint32_t count = sectorCount - sectorsRead;
+
+        if (count > MaxSectorsPerCommand)
+        {
+            count = MaxSectorsPerCommand;
+        }
+
+        uint32_t readCount = readRun(target, static_cast<uint32_t>(sector), count);
+
+        sectorsRead += readCount;
+        target += static_cast<size_t>(readCount) << SectorSizePow2;
+
+        if (readCount < count)
+            break;
+    }
+
+    return sectorsRead;
+}
+
+//! @brief Reads a run of sectors using a single READ(12) command.
+//! @return The count of whole sectors transferred.
+uint32_t AtapiDevice::readRun(uint8_t *destination, uint32_t startSector,
+                              uint32_t sectorCount)
+{
+    uint8_t packet[AtaChannel::PacketSize];
+
+    AtaChannel::createRead12Packet(packet, startSector, sectorCount);
+
+    if (_channel.sendPacket(_device, packet, MaxBytesPerRequest, false) == false)
+        return 0;
+
+    const uint32_t expectedBytes = sectorCount << SectorSizePow2;
+    uint32_t bytesRead = 0;
+
+    // The device raises DRQ for each block of data it has ready and reports
+    // any error once it stops, so only whole sectors received are counted.
+    while (_channel.waitForData())
+    {
+        uint32_t blockSize = _channel.readRegister(AtaRegister::LbaMid) |
+                             (_channel.readRegister(AtaRegister::LbaHigh) << 8);
+        uint32_t wordCount = (blockSize + 1) / 2;
+
+        if (blockSize == 0)
+            break;
+
+        if ((bytesRead + blockSize) > expectedBytes)
+        {
+            // Drain anything unexpected so that the device can complete.
+            uint16_t discard;
+
+            for (uint32_t i = 0; i < wordCount; ++i)
+            {
+                _channel.readData(&discard, 1);
+            }
+
+            continue;
+        }
+
+        _channel.readData(destination + bytesRead, wordCount);
+        bytesRead += blockSize;
+    }
+
+    return bytesRead >> SectorSizePow2;
+}
+
+///////////////////////////////////////////////////////////////////////////////
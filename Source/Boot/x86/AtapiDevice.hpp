@@ -0,0 +1,66 @@
+//! @file AtapiDevice.hpp
+//! @brief The declaration of an object which reads from an ATAPI CD/DVD
+//! drive using programmed I/O.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_ATAPI_DEVICE_HPP__
+#define __BOOT_ATAPI_DEVICE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include "AtaChannel.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which reads 2 KB sectors from an ATAPI CD/DVD drive by
+//! issuing SCSI READ(12) commands, without switching to real mode.
+class AtapiDevice
+{
+public:
+    // Public Constants
+    //! @brief The size of the sectors read, as a power of 2.
+    static constexpr uint8_t SectorSizePow2 = 11;
+
+    // Construction/Destruction
+    //! @brief Constructs an object which must be initialised before use.
+    constexpr AtapiDevice() :
+        _device(0),
+        _isValid(false)
+    {
+    }
+
+    // Accessors
+    bool isValid() const;
+    AtaChannel &getChannel();
+
+    // Operations
+    bool initialise(uint16_t basePort, uint16_t controlPort, uint8_t device);
+    uint32_t read(void *destination, uint64_t startSector, uint32_t sectorCount);
+
+private:
+    // Internal Functions
+    uint32_t readRun(uint8_t *destination, uint32_t startSector, uint32_t sectorCount);
+
+    // Internal Fields
+    AtaChannel _channel;
+    uint8_t _device;
+    bool _isValid;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
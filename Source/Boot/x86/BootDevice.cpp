@@ -0,0 +1,421 @@
+//! @file BootDevice.cpp
+//! @brief The definition of functions which choose how the 32-bit loader
+//! reads from the boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "AhciDevice.hpp"
+#include "AtaPioDevice.hpp"
+#include "AtapiDevice.hpp"
+#include "BootDevice.hpp"
+#include "IdeDmaDevice.hpp"
+#include "Loader.hpp"
+#include "LoaderMemory.hpp"
+#include "VirtioBlockDevice.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data Type Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Describes a position at which a legacy ATA device can be attached.
+struct AtaPosition
+{
+    uint16_t BasePort;
+    uint16_t ControlPort;
+    uint8_t Device;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Set to skip the drivers which are otherwise preferred to ATA PIO,
+//! so that it can be exercised on machines which support them.
+#ifdef BOOT_FORCE_ATA_PIO
+constexpr bool IsAtaPioForced = true;
+#else
+constexpr bool IsAtaPioForced = false;
+#endif
+
+//! @brief The positions of devices on the legacy primary and secondary
+//! channels, in the order they are probed.
+constexpr AtaPosition LegacyAtaPositions[] = {
+    { AtaChannel::PrimaryBasePort, AtaChannel::PrimaryControlPort, 0 },
+    { AtaChannel::PrimaryBasePort, AtaChannel::PrimaryControlPort, 1 },
+    { AtaChannel::SecondaryBasePort, AtaChannel::SecondaryControlPort, 0 },
+    { AtaChannel::SecondaryBasePort, AtaChannel::SecondaryControlPort, 1 },
+};
+
+//! @brief The SATA hard disk or CD/DVD drive read through an AHCI controller.
+AhciDevice ahciDevice;
+
+//! @brief The hard disk read using programmed I/O.
+AtaPioDevice ataPioDevice;
+
+//! @brief The CD/DVD drive read using programmed I/O.
+AtapiDevice atapiDevice;
+
+//! @brief The hard disk or CD/DVD drive read using bus master DMA.
+IdeDmaDevice ideDmaDevice;
+
+//! @brief The virtual disk holding an image of the boot media.
+VirtioBlockDevice virtioBlockDevice;
+
+//! @brief The driver which services reads submitted to a driver which can
+//! only read synchronously.
+ReadBootSectorsFn synchronousReader = nullptr;
+
+//! @brief The result of the last read submitted to synchronousReader.
+uint32_t synchronousSectorsRead = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Reads sectors from the boot media through a virtio block device.
+uint32_t readVirtioSectors(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    return virtioBlockDevice.read(destination, startSector, sectorCount);
+}
+
+//! @brief Reads sectors from the boot device through an AHCI controller.
+uint32_t readAhciSectors(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    return ahciDevice.read(destination, startSector, sectorCount);
+}
+
+//! @brief Reads sectors from the boot hard disk using programmed I/O.
+uint32_t readAtaPioSectors(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    return ataPioDevice.read(destination, startSector, sectorCount);
+}
+
+//! @brief Reads sectors from the boot CD/DVD drive using programmed I/O.
+uint32_t readAtapiSectors(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    return atapiDevice.read(destination, startSector, sectorCount);
+}
+
+//! @brief Reads sectors from the boot device using bus master DMA.
+uint32_t readIdeDmaSectors(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    return ideDmaDevice.read(destination, startSector, sectorCount);
+}
+
+//! @brief Starts an asynchronous read from the boot device using bus master
+//! DMA.
+bool submitIdeDmaRead(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    return ideDmaDevice.submitRead(destination, startSector, sectorCount);
+}
+
+//! @brief Advances an asynchronous read using bus master DMA.
+bool pollIdeDmaRead() { return ideDmaDevice.poll(); }
+
+//! @brief Finishes an asynchronous read using bus master DMA.
+uint32_t waitIdeDmaRead() { return ideDmaDevice.wait(); }
+
+//! @brief Performs a read submitted to a driver which can only read
+//! synchronously, so that it has finished before it is polled.
+bool submitSynchronousRead(void *destination, uint64_t startSector,
+                           uint32_t sectorCount)
+{
+    synchronousSectorsRead = synchronousReader(destination, startSector, sectorCount);
+
+    return true;
+}
+
+//! @brief Polls a read which has already finished.
+bool pollSynchronousRead() { return true; }
+
+//! @brief Gets the result of a read which has already finished.
+uint32_t waitSynchronousRead() { return synchronousSectorsRead; }
+
+//! @brief Writes a null-terminated string to the emulator debug console.
+void writeDebugString(const char *text)
+{
+    size_t length = 0;
+
+    while (text[length] != '\0')
+    {
+        ++length;
+    }
+
+    writeDebugText(text, length);
+}
+
+//! @brief Determines whether a native reader returns the same boot sector as
+//! the BIOS, and so is reading the boot media.
+//! @param[in] device The description of the boot device.
+//! @param[in] reader The native function to test.
+//! @param[in] expected The boot sector as read by the BIOS.
+//! @param[in] actual Memory to read the boot sector into using \p reader.
+bool readsBootMedia(const BootDeviceInfo &device, ReadBootSectorsFn reader,
+                    const uint8_t *expected, uint8_t *actual)
+{
+    if (reader(actual, device.BootSector, 1) != 1)
+        return false;
+
+    size_t sectorSize = static_cast<size_t>(1) << device.SectorSizePow2;
+
+    for (size_t i = 0; i < sectorSize; ++i)
+    {
+        if (expected[i] != actual[i])
+            return false;
+    }
+
+    return true;
+}
+
+//! @brief Re-enables interrupts on a channel which was probed but won't be
+//! used natively, as the BIOS relies on them.
+void releaseChannel(AtaChannel &channel)
+{
+    if (channel.isValid())
+    {
+        channel.setInterruptsEnabled(true);
+    }
+}
+
+//! @brief Gets the type of ATA device which could hold the boot media.
+AtaDeviceType getBootAtaDeviceType(const BootDeviceInfo &device)
+{
+    switch (device.DeviceType)
+    {
+    case BootDeviceType::CdRom: return AtaDeviceType::Atapi;
+    case BootDeviceType::HardDisk: return AtaDeviceType::Ata;
+    default: return AtaDeviceType::None;
+    }
+}
+
+//! @brief Attempts to find a virtio block device holding the boot media.
+//! @details
+//! The device can hold an image of a CD/DVD as well as of a hard disk, as
+//! its sectors are read in whatever size the boot device uses.
+//! @retval true The virtio driver can read the boot media.
+//! @retval false No device holding the boot media was found.
+bool selectVirtioDriver(const BootDeviceInfo &device, const uint8_t *expected,
+                        uint8_t *actual)
+{
+    PciScanner scanner;
+    PciAddress address;
+
+    while (scanner.findNextDevice(VirtioBlockDevice::VendorId,
+                                  VirtioBlockDevice::LegacyBlockDeviceId, address))
+    {
+        if (virtioBlockDevice.initialise(address, device.SectorSizePow2) &&
+            readsBootMedia(device, readVirtioSectors, expected, actual))
+        {
+            return true;
+        }
+
+        // Stop the device using the shared queue before the next is tried.
+        virtioBlockDevice.reset();
+    }
+
+    return false;
+}
+
+//! @brief Attempts to find the boot device on the ports of the AHCI
+//! controllers.
+//! @retval true The AHCI driver can read the boot media.
+//! @retval false No device holding the boot media was found.
+bool selectAhciDriver(const BootDeviceInfo &device, const uint8_t *expected,
+                      uint8_t *actual)
+{
+    AtaDeviceType wantedType = getBootAtaDeviceType(device);
+
+    if (wantedType == AtaDeviceType::None)
+        return false;
+
+    PciScanner scanner;
+    PciAddress controller;
+
+    while (scanner.findNext(PciClassMassStorage, PciSubClassSata, controller))
+    {
+        uint32_t ports = AhciDevice::getImplementedPorts(controller);
+
+        for (uint32_t port = 0; port < AhciDevice::MaxPortCount; ++port)
+        {
+            if (((ports & (1u << port)) == 0) ||
+                (ahciDevice.initialise(controller, port) == false))
+            {
+                continue;
+            }
+
+            if ((ahciDevice.getType() == wantedType) &&
+                (ahciDevice.getSectorSizePow2() == device.SectorSizePow2) &&
+                readsBootMedia(device, readAhciSectors, expected, actual))
+            {
+                return true;
+            }
+
+            ahciDevice.release();
+        }
+    }
+
+    return false;
+}
+
+//! @brief Attempts to find the boot device on the PCI IDE controllers which
+//! support bus master DMA.
+//! @retval true The DMA driver can read the boot media.
+//! @retval false No device holding the boot media was found.
+bool selectIdeDmaDriver(const BootDeviceInfo &device, const uint8_t *expected,
+                        uint8_t *actual)
+{
+    AtaDeviceType wantedType = getBootAtaDeviceType(device);
+
+    if (wantedType == AtaDeviceType::None)
+        return false;
+
+    PciScanner scanner;
+    PciAddress controller;
+
+    while (scanner.findNext(PciClassMassStorage, PciSubClassIde, controller))
+    {
+        for (uint8_t position = 0; position < 4; ++position)
+        {
+            if (ideDmaDevice.initialise(controller, position >> 1, position & 1) &&
+                (ideDmaDevice.getType() == wantedType) &&
+                (ideDmaDevice.getSectorSizePow2() == device.SectorSizePow2) &&
+                readsBootMedia(device, readIdeDmaSectors, expected, actual))
+            {
+                return true;
+            }
+
+            releaseChannel(ideDmaDevice.getChannel());
+        }
+    }
+
+    return false;
+}
+
+//! @brief Attempts to find the boot CD/DVD drive on the legacy ATA channels.
+//! @retval true The ATAPI driver can read the boot media.
+//! @retval false No drive holding the boot media was found.
+bool selectAtapiDriver(const BootDeviceInfo &device, const uint8_t *expected,
+                       uint8_t *actual)
+{
+    if ((device.DeviceType != BootDeviceType::CdRom) ||
+        (device.SectorSizePow2 != AtapiDevice::SectorSizePow2))
+    {
+        return false;
+    }
+
+    for (const AtaPosition &position : LegacyAtaPositions)
+    {
+        if (atapiDevice.initialise(position.BasePort, position.ControlPort,
+                                   position.Device) &&
+            readsBootMedia(device, readAtapiSectors, expected, actual))
+        {
+            return true;
+        }
+
+        releaseChannel(atapiDevice.getChannel());
+    }
+
+    return false;
+}
+
+//! @brief Attempts to find the boot hard disk on the legacy ATA channels.
+//! @details
+//! The disk can hold an image of a CD/DVD as well as of a hard disk, as its
+//! sectors are read in whatever size the boot device uses.
+//! @retval true The ATA PIO driver can read the boot media.
+//! @retval false No disk holding the boot media was found.
+bool selectAtaPioDriver(const BootDeviceInfo &device, const uint8_t *expected,
+                        uint8_t *actual)
+{
+    if (getBootAtaDeviceType(device) == AtaDeviceType::None)
+        return false;
+
+    for (const AtaPosition &position : LegacyAtaPositions)
+    {
+        if (ataPioDevice.initialise(position.BasePort, position.ControlPort,
+                                    position.Device, device.SectorSizePow2) &&
+            readsBootMedia(device, readAtaPioSectors, expected, actual))
+        {
+            return true;
+        }
+
+        releaseChannel(ataPioDevice.getChannel());
+    }
+
+    return false;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// Stand-Alone Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+const char *selectBootDriver(BootInfo *boot, void *scratch)
+{
+    BootDeviceInfo &device = *boot->DeviceInfo;
+    const char *name = "EBIOS";
+
+    // Read the boot sector through the BIOS before touching any hardware,
+    // then try the fastest drivers first.
+    uint8_t *expected = static_cast<uint8_t *>(scratch);
+    uint8_t *actual = expected + (static_cast<size_t>(1) << device.SectorSizePow2);
+
+    if (device.ReadBootSectors(expected, device.BootSector, 1) == 1)
+    {
+        if ((IsAtaPioForced == false) && selectVirtioDriver(device, expected, actual))
+        {
+            device.ReadBootSectors = readVirtioSectors;
+            name = "virtio-blk";
+        }
+        else if ((IsAtaPioForced == false) && selectAhciDriver(device, expected, actual))
+        {
+            device.ReadBootSectors = readAhciSectors;
+            name = "AHCI";
+        }
+        else if ((IsAtaPioForced == false) && selectIdeDmaDriver(device, expected, actual))
+        {
+            device.ReadBootSectors = readIdeDmaSectors;
+            device.SubmitRead = submitIdeDmaRead;
+            device.PollRead = pollIdeDmaRead;
+            device.WaitRead = waitIdeDmaRead;
+            name = "IDE bus master DMA";
+        }
+        else if (selectAtaPioDriver(device, expected, actual))
+        {
+            device.ReadBootSectors = readAtaPioSectors;
+            name = ataPioDevice.isDoublewordIo() ? "ATA PIO (32-bit)" : "ATA PIO";
+        }
+        else if (selectAtapiDriver(device, expected, actual))
+        {
+            device.ReadBootSectors = readAtapiSectors;
+            name = "ATAPI PIO";
+        }
+    }
+
+    if (device.SubmitRead == nullptr)
+    {
+        // Emulate asynchronous reads so that callers can overlap work with
+        // reads from drivers which support them.
+        synchronousReader = device.ReadBootSectors;
+        device.SubmitRead = submitSynchronousRead;
+        device.PollRead = pollSynchronousRead;
+        device.WaitRead = waitSynchronousRead;
+    }
+
+    writeDebugString("Boot device driver: ");
+    writeDebugString(name);
+    writeDebugString("\n");
+
+    return name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,43 @@
+//! @file BootDevice.hpp
+//! @brief The declaration of functions which choose how the 32-bit loader
+//! reads from the boot device.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_BOOT_DEVICE_HPP__
+#define __BOOT_BOOT_DEVICE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+struct BootInfo;
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Replaces the EBIOS boot device reader with a native driver, which
+//! doesn't need to switch to real mode, if one can be found which reads the
+//! same media.
+//! @param[in] boot The boot information. Its DeviceInfo::ReadBootSectors
+//! field is updated if a native driver is selected. The SubmitRead, PollRead
+//! and WaitRead fields are always set, emulating asynchronous reads with
+//! synchronous ones if the driver selected can't overlap them with other work.
+//! @param[in] scratch Memory in which to read two sectors while checking
+//! candidate drivers.
+//! @return The name of the driver now in use.
+const char *selectBootDriver(BootInfo *boot, void *scratch);
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
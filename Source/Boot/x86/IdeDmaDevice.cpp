@@ -0,0 +1,504 @@
+//! @file IdeDmaDevice.cpp
+//! @brief The definition of an object which reads from an ATA or ATAPI
+//! device using the bus master DMA engine of a PCI IDE controller.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "IdeDmaDevice.hpp"
+#include "Interrupts.hpp"
+#include "Loader_x86.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data Type Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief A physical region descriptor which describes one run of memory
+//! the bus master transfers data to.
+struct PrdEntry
+{
+    //! @brief The physical address of the run, which must be even.
+    uint32_t Address;
+
+    //! @brief The count of bytes in the run, 0 for 64 KB.
+    uint16_t ByteCount;
+
+    //! @brief Flags, only PrdEndOfTable is defined.
+    uint16_t Flags;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The offsets of the bus master registers of a channel.
+constexpr uint16_t BusMasterCommand = 0;
+constexpr uint16_t BusMasterStatus = 2;
+constexpr uint16_t BusMasterTableAddress = 4;
+
+constexpr uint8_t BusMasterStart = 0x01;
+constexpr uint8_t BusMasterWriteToMemory = 0x08;
+
+constexpr uint8_t BusMasterActive = 0x01;
+constexpr uint8_t BusMasterError = 0x02;
+constexpr uint8_t BusMasterInterrupt = 0x04;
+
+//! @brief The bit in the programming interface which shows that the
+//! controller supports bus mastering.
+constexpr uint8_t ProgInterfaceBusMaster = 0x80;
+
+//! @brief The bit in the programming interface which shows that the primary
+//! channel uses PCI native ports, the secondary bit is 2 bits higher.
+constexpr uint8_t ProgInterfacePrimaryNative = 0x01;
+
+constexpr uint16_t PrdEndOfTable = 0x8000;
+
+//! @brief The count of descriptors in the table, enough for any run of
+//! 1.9 MB however it is aligned.
+constexpr uint32_t MaxPrdEntries = 32;
+
+//! @brief The most sectors a READ DMA EXT command can transfer.
+constexpr uint32_t MaxAtaSectorsPerCommand = 0x10000;
+
+constexpr uint8_t ReadDmaExtCommand = 0x25;
+
+//! @brief The count of times to poll a read which isn't progressing before
+//! giving up.
+constexpr uint32_t PollLimit = 0x400000;
+
+//! @brief The identify word and bit which show DMA is supported.
+constexpr uint32_t IdentifyCapabilities = 49;
+constexpr uint16_t CapabilityDma = 0x0100;
+
+//! @brief The identify word and bit which show 48-bit addressing is supported.
+constexpr uint32_t IdentifyCommandSets = 83;
+constexpr uint16_t CommandSetLba48 = 0x0400;
+
+//! @brief The physical region descriptor table. Its size and alignment stop
+//! it crossing a 64 KB boundary, which the bus master can't handle.
+alignas(sizeof(PrdEntry) * MaxPrdEntries) PrdEntry prdTable[MaxPrdEntries];
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Fills the descriptor table to cover as much of a destination as
+//! possible.
+//! @param[in] destination The physical address of the memory to fill.
+//! @param[in] byteCount The count of bytes to transfer.
+//! @return The count of bytes the table covers.
+uint32_t buildPrdTable(uintptr_t destination, uint32_t byteCount)
+{
+    uint32_t covered = 0;
+    uint32_t index = 0;
+
+    while ((covered < byteCount) && (index < MaxPrdEntries))
+    {
+        // A region must not cross a 64 KB boundary.
+        uint32_t length = 0x10000 - static_cast<uint32_t>(destination & 0xFFFF);
+
+        if (length > (byteCount - covered))
+        {
+            length = byteCount - covered;
+        }
+
+        prdTable[index].Address = static_cast<uint32_t>(destination);
+        prdTable[index].ByteCount = static_cast<uint16_t>(length);
+        prdTable[index].Flags = 0;
+
+        destination += length;
+        covered += length;
+        ++index;
+    }
+
+    if (index > 0)
+    {
+        prdTable[index - 1].Flags = PrdEndOfTable;
+    }
+
+    return covered;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// IdeDmaDevice Member Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Determines whether a device which supports DMA was found.
+bool IdeDmaDevice::isValid() const { return _type != AtaDeviceType::None; }
+
+//! @brief Gets the type of device found.
+AtaDeviceType IdeDmaDevice::getType() const { return _type; }
+
+//! @brief Gets the size of the sectors the device reads as a power of 2.
+uint8_t IdeDmaDevice::getSectorSizePow2() const { return _sectorSizePow2; }
+
+//! @brief Gets the channel the device is attached to.
+AtaChannel &IdeDmaDevice::getChannel() { return _channel; }
+
+//! @brief Attempts to find a device supporting DMA on a PCI IDE controller.
+//! @param[in] controller The address of the IDE controller function.
+//! @param[in] channel 0 for the primary channel, 1 for the secondary.
+//! @param[in] device 0 for the master device, 1 for the slave.
+//! @retval true A hard disk supporting LBA48 or a CD/DVD drive was found.
+//! @retval false There was no suitable device at the position.
+bool IdeDmaDevice::initialise(const PciAddress &controller, uint8_t channel,
+                              uint8_t device)
+{
+    _type = AtaDeviceType::None;
+    _device = device;
+    _irq = NoIrq;
+
+    uint8_t progInterface = readPciConfig8(controller, PciConfig::ProgInterface);
+    uint32_t busMasterBar = readPciConfig32(controller, PciConfig::Bar4);
+
+    // The bus master registers must be in I/O space.
+    if (((progInterface & ProgInterfaceBusMaster) == 0) || ((busMasterBar & 1) == 0))
+        return false;
+
+    uint16_t basePort = AtaChannel::PrimaryBasePort;
+    uint16_t controlPort = AtaChannel::PrimaryControlPort;
+
+    if (progInterface & (ProgInterfacePrimaryNative << (channel * 2)))
+    {
+        PciConfig baseBar = (channel == 0) ? PciConfig::Bar0 : PciConfig::Bar2;
+        PciConfig controlBar = (channel == 0) ? PciConfig::Bar1 : PciConfig::Bar3;
+
+        basePort = static_cast<uint16_t>(readPciConfig32(controller, baseBar) & 0xFFFC);
+        controlPort = static_cast<uint16_t>((readPciConfig32(controller, controlBar) & 0xFFFC) + 2);
+    }
+    else
+    {
+        // Only channels in compatibility mode have a known IRQ.
+        _irq = (channel == 0) ? PrimaryAtaIrq : SecondaryAtaIrq;
+
+        if (channel != 0)
+        {
+            basePort = AtaChannel::SecondaryBasePort;
+            controlPort = AtaChannel::SecondaryControlPort;
+        }
+    }
+
+    enablePciFunction(controller, PciCommandIoSpace | PciCommandBusMaster);
+    _busMasterPort = static_cast<uint16_t>((busMasterBar & 0xFFFC) + (channel * 8));
+
+    uint16_t identifyData[AtaChannel::IdentifyWordCount];
+
+    if (_channel.initialise(basePort, controlPort) == false)
+        return false;
+
+    AtaDeviceType type = _channel.identify(device, identifyData);
+
+    if ((type == AtaDeviceType::None) ||
+        ((identifyData[IdentifyCapabilities] & CapabilityDma) == 0))
+    {
+        return false;
+    }
+
+    if ((type == AtaDeviceType::Ata) &&
+        (identifyData[IdentifyCommandSets] & CommandSetLba48))
+    {
+        _sectorSizePow2 = 9;
+        _type = type;
+    }
+    else if ((type == AtaDeviceType::Atapi) && AtaChannel::isCdRomDrive(identifyData))
+    {
+        _sectorSizePow2 = 11;
+        _type = type;
+    }
+
+    // The bus master only reports completion when the device raises its
+    // interrupt line, which is masked at the PICs until a read is submitted.
+    if (isValid())
+    {
+        _channel.setInterruptsEnabled(true);
+    }
+
+    return isValid();
+}
+
+//! @brief Reads sectors from the device, waiting for them to arrive.
+//! @param[in] destination The memory to receive the sectors, which must be
+//! 2-byte aligned.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @return The count of sectors read.
+uint32_t IdeDmaDevice::read(void *destination, uint64_t startSector, uint32_t sectorCount)
+{
+    return submitRead(destination, startSector, sectorCount) ? wait() : 0;
+}
+
+//! @brief Starts reading sectors from the device without waiting for them
+//! to arrive.
+//! @param[in] destination The memory to receive the sectors, which must be
+//! 2-byte aligned and left alone until the read completes.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @retval true The read was submitted, call poll() or wait() to complete it.
+//! @retval false A read is already in progress, the parameters are invalid
+//! or the device didn't accept the first command.
+bool IdeDmaDevice::submitRead(void *destination, uint64_t startSector,
+                              uint32_t sectorCount)
+{
+    uintptr_t target = reinterpret_cast<uintptr_t>(destination);
+
+    if ((isValid() == false) || (target & 1) || _isBusy)
+        return false;
+
+    // Keep the IRQ handler out until the first run has started.
+    uint32_t flags = disableInterrupts();
+
+    _asyncTarget = target;
+    _asyncSector = startSector;
+    _asyncRemaining = sectorCount;
+    _asyncSectorsRead = 0;
+
+    if ((_irq != NoIrq) && (installIrqHandler(_irq, onIrq, this) == false))
+    {
+        _irq = NoIrq;
+    }
+
+    bool isStarted = startNextRun();
+
+    if (isStarted)
+    {
+        _isBusy = true;
+
+        if (_irq != NoIrq)
+        {
+            setIrqMasked(_irq, false);
+        }
+    }
+
+    restoreInterrupts(flags);
+
+    return isStarted;
+}
+
+//! @brief Advances the read in progress without waiting.
+//! @retval true The read has finished.
+//! @retval false The device is still transferring data.
+bool IdeDmaDevice::poll()
+{
+    uint32_t flags = disableInterrupts();
+
+    if (_isBusy && isRunComplete())
+    {
+        serviceRun();
+    }
+
+    bool isFinished = (_isBusy == false);
+    restoreInterrupts(flags);
+
+    return isFinished;
+}
+
+//! @brief Waits for the read in progress to finish.
+//! @return The count of contiguous sectors read from the start of the run
+//! submitted.
+uint32_t IdeDmaDevice::wait()
+{
+    uint32_t progress = _asyncSectorsRead;
+    uint32_t idleCount = 0;
+
+    while (poll() == false)
+    {
+        if (_asyncSectorsRead != progress)
+        {
+            progress = _asyncSectorsRead;
+            idleCount = 0;
+        }
+        else if (++idleCount >= PollLimit)
+        {
+            // The device has stopped responding, abandon the read.
+            uint32_t flags = disableInterrupts();
+
+            WriteToPort8(_busMasterPort + BusMasterCommand, 0);
+            endRead();
+            restoreInterrupts(flags);
+            break;
+        }
+    }
+
+    return _asyncSectorsRead;
+}
+
+//! @brief Advances a read when the IRQ of the channel is raised.
+void IdeDmaDevice::onIrq(void *context)
+{
+    IdeDmaDevice *device = static_cast<IdeDmaDevice *>(context);
+
+    // The IRQ may have been latched before the current run started.
+    if (device->_isBusy && device->isRunComplete())
+    {
+        device->serviceRun();
+    }
+}
+
+//! @brief Sends the command to read a run of sectors to the device.
+bool IdeDmaDevice::issueRead(uint64_t startSector, uint32_t sectorCount)
+{
+    if (_type == AtaDeviceType::Atapi)
+    {
+        uint8_t packet[AtaChannel::PacketSize];
+
+        AtaChannel::createRead12Packet(packet, static_cast<uint32_t>(startSector),
+                                       sectorCount);
+
+        return _channel.sendPacket(_device, packet, 0, true);
+    }
+
+    if (_channel.selectDevice(_device) == false)
+        return false;
+
+    _channel.setLba48(startSector, sectorCount);
+    _channel.writeRegister(AtaRegister::Command, ReadDmaExtCommand);
+
+    return true;
+}
+
+//! @brief Starts the transfer of a run of sectors into the memory described
+//! by the descriptor table.
+//! @retval true The device accepted the command.
+//! @retval false The device couldn't be given the command.
+bool IdeDmaDevice::startRun(uint64_t startSector, uint32_t sectorCount)
+{
+    // Stop the engine, point it at the table and clear the sticky status bits.
+    WriteToPort8(_busMasterPort + BusMasterCommand, 0);
+    WriteToPort32(_busMasterPort + BusMasterTableAddress,
+                  static_cast<uint32_t>(reinterpret_cast<uintptr_t>(prdTable)));
+    WriteToPort8(_busMasterPort + BusMasterStatus, BusMasterError | BusMasterInterrupt);
+    WriteToPort8(_busMasterPort + BusMasterCommand, BusMasterWriteToMemory);
+
+    if (issueRead(startSector, sectorCount) == false)
+        return false;
+
+    WriteToPort8(_busMasterPort + BusMasterCommand, BusMasterWriteToMemory | BusMasterStart);
+
+    return true;
+}
+
+//! @brief Starts the next run of the read in progress, as much as one
+//! command and one descriptor table can cover.
+//! @retval true A run was started.
+//! @retval false The read is complete or can't continue.
+bool IdeDmaDevice::startNextRun()
+{
+    uint64_t sector = _asyncSector;
+    uint32_t count = _asyncRemaining;
+
+    if (count == 0)
+        return false;
+
+    if (_type == AtaDeviceType::Atapi)
+    {
+        // READ(12) only addresses 32-bit logical blocks.
+        if (sector > UINT32_MAX)
+            return false;
+    }
+    else if (count > MaxAtaSectorsPerCommand)
+    {
+        count = MaxAtaSectorsPerCommand;
+    }
+
+    // Only read as much as one descriptor table can cover.
+    if (count > (UINT32_MAX >> _sectorSizePow2))
+    {
+        count = UINT32_MAX >> _sectorSizePow2;
+    }
+
+    uint32_t covered = buildPrdTable(_asyncTarget, count << _sectorSizePow2);
+
+    if ((covered >> _sectorSizePow2) < count)
+    {
+        count = covered >> _sectorSizePow2;
+        buildPrdTable(_asyncTarget, count << _sectorSizePow2);
+    }
+
+    if ((count == 0) || (startRun(sector, count) == false))
+        return false;
+
+    _runSectorCount = count;
+
+    return true;
+}
+
+//! @brief Determines whether the device has finished the current run,
+//! whether or not it succeeded.
+bool IdeDmaDevice::isRunComplete() const
+{
+    uint8_t busMasterStatus = ReadFromPort8(_busMasterPort + BusMasterStatus);
+
+    if (busMasterStatus & (BusMasterInterrupt | BusMasterError))
+        return true;
+
+    // Don't rely on the device raising its interrupt line.
+    uint8_t status = _channel.getAlternateStatus();
+
+    if (status & AtaChannel::StatusBusy)
+        return false;
+
+    return ((busMasterStatus & BusMasterActive) == 0) ||
+           (status & (AtaChannel::StatusError | AtaChannel::StatusDeviceFault));
+}
+
+//! @brief Stops the engine once the current run is complete.
+//! @retval true All sectors of the run were transferred.
+//! @retval false The device or the bus master reported an error.
+bool IdeDmaDevice::finishRun()
+{
+    uint8_t busMasterStatus = ReadFromPort8(_busMasterPort + BusMasterStatus);
+
+    WriteToPort8(_busMasterPort + BusMasterCommand, 0);
+    WriteToPort8(_busMasterPort + BusMasterStatus, BusMasterError | BusMasterInterrupt);
+
+    // Reading the status register rather than the alternate status also
+    // clears the interrupt line of the device.
+    uint8_t status = _channel.readRegister(AtaRegister::Command);
+    const uint8_t failureMask = AtaChannel::StatusBusy | AtaChannel::StatusError |
+                                AtaChannel::StatusDeviceFault;
+
+    // The engine is still active if the device transferred less than the
+    // descriptor table covers.
+    return ((status & failureMask) == 0) &&
+           ((busMasterStatus & (BusMasterError | BusMasterActive)) == 0);
+}
+
+//! @brief Accounts for a completed run and starts the next one, if any.
+void IdeDmaDevice::serviceRun()
+{
+    if (finishRun())
+    {
+        _asyncSectorsRead += _runSectorCount;
+        _asyncRemaining -= _runSectorCount;
+        _asyncSector += _runSectorCount;
+        _asyncTarget += static_cast<uintptr_t>(_runSectorCount) << _sectorSizePow2;
+
+        if (startNextRun())
+            return;
+    }
+
+    endRead();
+}
+
+//! @brief Marks the read in progress as finished.
+void IdeDmaDevice::endRead()
+{
+    _isBusy = false;
+    _asyncRemaining = 0;
+
+    if (_irq != NoIrq)
+    {
+        setIrqMasked(_irq, true);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,104 @@
+//! @file IdeDmaDevice.hpp
+//! @brief The declaration of an object which reads from an ATA or ATAPI
+//! device using the bus master DMA engine of a PCI IDE controller.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_IDE_DMA_DEVICE_HPP__
+#define __BOOT_IDE_DMA_DEVICE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include "AtaChannel.hpp"
+#include "Pci.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which reads from a hard disk or CD/DVD drive attached to
+//! a PCI IDE controller, such as the PIIX, using bus master DMA.
+//! @details
+//! Physical region descriptors point directly at the destination, wherever
+//! it is in the 32-bit address space, so no data is copied. The loader runs
+//! with paging disabled, so destination pointers are physical addresses.
+//!
+//! Reads can be submitted and left to complete while the caller does other
+//! work. On the legacy channels the IRQ handler starts each run of a read
+//! as soon as the last finishes, otherwise runs advance when polled.
+class IdeDmaDevice
+{
+public:
+    // Construction/Destruction
+    //! @brief Constructs an object which must be initialised before use.
+    constexpr IdeDmaDevice() :
+        _asyncTarget(0),
+        _asyncSector(0),
+        _asyncRemaining(0),
+        _asyncSectorsRead(0),
+        _runSectorCount(0),
+        _busMasterPort(0),
+        _device(0),
+        _sectorSizePow2(0),
+        _irq(NoIrq),
+        _isBusy(false),
+        _type(AtaDeviceType::None)
+    {
+    }
+
+    // Accessors
+    bool isValid() const;
+    AtaDeviceType getType() const;
+    uint8_t getSectorSizePow2() const;
+    AtaChannel &getChannel();
+
+    // Operations
+    bool initialise(const PciAddress &controller, uint8_t channel, uint8_t device);
+    uint32_t read(void *destination, uint64_t startSector, uint32_t sectorCount);
+    bool submitRead(void *destination, uint64_t startSector, uint32_t sectorCount);
+    bool poll();
+    uint32_t wait();
+
+private:
+    // Internal Constants
+    static constexpr uint8_t NoIrq = 0xFF;
+
+    // Internal Functions
+    static void onIrq(void *context);
+    bool issueRead(uint64_t startSector, uint32_t sectorCount);
+    bool startRun(uint64_t startSector, uint32_t sectorCount);
+    bool startNextRun();
+    bool isRunComplete() const;
+    bool finishRun();
+    void serviceRun();
+    void endRead();
+
+    // Internal Fields
+    AtaChannel _channel;
+    uintptr_t _asyncTarget;
+    uint64_t _asyncSector;
+    uint32_t _asyncRemaining;
+    uint32_t _asyncSectorsRead;
+    uint32_t _runSectorCount;
+    uint16_t _busMasterPort;
+    uint8_t _device;
+    uint8_t _sectorSizePow2;
+    uint8_t _irq;
+    bool _isBusy;
+    AtaDeviceType _type;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,195 @@
+//! @file Interrupts.cpp
+//! @brief The definition of functions which handle hardware IRQs in the
+//! 32-bit loader.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "Interrupts.hpp"
+#include "Loader_x86.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data Type Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The handler installed for an IRQ.
+struct IrqRoute
+{
+    IrqHandlerFn Handler;
+    void *Context;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+constexpr uint8_t IrqCount = 16;
+constexpr uint8_t IrqsPerPic = 8;
+constexpr uint8_t CascadeIrq = 2;
+
+constexpr uint16_t MasterPicCommand = 0x20;
+constexpr uint16_t MasterPicData = 0x21;
+constexpr uint16_t SlavePicCommand = 0xA0;
+constexpr uint16_t SlavePicData = 0xA1;
+
+constexpr uint8_t PicEndOfInterrupt = 0x20;
+constexpr uint8_t PicReadInService = 0x0B;
+
+//! @brief The IRQ the slave PIC raises when a request disappears before
+//! it is acknowledged.
+constexpr uint8_t SpuriousSlaveIrq = 15;
+
+//! @brief The access byte of a present, ring 0, 32-bit interrupt gate.
+constexpr uint32_t InterruptGate32 = 0x8E00;
+
+//! @brief The handlers called by dispatchHardwareIrq().
+IrqRoute irqRoutes[IrqCount];
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Gets the 32-bit code which saves state before handling an IRQ.
+//! @return The entry point or nullptr if the IRQ can't be handled natively.
+void (*getIrqEntryPoint(uint8_t irq))()
+{
+    switch (irq)
+    {
+    case PrimaryAtaIrq: return HardwareIrq14Entry;
+    case SecondaryAtaIrq: return HardwareIrq15Entry;
+    default: return nullptr;
+    }
+}
+
+//! @brief Gets a pointer to an entry in the IDT loaded by the 16-bit loader.
+uint32_t *getIdtEntry(uint8_t vector)
+{
+    uint16_t idtr[3];
+
+    __asm__ volatile("sidt %0" : "=m"(idtr));
+
+    uintptr_t base = static_cast<uintptr_t>(idtr[1]) |
+                     (static_cast<uintptr_t>(idtr[2]) << 16);
+
+    return reinterpret_cast<uint32_t *>(base + (static_cast<uintptr_t>(vector) * 8));
+}
+
+//! @brief Determines whether an IRQ 15 was raised by a real device rather
+//! than being a spurious interrupt from the slave PIC.
+bool isSlaveIrqInService(uint8_t irq)
+{
+    WriteToPort8(SlavePicCommand, PicReadInService);
+
+    return (ReadFromPort8(SlavePicCommand) & (1u << (irq - IrqsPerPic))) != 0;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// Stand-Alone Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+bool installIrqHandler(uint8_t irq, IrqHandlerFn handler, void *context)
+{
+    void (*entryPoint)() = (irq < IrqCount) ? getIrqEntryPoint(irq) : nullptr;
+
+    if ((entryPoint == nullptr) || (handler == nullptr))
+        return false;
+
+    uint32_t flags = disableInterrupts();
+
+    // Replace the 16-bit gate which halts the machine with one which enters
+    // the 32-bit code.
+    uint32_t *gate = getIdtEntry(static_cast<uint8_t>(HardwareIrqBase + irq));
+    uint32_t offset = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(entryPoint));
+
+    gate[0] = (static_cast<uint32_t>(GdtCode32) << 16) | (offset & 0xFFFF);
+    gate[1] = (offset & 0xFFFF0000) | InterruptGate32;
+
+    irqRoutes[irq].Handler = handler;
+    irqRoutes[irq].Context = context;
+
+    // Keep the IRQ away from the BIOS while Interop16 runs real mode code.
+    Loader16Env->NativeIrqMasks[irq / IrqsPerPic] |=
+        static_cast<uint8_t>(1u << (irq % IrqsPerPic));
+
+    restoreInterrupts(flags);
+
+    return true;
+}
+
+void setIrqMasked(uint8_t irq, bool isMasked)
+{
+    if (irq >= IrqCount)
+        return;
+
+    uint32_t flags = disableInterrupts();
+    uint16_t dataPort = (irq < IrqsPerPic) ? MasterPicData : SlavePicData;
+    uint8_t bit = static_cast<uint8_t>(1u << (irq % IrqsPerPic));
+    uint8_t mask = ReadFromPort8(dataPort);
+
+    mask = isMasked ? (mask | bit) : (mask & ~bit);
+    WriteToPort8(dataPort, mask);
+
+    // IRQs from the slave PIC pass through the cascade IRQ of the master.
+    if ((isMasked == false) && (irq >= IrqsPerPic))
+    {
+        mask = ReadFromPort8(MasterPicData);
+        WriteToPort8(MasterPicData, static_cast<uint8_t>(mask & ~(1u << CascadeIrq)));
+    }
+
+    restoreInterrupts(flags);
+}
+
+uint32_t disableInterrupts()
+{
+    uint32_t flags;
+
+    __asm__ volatile("pushfl\n\tpopl %0\n\tcli" : "=r"(flags) : : "memory");
+
+    return flags;
+}
+
+void restoreInterrupts(uint32_t flags)
+{
+    __asm__ volatile("pushl %0\n\tpopfl" : : "r"(flags) : "memory", "cc");
+}
+
+//! @brief Calls the handler for a hardware IRQ then acknowledges it, called
+//! from the entry points in Entry32.S.
+//! @param[in] irq The IRQ raised.
+extern "C" void dispatchHardwareIrq(uint32_t irq)
+{
+    if (irq >= IrqCount)
+        return;
+
+    if ((irq == SpuriousSlaveIrq) && (isSlaveIrqInService(SpuriousSlaveIrq) == false))
+    {
+        // Only the master PIC saw the cascade IRQ.
+        WriteToPort8(MasterPicCommand, PicEndOfInterrupt);
+        return;
+    }
+
+    const IrqRoute &route = irqRoutes[irq];
+
+    if (route.Handler != nullptr)
+    {
+        route.Handler(route.Context);
+    }
+
+    if (irq >= IrqsPerPic)
+    {
+        WriteToPort8(SlavePicCommand, PicEndOfInterrupt);
+    }
+
+    WriteToPort8(MasterPicCommand, PicEndOfInterrupt);
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,63 @@
+//! @file Interrupts.hpp
+//! @brief The declaration of functions which handle hardware IRQs in the
+//! 32-bit loader.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_INTERRUPTS_HPP__
+#define __BOOT_INTERRUPTS_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief A function called when a hardware IRQ handled natively is raised.
+//! @param[in] context The value passed when the handler was installed.
+//! @note Handlers run with interrupts disabled and the IRQ is acknowledged
+//! at the PICs after the handler returns.
+using IrqHandlerFn = void (*)(void *context);
+
+//! @brief The IRQ of the primary legacy ATA channel.
+constexpr uint8_t PrimaryAtaIrq = 14;
+
+//! @brief The IRQ of the secondary legacy ATA channel.
+constexpr uint8_t SecondaryAtaIrq = 15;
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Routes a hardware IRQ to a handler in 32-bit code.
+//! @param[in] irq The IRQ to handle, only the ATA IRQs 14 and 15 have entry
+//! points.
+//! @param[in] handler The function to call when the IRQ is raised.
+//! @param[in] context The value to pass to the handler.
+//! @retval true The handler was installed, the IRQ remains masked.
+//! @retval false The IRQ can't be handled in 32-bit code.
+bool installIrqHandler(uint8_t irq, IrqHandlerFn handler, void *context);
+
+//! @brief Masks or unmasks a hardware IRQ at the PICs.
+//! @note Real mode code runs with the masks the BIOS set up, except that
+//! IRQs with handlers installed by installIrqHandler() stay masked.
+void setIrqMasked(uint8_t irq, bool isMasked);
+
+//! @brief Disables interrupts, returning the previous state of the flags.
+uint32_t disableInterrupts();
+
+//! @brief Restores the interrupt flag to a state returned by
+//! disableInterrupts().
+void restoreInterrupts(uint32_t flags);
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,105 @@
+//! @file LoaderMemory.cpp
+//! @brief The definition of the C++ dynamic memory operators which allocate
+//! from the boot-time heap in the 32-bit loader.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "BootUtils.hpp"
+#include "Loader.hpp"
+#include "LoaderMemory.hpp"
+#include "Loader_x86.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The heap which services operator new and delete.
+Heap *loaderHeap = nullptr;
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Allocates a block for operator new, halting the machine if there
+//! is no memory as the loader has no exceptions to throw.
+void *allocateOrHalt(size_t size)
+{
+    void *block = (loaderHeap == nullptr) ? nullptr :
+                  loaderHeap->allocateBlock((size == 0) ? 1 : size);
+
+    while (block == nullptr)
+    {
+        __asm__ volatile("cli\n\thlt");
+    }
+
+    return block;
+}
+
+//! @brief Returns a block allocated by operator new to the heap.
+void freeBlock(void *block)
+{
+    if (loaderHeap != nullptr)
+    {
+        loaderHeap->freeBlock(block);
+    }
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// Stand-Alone Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+void setLoaderHeap(Heap *heap) { loaderHeap = heap; }
+
+Heap *getLoaderHeap() { return loaderHeap; }
+
+void writeDebugText(const char *text, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        WriteToPort8(DebugOutputPort, static_cast<uint8_t>(text[i]));
+    }
+}
+
+void publishHeapStats(BootInfo *boot)
+{
+    boot->HeapUsage = nullptr;
+
+#ifdef BOOT_HEAP_STATS
+    if (loaderHeap == nullptr)
+        return;
+
+    // Take the snapshot from the arena so that it survives until after boot.
+    HeapStats *stats = static_cast<HeapStats *>(loaderHeap->allocate(sizeof(HeapStats)));
+
+    if ((stats != nullptr) && loaderHeap->getStats(*stats))
+    {
+        dumpHeapStats(*stats, writeDebugText);
+        boot->HeapUsage = stats;
+    }
+#endif
+}
+
+void *operator new(size_t size) { return allocateOrHalt(size); }
+
+void *operator new[](size_t size) { return allocateOrHalt(size); }
+
+void operator delete(void *block) noexcept { freeBlock(block); }
+
+void operator delete[](void *block) noexcept { freeBlock(block); }
+
+void operator delete(void *block, size_t) noexcept { freeBlock(block); }
+
+void operator delete[](void *block, size_t) noexcept { freeBlock(block); }
+
+///////////////////////////////////////////////////////////////////////////////
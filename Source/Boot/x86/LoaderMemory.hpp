@@ -0,0 +1,52 @@
+//! @file LoaderMemory.hpp
+//! @brief The declaration of functions which bind the C++ dynamic memory
+//! operators to the boot-time heap in the 32-bit loader.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_LOADER_MEMORY_HPP__
+#define __BOOT_LOADER_MEMORY_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+class Heap;
+struct BootInfo;
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Sets the heap which services operator new and delete.
+//! @param[in] heap A heap on which createPool() has been successfully called,
+//! or nullptr to make any further allocations fail.
+void setLoaderHeap(Heap *heap);
+
+//! @brief Gets the heap which services operator new and delete.
+Heap *getLoaderHeap();
+
+//! @brief Writes text to the emulator debug console.
+//! @param[in] text The characters to write.
+//! @param[in] length The count of characters in \p text.
+void writeDebugText(const char *text, size_t length);
+
+//! @brief Writes the loader heap statistics to the debug console and passes
+//! a snapshot of them on to the kernel.
+//! @param[in] boot The structure to pass the snapshot on in. Its HeapUsage
+//! field is left as nullptr if statistics are not being collected.
+void publishHeapStats(BootInfo *boot);
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
@@ -28,9 +28,21 @@
 #define Loader16BssSize 2048
 
  // TODO: Use the linker to calculate this.
-#define Loader32BssSize 2048
+#define Loader32BssSize 0x6000
 
 #define HardwareIrqBase 240
+
+/* The end of the conventional memory reserved for real-mode I/O */
+#define IOAreaEnd 0x40000
+
+/* The most disk address packets passed to ReadSectorBatch16 at once */
+#define EbiosMaxPackets 16
+
+/* The bytes at the start of the I/O segment reserved for disk address packets */
+#define EbiosPacketAreaSize 0x200
+
+/* The I/O port which emulators echo to their debug console */
+#define DebugOutputPort 0xE9
 // #define Loader32Base 0x10000
 
 //#define IsoSectorSize 2048
@@ -45,7 +57,10 @@
 
 #define Interop16Entry_Offset 68
 #define BootDeviceId_Offset (64 + 8)
+#define EddVersion_Offset (64 + 9)
+#define ReadSectorBatchEntry_Offset (64 + 10)
 #define DriveParams_Offset (64 + 12)
+#define Loader16Segment_Offset 2
 #define IOSegment_Offset 4
 #define IOLength_Offset 6
 #define DriveTotalSectors_Offset (DriveParams_Offset + 16)
@@ -58,6 +73,7 @@
 #define MemType_Reserved        2   /* See MemType::Reserved in Loader.h */
 #define MemType_UsableAfterBoot 128 /* See MemType::UsableAfterBoot in Loader.h */
 
+#define BootDeviceType_HardDisk 2
 #define BootDeviceType_Cdrom 3
 
 #define MinXmsInKb ((MinRamInMb - 1) * 1024)
@@ -114,7 +130,8 @@ struct Loader16Environment
     //! @brief A 64K-aligned segment used for real-mode I/O operations.
     uint16_t IOSegment;
 
-    uint16_t Reserved2;
+    //! @brief The length of the I/O segment in 16-byte paragraphs.
+    uint16_t IOSegmentLength;
 
     // Fields added by genisoimage using the -boot-info-table.
 
@@ -127,8 +144,23 @@ struct Loader16Environment
     //! @brief The size of the boot loader, in bytes.
     uint32_t BootFileSize;
 
+    //! @brief The checksum of the boot file added by genisoimage.
+    uint32_t BootFileChecksum;
+
+    //! @brief The protected mode IDTR and PIC masks preserved by Interop16
+    //! while it runs real mode code.
+    uint8_t InteropSaveArea[8];
+
+    //! @brief The master and slave PIC masks restored while Interop16 runs
+    //! real mode code.
+    uint8_t BiosPicMasks[2];
+
+    //! @brief The master and slave PIC mask bits of IRQs with native
+    //! handlers, which stay masked while Interop16 runs real mode code.
+    uint8_t NativeIrqMasks[2];
+
     // Pad upto 64 bytes.
-    uint32_t Reserved3[11];
+    uint32_t Reserved3[7];
 
     // Further 16-bit environment fields.
     //! @brief The size of the 16-bit loader COM file.
@@ -142,7 +174,12 @@ struct Loader16Environment
 
     //! @brief The INT13 ID of the boot device.
     uint8_t BootDeviceId;
-    uint8_t Reserved4[3];
+
+    //! @brief The EDD version reported by INT 13h Fn=41h, 0x30 for EDD 3.0.
+    uint8_t EddVersion;
+
+    //! @brief The offset into the 16-bit code of the batch sector reader.
+    uint16_t ReadSectorBatchOffset;
 
     //! @brief The parameters of the boot drive as returned by INT 13h Fn=4Ah
     uint32_t BootDriveParams[8];
@@ -154,6 +191,11 @@ struct Loader16Environment
     uint32_t MemMapEntries[5];
 };
 
+#ifdef __cplusplus
+// The following symbols are defined in assembly language.
+extern "C" {
+#endif
+
 //! @brief The pointer to the 16-bit loader environment.
 extern struct Loader16Environment *Loader16Env;
 
@@ -207,6 +249,30 @@ extern uint16_t ReadFromPort16(uint16_t port);
 //! @return The value read from the I/O port.
 extern uint32_t ReadFromPort32(uint16_t port);
 
+//! @brief Reads a block of words from a 16-bit I/O port.
+//! @param[in] port The index of the port to read from.
+//! @param[out] buffer The memory to receive the words read.
+//! @param[in] count The count of 16-bit words to read.
+extern void ReadFromPortBlock16(uint16_t port, void *buffer, uint32_t count);
+
+//! @brief Reads a block of double words from a 32-bit I/O port.
+//! @param[in] port The index of the port to read from.
+//! @param[out] buffer The memory to receive the double words read.
+//! @param[in] count The count of 32-bit double words to read.
+extern void ReadFromPortBlock32(uint16_t port, void *buffer, uint32_t count);
+
+//! @brief Writes a block of words to a 16-bit I/O port.
+//! @param[in] port The index of the port to write to.
+//! @param[in] buffer The words to write.
+//! @param[in] count The count of 16-bit words to write.
+extern void WriteToPortBlock16(uint16_t port, const void *buffer, uint32_t count);
+
+//! @brief The IDT entry point for IRQ 14, the primary ATA channel.
+extern void HardwareIrq14Entry(void);
+
+//! @brief The IDT entry point for IRQ 15, the secondary ATA channel.
+extern void HardwareIrq15Entry(void);
+
 //! @brief Switches to a 32-bit stack and calls the kernel entry point.
 //! @param[in] kernelEntryPoint The virtual address of the entry point to
 //! the kernel to call after the stack switch.
@@ -216,6 +282,10 @@ extern void EnterKernel32(void *kernelEntryPoint,
                           void *kernelStackPtr,
                           /* Environment */ void *kernelEnv);
 
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
 #endif /* ifndef __ASM__ */
 
 
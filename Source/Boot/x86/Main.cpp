@@ -13,16 +13,96 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include <stddef.h>
 
+#include "BootDevice.hpp"
+#include "BootUtils.hpp"
 #include "Loader.hpp"
+#include "LoaderMemory.hpp"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Macro Definitions
 ///////////////////////////////////////////////////////////////////////////////
 
 namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The most memory map entries which can be held once the map
+//! reported by the 16-bit loader has been consolidated.
+constexpr size_t MaxMemoryMapEntries = 64;
+
+//! @brief The most memory the boot-time heap will take from usable RAM.
+constexpr size_t LoaderHeapSize = 0x400000;
+
+//! @brief The size of the pool at the top of the heap which services
+//! operator new and delete.
+constexpr size_t LoaderPoolSize = 0x100000;
+
+//! @brief The consolidated memory map, with slack for regions split by
+//! overlapping entries.
+MemMapEntry memoryMapEntries[MaxMemoryMapEntries];
+
+//! @brief The description of the free frame bitmap passed on to the kernel.
+FrameBitmap freeFrameBitmap;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Local Function Definitions
 ///////////////////////////////////////////////////////////////////////////////
+//! @brief Consolidates the memory map reported by the 16-bit loader.
+//! @param[in] boot The boot information holding the raw memory map.
+//! @param[out] memoryMap The memory map object to initialise.
+//! @retval true The memory map was consolidated into memoryMapEntries.
+//! @retval false The raw memory map was missing or too large.
+bool createMemoryMap(const BootInfo *boot, MemoryMap &memoryMap)
+{
+    size_t count = boot->MemoryMapCount;
+
+    if ((boot->MemoryMap == nullptr) || (count > MaxMemoryMapEntries))
+        return false;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        memoryMapEntries[i] = boot->MemoryMap[i];
+    }
+
+    return memoryMap.initialise(memoryMapEntries, count, MaxMemoryMapEntries);
+}
+
+//! @brief Creates the boot-time heap in the largest block of usable RAM.
+//! @param[in] memoryMap The consolidated memory map to reserve the heap in.
+//! @param[out] heap The heap to create.
+//! @retval true The heap was created and now services operator new.
+//! @retval false There was no room for a heap, so dynamic allocation is
+//! unavailable.
+bool createLoaderHeap(MemoryMap &memoryMap, Heap &heap)
+{
+    if ((heap.initialise(memoryMap, LoaderHeapSize) == false) ||
+        (heap.createPool(LoaderPoolSize) == false))
+    {
+        return false;
+    }
+
+    setLoaderHeap(&heap);
+
+    return true;
+}
+
+//! @brief Returns the unused part of the heap to the memory map and marks
+//! its frames as free.
+//! @param[in] memoryMap The memory map the heap was reserved in.
+//! @param[in] heap The heap to commit.
+//! @param[in] frames The frame allocator, or nullptr if there isn't one.
+void commitLoaderHeap(MemoryMap &memoryMap, Heap &heap, FrameAllocator *frames)
+{
+    constexpr uint64_t FrameMask = FrameAllocator::FrameSize - 1;
+    uint64_t unusedBase = (heap.getBaseAddress() + heap.getUsedSize() + FrameMask) & ~FrameMask;
+    uint64_t unusedEnd = heap.getBaseAddress() + heap.getCapacity();
+
+    if (heap.commit(memoryMap) && (frames != nullptr) && (unusedEnd > unusedBase))
+    {
+        frames->free(unusedBase,
+                     static_cast<size_t>((unusedEnd - unusedBase) >> FrameAllocator::FrameSizePow2));
+    }
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 // Local Data Type Definitions
@@ -42,7 +122,18 @@ extern "C" void main(BootInfo *boot)
     constexpr size_t BufferPitch = 80 * 2;
     char *videoBuffer = reinterpret_cast<char *>(0xB8000);
     const char message[] = "Hello World!";
+    MemoryMap memoryMap;
+    Heap heap;
+    FrameAllocator frameAllocator;
 
+    // Create the heap which services dynamic memory allocation and the
+    // bitmap of free physical page frames.
+    bool hasMemoryMap = createMemoryMap(boot, memoryMap);
+    bool hasHeap = hasMemoryMap && createLoaderHeap(memoryMap, heap);
+    bool hasFrames = hasMemoryMap && frameAllocator.initialise(memoryMap);
+
+    // Use a native driver for the boot device if possible.
+    selectBootDriver(boot, reinterpret_cast<void *>(0x60000));
 
     // Read from the boot device.
     boot->DeviceInfo->ReadBootSectors(reinterpret_cast<void *>(0x60000),
@@ -57,6 +148,29 @@ extern "C" void main(BootInfo *boot)
     {
         videoBuffer[i * 2] = message[i];
     }
+
+    // Pass the heap statistics on before control passes to the kernel.
+    publishHeapStats(boot);
+
+    // Keep the memory allocated from the heap, including the statistics,
+    // reserved in the memory map the kernel receives.
+    if (hasHeap)
+    {
+        commitLoaderHeap(memoryMap, heap, hasFrames ? &frameAllocator : nullptr);
+    }
+
+    // Pass on the bitmap, which is reserved as usable after boot in the map.
+    if (hasFrames)
+    {
+        frameAllocator.getBitmapInfo(freeFrameBitmap);
+        boot->FreeFrames = &freeFrameBitmap;
+    }
+
+    if (hasMemoryMap)
+    {
+        boot->MemoryMap = memoryMapEntries;
+        boot->MemoryMapCount = static_cast<uint16_t>(memoryMap.getRegionCount());
+    }
 }
 
 
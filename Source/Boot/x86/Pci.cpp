@@ -0,0 +1,192 @@
+//! @file Pci.cpp
+//! @brief The definition of functions which access PCI configuration space.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "Loader_x86.h"
+#include "Pci.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The ports of configuration access mechanism #1.
+constexpr uint16_t ConfigAddressPort = 0xCF8;
+constexpr uint16_t ConfigDataPort = 0xCFC;
+
+//! @brief The bit set in the configuration address to enable access.
+constexpr uint32_t ConfigEnable = 0x80000000;
+
+//! @brief The bit in the header type which marks a multi-function device.
+constexpr uint8_t MultiFunctionDevice = 0x80;
+
+//! @brief The vendor ID read from functions which aren't present.
+constexpr uint16_t NoVendor = 0xFFFF;
+
+//! @brief The count of functions addressable on all buses.
+constexpr uint32_t FunctionCount = 256 * 32 * 8;
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Selects the 32-bit configuration register containing a field.
+void selectConfigRegister(const PciAddress &address, PciConfig field)
+{
+    WriteToPort32(ConfigAddressPort, ConfigEnable |
+                                     (static_cast<uint32_t>(address.Bus) << 16) |
+                                     (static_cast<uint32_t>(address.Device & 0x1F) << 11) |
+                                     (static_cast<uint32_t>(address.Function & 0x07) << 8) |
+                                     (static_cast<uint32_t>(field) & 0xFC));
+}
+
+//! @brief Converts a scanner index into the address of a function.
+PciAddress toAddress(uint32_t index)
+{
+    return PciAddress{ static_cast<uint8_t>(index >> 8),
+                       static_cast<uint8_t>((index >> 3) & 0x1F),
+                       static_cast<uint8_t>(index & 0x07) };
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// PciScanner Member Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Finds the next function with a specific class of device.
+//! @param[in] classCode The base class of the function, e.g. 0x01 for mass
+//! storage controllers.
+//! @param[in] subClass The sub-class of the function, e.g. 0x01 for IDE.
+//! @param[out] address Receives the address of the function found.
+//! @retval true A matching function was found.
+//! @retval false There were no more matching functions.
+bool PciScanner::findNext(uint8_t classCode, uint8_t subClass, PciAddress &address)
+{
+    while (findNextPresent(address))
+    {
+        if ((readPciConfig8(address, PciConfig::ClassCode) == classCode) &&
+            (readPciConfig8(address, PciConfig::SubClass) == subClass))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! @brief Finds the next function with a specific vendor and device ID.
+//! @param[in] vendorId The ID of the manufacturer of the device.
+//! @param[in] deviceId The vendor-specific ID of the device.
+//! @param[out] address Receives the address of the function found.
+//! @retval true A matching function was found.
+//! @retval false There were no more matching functions.
+bool PciScanner::findNextDevice(uint16_t vendorId, uint16_t deviceId, PciAddress &address)
+{
+    while (findNextPresent(address))
+    {
+        if ((readPciConfig16(address, PciConfig::VendorId) == vendorId) &&
+            (readPciConfig16(address, PciConfig::DeviceId) == deviceId))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! @brief Finds the next function which is present on any bus.
+bool PciScanner::findNextPresent(PciAddress &address)
+{
+    while (_nextIndex < FunctionCount)
+    {
+        address = toAddress(_nextIndex);
+
+        if (readPciConfig16(address, PciConfig::VendorId) == NoVendor)
+        {
+            // If function 0 is absent, so is the rest of the device.
+            _nextIndex += (address.Function == 0) ? 8 : 1;
+            continue;
+        }
+
+        if ((address.Function == 0) &&
+            ((readPciConfig8(address, PciConfig::HeaderType) & MultiFunctionDevice) == 0))
+        {
+            _nextIndex += 8;
+        }
+        else
+        {
+            ++_nextIndex;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Stand-Alone Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Reads a 32-bit configuration field.
+uint32_t readPciConfig32(const PciAddress &address, PciConfig field)
+{
+    selectConfigRegister(address, field);
+
+    return ReadFromPort32(ConfigDataPort);
+}
+
+//! @brief Reads a 16-bit configuration field.
+uint16_t readPciConfig16(const PciAddress &address, PciConfig field)
+{
+    selectConfigRegister(address, field);
+
+    return ReadFromPort16(ConfigDataPort + (static_cast<uint16_t>(field) & 0x02));
+}
+
+//! @brief Reads an 8-bit configuration field.
+uint8_t readPciConfig8(const PciAddress &address, PciConfig field)
+{
+    selectConfigRegister(address, field);
+
+    return ReadFromPort8(ConfigDataPort + (static_cast<uint16_t>(field) & 0x03));
+}
+
+//! @brief Writes a 32-bit configuration field.
+void writePciConfig32(const PciAddress &address, PciConfig field, uint32_t value)
+{
+    selectConfigRegister(address, field);
+    WriteToPort32(ConfigDataPort, value);
+}
+
+//! @brief Writes a 16-bit configuration field.
+void writePciConfig16(const PciAddress &address, PciConfig field, uint16_t value)
+{
+    selectConfigRegister(address, field);
+    WriteToPort16(ConfigDataPort + (static_cast<uint16_t>(field) & 0x02), value);
+}
+
+//! @brief Sets bits in the command register of a function to enable the
+//! resources it needs.
+//! @param[in] address The function to enable.
+//! @param[in] commandBits A combination of the PciCommand* bits to set.
+void enablePciFunction(const PciAddress &address, uint16_t commandBits)
+{
+    uint16_t command = readPciConfig16(address, PciConfig::Command);
+
+    if ((command & commandBits) != commandBits)
+    {
+        writePciConfig16(address, PciConfig::Command, command | commandBits);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,109 @@
+//! @file Pci.hpp
+//! @brief The declaration of functions which access PCI configuration space.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_PCI_HPP__
+#define __BOOT_PCI_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Data Type Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief Identifies a function of a device on a PCI bus.
+struct PciAddress
+{
+    uint8_t Bus;
+    uint8_t Device;
+    uint8_t Function;
+};
+
+//! @brief Offsets of fields common to all PCI configuration space headers.
+enum class PciConfig : uint8_t
+{
+    VendorId = 0x00,
+    DeviceId = 0x02,
+    Command = 0x04,
+    Status = 0x06,
+    ProgInterface = 0x09,
+    SubClass = 0x0A,
+    ClassCode = 0x0B,
+    HeaderType = 0x0E,
+    Bar0 = 0x10,
+    Bar1 = 0x14,
+    Bar2 = 0x18,
+    Bar3 = 0x1C,
+    Bar4 = 0x20,
+    Bar5 = 0x24,
+    InterruptLine = 0x3C,
+};
+
+//! @brief The bit in the PCI command register which enables I/O space decoding.
+constexpr uint16_t PciCommandIoSpace = 0x0001;
+
+//! @brief The bit in the PCI command register which enables memory space decoding.
+constexpr uint16_t PciCommandMemorySpace = 0x0002;
+
+//! @brief The bit in the PCI command register which allows bus mastering.
+constexpr uint16_t PciCommandBusMaster = 0x0004;
+
+//! @brief The PCI class of mass storage controllers.
+constexpr uint8_t PciClassMassStorage = 0x01;
+
+//! @brief The PCI sub-class of IDE controllers.
+constexpr uint8_t PciSubClassIde = 0x01;
+
+//! @brief The PCI sub-class of SATA controllers.
+constexpr uint8_t PciSubClassSata = 0x06;
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which enumerates the functions of the devices on all
+//! PCI buses in turn.
+class PciScanner
+{
+public:
+    // Construction/Destruction
+    //! @brief Constructs a scanner which starts at the first function.
+    constexpr PciScanner() :
+        _nextIndex(0)
+    {
+    }
+
+    // Operations
+    bool findNext(uint8_t classCode, uint8_t subClass, PciAddress &address);
+    bool findNextDevice(uint16_t vendorId, uint16_t deviceId, PciAddress &address);
+
+private:
+    // Internal Functions
+    bool findNextPresent(PciAddress &address);
+
+    // Internal Fields
+    uint32_t _nextIndex;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+uint32_t readPciConfig32(const PciAddress &address, PciConfig field);
+uint16_t readPciConfig16(const PciAddress &address, PciConfig field);
+uint8_t readPciConfig8(const PciAddress &address, PciConfig field);
+void writePciConfig32(const PciAddress &address, PciConfig field, uint32_t value);
+void writePciConfig16(const PciAddress &address, PciConfig field, uint16_t value);
+void enablePciFunction(const PciAddress &address, uint16_t commandBits);
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////
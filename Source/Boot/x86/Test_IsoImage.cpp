@@ -12,8 +12,13 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <gtest/gtest.h>
 
+#include <iterator>
+#include <string>
+#include <vector>
+
 #include "Loader.hpp"
 #include "BootUtils.hpp"
+#include "Test_TargetTools.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Macro Definitions
@@ -23,6 +28,266 @@ namespace {
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data Types
 ////////////////////////////////////////////////////////////////////////////////
+//! @brief A file or directory to lay out in a synthetic ISO9660 image.
+struct IsoNode
+{
+    std::string Name;
+    std::vector<uint8_t> Data;
+    std::vector<IsoNode> Children;
+    bool IsDirectory;
+    uint32_t Block;
+    uint32_t Size;
+
+    //! @brief Creates a file whose bytes are derived from a seed.
+    static IsoNode file(const std::string &name, uint32_t size, uint8_t seed)
+    {
+        IsoNode node = { name, std::vector<uint8_t>(size), {}, false, 0, size };
+
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            node.Data[i] = static_cast<uint8_t>(seed + (i * 7));
+        }
+
+        return node;
+    }
+
+    //! @brief Creates a directory.
+    static IsoNode directory(const std::string &name, std::vector<IsoNode> children)
+    {
+        return { name, {}, std::move(children), true, 0, 0 };
+    }
+};
+
+//! @brief Builds a minimal ISO9660 image with 2 KB logical blocks.
+class IsoBuilder
+{
+public:
+    static constexpr uint32_t BlockSize = 2048;
+    static constexpr uint32_t PvdBlock = 16;
+
+    //! @brief Lays out a directory tree after the volume descriptors.
+    static std::vector<uint8_t> build(IsoNode &root)
+    {
+        uint32_t nextBlock = PvdBlock + 2;
+
+        assignBlocks(root, nextBlock);
+
+        std::vector<uint8_t> image(static_cast<size_t>(nextBlock) * BlockSize, 0);
+        uint8_t *pvd = image.data() + (PvdBlock * BlockSize);
+
+        pvd[0] = 1;
+        std::copy_n("CD001", 5, pvd + 1);
+        pvd[6] = 1;
+        writeBothEndian32(pvd + 80, nextBlock);
+        writeBothEndian16(pvd + 128, static_cast<uint16_t>(BlockSize));
+        writeRecord(pvd + 156, std::string(1, '\0'), root);
+
+        // The volume descriptor set terminator.
+        uint8_t *terminator = pvd + BlockSize;
+        terminator[0] = 0xFF;
+        std::copy_n("CD001", 5, terminator + 1);
+        terminator[6] = 1;
+
+        writeNode(image, root, root);
+
+        return image;
+    }
+
+    //! @brief Calculates the length of a directory record with a name.
+    static uint32_t getRecordLength(const std::string &name)
+    {
+        uint32_t length = 33 + static_cast<uint32_t>(name.size());
+
+        return length + (length & 1);
+    }
+
+private:
+    static void writeBothEndian16(uint8_t *bytes, uint16_t value)
+    {
+        bytes[0] = bytes[3] = static_cast<uint8_t>(value);
+        bytes[1] = bytes[2] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static void writeBothEndian32(uint8_t *bytes, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            bytes[i] = bytes[7 - i] = static_cast<uint8_t>(value >> (i * 8));
+        }
+    }
+
+    //! @brief Calculates the size of a directory, padding records which
+    //! would cross a block boundary onto the next block.
+    static uint32_t getDirectorySize(const IsoNode &directory)
+    {
+        uint32_t size = 0;
+        auto addRecord = [&size](const std::string &name) {
+            uint32_t length = getRecordLength(name);
+
+            if (((size % BlockSize) + length) > BlockSize)
+            {
+                size = ((size / BlockSize) + 1) * BlockSize;
+            }
+
+            size += length;
+        };
+
+        addRecord(std::string(1, '\0'));
+        addRecord(std::string(1, '\1'));
+
+        for (const IsoNode &child : directory.Children)
+        {
+            addRecord(child.Name);
+        }
+
+        return ((size + BlockSize - 1) / BlockSize) * BlockSize;
+    }
+
+    static void assignBlocks(IsoNode &node, uint32_t &nextBlock)
+    {
+        node.Block = nextBlock;
+
+        if (node.IsDirectory)
+        {
+            node.Size = getDirectorySize(node);
+        }
+
+        nextBlock += (node.Size + BlockSize - 1) / BlockSize;
+
+        for (IsoNode &child : node.Children)
+        {
+            assignBlocks(child, nextBlock);
+        }
+    }
+
+    static void writeRecord(uint8_t *record, const std::string &name, const IsoNode &node)
+    {
+        record[0] = static_cast<uint8_t>(getRecordLength(name));
+        writeBothEndian32(record + 2, node.Block);
+        writeBothEndian32(record + 10, node.Size);
+        record[25] = node.IsDirectory ? 0x02 : 0x00;
+        writeBothEndian16(record + 28, 1);
+        record[32] = static_cast<uint8_t>(name.size());
+        std::copy(name.begin(), name.end(), record + 33);
+    }
+
+    static void writeNode(std::vector<uint8_t> &image, const IsoNode &node,
+                          const IsoNode &parent)
+    {
+        uint8_t *extent = image.data() + (static_cast<size_t>(node.Block) * BlockSize);
+
+        if (node.IsDirectory == false)
+        {
+            std::copy(node.Data.begin(), node.Data.end(), extent);
+            return;
+        }
+
+        uint32_t offset = 0;
+        auto addRecord = [&](const std::string &name, const IsoNode &target) {
+            uint32_t length = getRecordLength(name);
+
+            if (((offset % BlockSize) + length) > BlockSize)
+            {
+                offset = ((offset / BlockSize) + 1) * BlockSize;
+            }
+
+            writeRecord(extent + offset, name, target);
+            offset += length;
+        };
+
+        addRecord(std::string(1, '\0'), node);
+        addRecord(std::string(1, '\1'), parent);
+
+        for (const IsoNode &child : node.Children)
+        {
+            addRecord(child.Name, child);
+        }
+
+        for (const IsoNode &child : node.Children)
+        {
+            writeNode(image, child, node);
+        }
+    }
+};
+
+class IsoImageTest : public BootDeviceTest
+{
+protected:
+    IsoNode _root;
+
+public:
+    void SetUp() override
+    {
+        BootDeviceTest::SetUp();
+
+        std::vector<IsoNode> manyFiles;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            manyFiles.push_back(IsoNode::file("FILE" + std::to_string(i) + ".DAT;1",
+                                              16 + i, static_cast<uint8_t>(i)));
+        }
+
+        _root = IsoNode::directory("", {
+            IsoNode::file("README.TXT;1", 100, 1),
+            IsoNode::file("NOEXT.;1", 10, 2),
+            IsoNode::directory("BOOT", {
+                IsoNode::file("KERNEL.ELF;1", 20000, 3),
+                IsoNode::directory("DRIVERS", {
+                    IsoNode::file("ATA.SYS;1", 4096, 4),
+                }),
+            }),
+            IsoNode::directory("MANY", std::move(manyFiles)),
+        });
+
+        Image = IsoBuilder::build(_root);
+        DeviceSectorSizePow2 = 11;
+    }
+
+    //! @brief Creates a description of a device holding the image.
+    static BootDeviceInfo createDevice(uint8_t sectorSizePow2)
+    {
+        BootDeviceInfo device = {};
+
+        DeviceSectorSizePow2 = sectorSizePow2;
+        device.TotalSectorCount = Image.size() >> sectorSizePow2;
+        device.BootSector = (IsoBuilder::PvdBlock * IsoBuilder::BlockSize) >> sectorSizePow2;
+        device.ReadBootSectors = readSectors;
+        device.DeviceType = (sectorSizePow2 == 11) ? BootDeviceType::CdRom :
+                                                     BootDeviceType::HardDisk;
+        device.SectorSizePow2 = sectorSizePow2;
+
+        return device;
+    }
+
+    //! @brief Verifies a file can be found and read in a single device call.
+    ::testing::AssertionResult expectFile(IsoImage &specimen, const char *path,
+                                          const IsoNode &expected)
+    {
+        IsoFileInfo file;
+
+        if (specimen.findFile(path, file) == false)
+            return ::testing::AssertionFailure() << "Failed to find '" << path << "'.";
+
+        if (file.IsDirectory || (file.Size != expected.Size))
+            return ::testing::AssertionFailure() << "'" << path << "' has the wrong type or size.";
+
+        std::vector<uint8_t> buffer(static_cast<size_t>(specimen.getSectorCount(file)) <<
+                                    DeviceSectorSizePow2);
+        size_t readCount = Reads.size();
+
+        if (specimen.readFile(file, buffer.data()) != expected.Size)
+            return ::testing::AssertionFailure() << "Failed to read '" << path << "'.";
+
+        if (Reads.size() != (readCount + 1))
+            return ::testing::AssertionFailure() << "'" << path << "' took more than one read.";
+
+        if (std::equal(expected.Data.begin(), expected.Data.end(), buffer.begin()) == false)
+            return ::testing::AssertionFailure() << "'" << path << "' has the wrong contents.";
+
+        return ::testing::AssertionSuccess();
+    }
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 // Local Data
@@ -31,10 +296,198 @@ namespace {
 ////////////////////////////////////////////////////////////////////////////////
 // Unit Tests
 ////////////////////////////////////////////////////////////////////////////////
+TEST_F(IsoImageTest, FailsWithoutVolumeDescriptor)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+    IsoFileInfo file;
+
+    std::fill(Image.begin(), Image.end(), 0);
+
+    EXPECT_FALSE(specimen.initialise(_heap, device));
+    EXPECT_FALSE(specimen.isValid());
+    EXPECT_FALSE(specimen.findFile("/README.TXT", file));
+}
+
+TEST_F(IsoImageTest, FailsWithBadParameters)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+
+    device.ReadBootSectors = nullptr;
+    EXPECT_FALSE(specimen.initialise(_heap, device));
+
+    device = createDevice(12);
+    EXPECT_FALSE(specimen.initialise(_heap, device));
+
+    device = createDevice(11);
+    EXPECT_FALSE(specimen.initialise(_heap, device, 0));
+    EXPECT_TRUE(specimen.initialise(_heap, device));
+    EXPECT_FALSE(specimen.initialise(_heap, device));
+}
+
+TEST_F(IsoImageTest, ParsesPrimaryVolumeDescriptor)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    EXPECT_TRUE(specimen.isValid());
+    EXPECT_EQ(specimen.getBlockSize(), IsoBuilder::BlockSize);
+    EXPECT_EQ(specimen.getVolumeBlockCount(), Image.size() / IsoBuilder::BlockSize);
+    EXPECT_EQ(specimen.getDirectoryCount(), 0u);
+}
+
+TEST_F(IsoImageTest, FindsFilesInRootDirectory)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    EXPECT_TRUE(expectFile(specimen, "/README.TXT", _root.Children[0]));
+    EXPECT_TRUE(expectFile(specimen, "readme.txt", _root.Children[0]));
+    EXPECT_TRUE(expectFile(specimen, "/README.TXT;1", _root.Children[0]));
+    EXPECT_TRUE(expectFile(specimen, "/noext", _root.Children[1]));
+}
+
+TEST_F(IsoImageTest, FindsFilesInSubDirectories)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+    const IsoNode &boot = _root.Children[2];
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    EXPECT_TRUE(expectFile(specimen, "/BOOT/KERNEL.ELF", boot.Children[0]));
+    EXPECT_TRUE(expectFile(specimen, "/boot/drivers/ata.sys", boot.Children[1].Children[0]));
+    EXPECT_TRUE(expectFile(specimen, "//BOOT/./DRIVERS//ATA.SYS", boot.Children[1].Children[0]));
+    EXPECT_EQ(specimen.getDirectoryCount(), 3u);
+}
+
+TEST_F(IsoImageTest, FindsDirectories)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+    IsoFileInfo file;
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    ASSERT_TRUE(specimen.findFile("/", file));
+    EXPECT_TRUE(file.IsDirectory);
+    EXPECT_EQ(file.StartSector, _root.Block);
 
-// TODO: Create tests for finding and loading files from an ISO image.
+    ASSERT_TRUE(specimen.findFile("/BOOT/DRIVERS", file));
+    EXPECT_TRUE(file.IsDirectory);
+    EXPECT_EQ(file.StartSector, _root.Children[2].Children[1].Block);
+    EXPECT_EQ(file.Size, IsoBuilder::BlockSize);
+}
+
+TEST_F(IsoImageTest, FailsToFindMissingFiles)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+    IsoFileInfo file;
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    EXPECT_FALSE(specimen.findFile("/MISSING.TXT", file));
+    EXPECT_FALSE(specimen.findFile("/README", file));
+    EXPECT_FALSE(specimen.findFile("/README.TXTX", file));
+    EXPECT_FALSE(specimen.findFile("/BOOT/README.TXT", file));
+    EXPECT_FALSE(specimen.findFile("/README.TXT/KERNEL.ELF", file));
+    EXPECT_FALSE(specimen.findFile(nullptr, file));
+}
+
+TEST_F(IsoImageTest, ReadsDirectorySectorsOnce)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+    IsoFileInfo file;
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    Reads.clear();
+
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        ASSERT_TRUE(specimen.findFile("/BOOT/KERNEL.ELF", file));
+        ASSERT_TRUE(specimen.findFile("/BOOT/DRIVERS/ATA.SYS", file));
+        ASSERT_TRUE(specimen.findFile("/README.TXT", file));
+        ASSERT_TRUE(specimen.findFile("/MANY/FILE99.DAT", file));
+        ASSERT_FALSE(specimen.findFile("/MANY/FILE100.DAT", file));
+    }
+
+    // Each directory is read in full by a single call.
+    const IsoNode *directories[] = {
+        &_root, &_root.Children[2], &_root.Children[2].Children[1], &_root.Children[3],
+    };
+
+    ASSERT_EQ(Reads.size(), std::size(directories));
+    uint32_t sectorCount = 0;
+
+    for (size_t i = 0; i < Reads.size(); ++i)
+    {
+        EXPECT_EQ(Reads[i].StartSector, directories[i]->Block);
+        EXPECT_EQ(Reads[i].SectorCount, directories[i]->Size / IsoBuilder::BlockSize);
+        sectorCount += Reads[i].SectorCount;
+    }
+
+    EXPECT_EQ(specimen.getDirectorySectorsRead(), sectorCount);
+    EXPECT_EQ(specimen.getDirectoryCount(), 4u);
+}
+
+TEST_F(IsoImageTest, FindsAllEntriesOfMultiBlockDirectory)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+    const IsoNode &many = _root.Children[3];
+
+    // Use a small table so that names share chains.
+    ASSERT_GT(many.Size, IsoBuilder::BlockSize);
+    ASSERT_TRUE(specimen.initialise(_heap, device, 4));
+
+    for (const IsoNode &child : many.Children)
+    {
+        std::string path = "/MANY/" + child.Name;
+
+        EXPECT_TRUE(expectFile(specimen, path.c_str(), child));
+    }
+}
+
+TEST_F(IsoImageTest, ReadsHardDiskSectors)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(9);
+    const IsoNode &kernel = _root.Children[2].Children[0];
+    IsoFileInfo file;
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    ASSERT_EQ(Reads.size(), 1u);
+    EXPECT_EQ(Reads[0].StartSector, IsoBuilder::PvdBlock * 4);
+    EXPECT_EQ(Reads[0].SectorCount, 4u);
+
+    ASSERT_TRUE(specimen.findFile("/BOOT/KERNEL.ELF", file));
+    EXPECT_EQ(file.StartSector, static_cast<uint64_t>(kernel.Block) * 4);
+    EXPECT_EQ(specimen.getSectorCount(file), (kernel.Size + 511) / 512);
+    EXPECT_TRUE(expectFile(specimen, "/BOOT/KERNEL.ELF", kernel));
+    EXPECT_TRUE(expectFile(specimen, "/README.TXT", _root.Children[0]));
+}
+
+TEST_F(IsoImageTest, ReportsPartialFileReads)
+{
+    IsoImage specimen;
+    BootDeviceInfo device = createDevice(11);
+    const IsoNode &kernel = _root.Children[2].Children[0];
+    IsoFileInfo file;
+
+    ASSERT_TRUE(specimen.initialise(_heap, device));
+    ASSERT_TRUE(specimen.findFile("/BOOT/KERNEL.ELF", file));
+
+    // Truncate the image part way through the file.
+    Image.resize((static_cast<size_t>(kernel.Block) + 2) * IsoBuilder::BlockSize);
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(specimen.getSectorCount(file)) <<
+                                DeviceSectorSizePow2);
+
+    EXPECT_EQ(specimen.readFile(file, buffer.data()), 2 * IsoBuilder::BlockSize);
+}
 
 } // Anonymous namespace
 
 ////////////////////////////////////////////////////////////////////////////////
-
@@ -0,0 +1,437 @@
+//! @file VirtioBlockDevice.cpp
+//! @brief The definition of an object which reads from a legacy virtio
+//! block device, as provided by QEMU/KVM.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependency Header File Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "Loader_x86.h"
+#include "VirtioBlockDevice.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Macro Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+// Local Data Type Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief An entry in the descriptor table of a split virtqueue.
+struct VirtqDescriptor
+{
+    uint64_t Address;
+    uint32_t Length;
+    uint16_t Flags;
+    uint16_t Next;
+};
+
+//! @brief The ring of descriptor chains made available to the device.
+struct VirtqAvailable
+{
+    uint16_t Flags;
+    uint16_t Index;
+    uint16_t Ring[VirtioBlockDevice::MaxQueueSize];
+};
+
+//! @brief An entry in the ring of descriptor chains the device has used.
+struct VirtqUsedElement
+{
+    uint32_t Id;
+    uint32_t Length;
+};
+
+//! @brief The ring of descriptor chains the device has finished with.
+struct VirtqUsed
+{
+    uint16_t Flags;
+    uint16_t Index;
+    VirtqUsedElement Ring[VirtioBlockDevice::MaxQueueSize];
+};
+
+//! @brief The header which starts every block request.
+struct BlockRequestHeader
+{
+    uint32_t Type;
+    uint32_t Priority;
+
+    //! @brief The first 512-byte sector to transfer.
+    uint64_t Sector;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Data
+///////////////////////////////////////////////////////////////////////////////
+//! @brief The offsets of the legacy registers in I/O space.
+constexpr uint16_t DeviceFeatures = 0x00;
+constexpr uint16_t DriverFeatures = 0x04;
+constexpr uint16_t QueueAddress = 0x08;
+constexpr uint16_t QueueSize = 0x0C;
+constexpr uint16_t QueueSelect = 0x0E;
+constexpr uint16_t QueueNotify = 0x10;
+constexpr uint16_t DeviceStatus = 0x12;
+constexpr uint16_t InterruptStatus = 0x13;
+
+//! @brief The offsets of the block device configuration fields, which
+//! follow the legacy registers while MSI-X is disabled.
+constexpr uint16_t ConfigCapacity = 0x14;
+constexpr uint16_t ConfigSizeMax = 0x1C;
+
+constexpr uint8_t StatusAcknowledge = 0x01;
+constexpr uint8_t StatusDriver = 0x02;
+constexpr uint8_t StatusDriverOk = 0x04;
+constexpr uint8_t StatusFailed = 0x80;
+
+//! @brief The feature which limits the size of a data descriptor.
+constexpr uint32_t FeatureSizeMax = 0x02;
+
+constexpr uint16_t DescriptorNext = 0x01;
+constexpr uint16_t DescriptorWrite = 0x02;
+constexpr uint16_t AvailableNoInterrupt = 0x01;
+
+constexpr uint32_t RequestTypeIn = 0;
+constexpr uint8_t RequestStatusOk = 0;
+constexpr uint8_t RequestStatusPending = 0xFF;
+
+//! @brief The count of descriptors in the chain of each request: the
+//! header, the data and the status.
+constexpr uint16_t DescriptorsPerRequest = 3;
+
+//! @brief The most requests queued before the device is notified.
+constexpr uint16_t MaxBatchSize = 32;
+
+//! @brief The most bytes transferred by a single request.
+constexpr uint32_t MaxBytesPerRequest = 0x100000;
+
+//! @brief The size of sectors the device addresses, as a power of 2.
+constexpr uint8_t DeviceSectorSizePow2 = 9;
+
+//! @brief The alignment of the used ring required by legacy devices.
+constexpr uint32_t QueueAlignment = 4096;
+
+//! @brief The count of times to poll a batch which isn't progressing
+//! before giving up.
+constexpr uint32_t PollLimit = 0x400000;
+
+//! @brief Calculates the offset of the used ring in a legacy virtqueue.
+constexpr uint32_t getUsedRingOffset(uint32_t queueSize)
+{
+    return ((queueSize * sizeof(VirtqDescriptor)) +
+            ((3 + queueSize) * sizeof(uint16_t)) + QueueAlignment - 1) &
+           ~(QueueAlignment - 1);
+}
+
+//! @brief Calculates the size of a legacy virtqueue.
+constexpr uint32_t getQueueMemorySize(uint32_t queueSize)
+{
+    return getUsedRingOffset(queueSize) + (3 * sizeof(uint16_t)) +
+           (queueSize * sizeof(VirtqUsedElement));
+}
+
+//! @brief The memory shared with the device holding the virtqueue.
+alignas(QueueAlignment) uint8_t queueMemory[getQueueMemorySize(VirtioBlockDevice::MaxQueueSize)];
+
+//! @brief The headers of the requests in a batch.
+BlockRequestHeader requestHeaders[MaxBatchSize];
+
+//! @brief The status bytes written by the device for the requests in a batch.
+uint8_t requestStatuses[MaxBatchSize];
+
+///////////////////////////////////////////////////////////////////////////////
+// Local Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stops the compiler moving accesses to memory shared with the
+//! device past accesses to its registers.
+inline void memoryBarrier() { __asm__ volatile("" ::: "memory"); }
+
+//! @brief Gets the physical address of an object in memory.
+uint32_t getPhysicalAddress(const void *data)
+{
+    // The loader runs with paging disabled.
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(data));
+}
+
+//! @brief Gets the descriptor table at the start of the virtqueue.
+VirtqDescriptor *getDescriptors()
+{
+    return reinterpret_cast<VirtqDescriptor *>(queueMemory);
+}
+
+//! @brief Gets the available ring which follows the descriptor table.
+VirtqAvailable *getAvailableRing(uint16_t queueSize)
+{
+    return reinterpret_cast<VirtqAvailable *>(queueMemory +
+                                              (queueSize * sizeof(VirtqDescriptor)));
+}
+
+//! @brief Gets the used ring, which the device updates, on the next page
+//! boundary after the available ring.
+volatile VirtqUsed *getUsedRing(uint16_t queueSize)
+{
+    return reinterpret_cast<volatile VirtqUsed *>(queueMemory + getUsedRingOffset(queueSize));
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// VirtioBlockDevice Member Function Definitions
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Determines whether the device is ready to read.
+bool VirtioBlockDevice::isValid() const { return _queueSize != 0; }
+
+//! @brief Gets the size of the sectors the object reads as a power of 2.
+uint8_t VirtioBlockDevice::getSectorSizePow2() const { return _sectorSizePow2; }
+
+//! @brief Gets the count of whole sectors on the device.
+uint64_t VirtioBlockDevice::getSectorCount() const
+{
+    return _capacity >> (_sectorSizePow2 - DeviceSectorSizePow2);
+}
+
+//! @brief Resets a virtio block device and sets up its request queue.
+//! @param[in] address The address of the PCI function of the device.
+//! @param[in] sectorSizePow2 The size of the sectors to read in, as a power
+//! of 2 no smaller than the 512-byte sectors of the device.
+//! @retval true The device is ready to read.
+//! @retval false The function isn't a usable virtio block device.
+bool VirtioBlockDevice::initialise(const PciAddress &address, uint8_t sectorSizePow2)
+{
+    reset();
+
+    uint32_t bar = readPciConfig32(address, PciConfig::Bar0);
+
+    // The legacy interface is always in I/O space.
+    if ((readPciConfig16(address, PciConfig::VendorId) != VendorId) ||
+        (readPciConfig16(address, PciConfig::DeviceId) != LegacyBlockDeviceId) ||
+        ((bar & 1) == 0) || (sectorSizePow2 < DeviceSectorSizePow2) ||
+        (sectorSizePow2 > 16))
+    {
+        return false;
+    }
+
+    enablePciFunction(address, PciCommandIoSpace | PciCommandBusMaster);
+    _ioBase = static_cast<uint16_t>(bar & 0xFFFC);
+
+    // Reset the device, then announce a driver which only needs the size
+    // limit it might impose.
+    WriteToPort8(_ioBase + DeviceStatus, 0);
+    WriteToPort8(_ioBase + DeviceStatus, StatusAcknowledge);
+    WriteToPort8(_ioBase + DeviceStatus, StatusAcknowledge | StatusDriver);
+
+    uint32_t features = ReadFromPort32(_ioBase + DeviceFeatures) & FeatureSizeMax;
+    WriteToPort32(_ioBase + DriverFeatures, features);
+
+    WriteToPort16(_ioBase + QueueSelect, 0);
+    uint16_t queueSize = ReadFromPort16(_ioBase + QueueSize);
+
+    // The queue size is fixed by a legacy device and must be a power of 2.
+    if ((queueSize < DescriptorsPerRequest) || (queueSize > MaxQueueSize) ||
+        (queueSize & (queueSize - 1)))
+    {
+        WriteToPort8(_ioBase + DeviceStatus, StatusFailed);
+        return false;
+    }
+
+    for (uint8_t &value : queueMemory)
+    {
+        value = 0;
+    }
+
+    // The device needn't interrupt, completions are polled.
+    getAvailableRing(queueSize)->Flags = AvailableNoInterrupt;
+
+    WriteToPort32(_ioBase + QueueAddress, getPhysicalAddress(queueMemory) / QueueAlignment);
+
+    _capacity = ReadFromPort32(_ioBase + ConfigCapacity) |
+                (static_cast<uint64_t>(ReadFromPort32(_ioBase + ConfigCapacity + 4)) << 32);
+    _sectorSizePow2 = sectorSizePow2;
+    _maxSectorsPerRequest = MaxBytesPerRequest >> sectorSizePow2;
+
+    if (features & FeatureSizeMax)
+    {
+        uint32_t sizeMax = ReadFromPort32(_ioBase + ConfigSizeMax) >> sectorSizePow2;
+
+        if (sizeMax < _maxSectorsPerRequest)
+        {
+            _maxSectorsPerRequest = sizeMax;
+        }
+    }
+
+    if (_maxSectorsPerRequest == 0)
+    {
+        WriteToPort8(_ioBase + DeviceStatus, StatusFailed);
+        return false;
+    }
+
+    _maxBatchSize = queueSize / DescriptorsPerRequest;
+
+    if (_maxBatchSize > MaxBatchSize)
+    {
+        _maxBatchSize = MaxBatchSize;
+    }
+
+    _nextAvailable = 0;
+    _queueSize = queueSize;
+
+    WriteToPort8(_ioBase + DeviceStatus, StatusAcknowledge | StatusDriver | StatusDriverOk);
+
+    return true;
+}
+
+//! @brief Reads sectors from the device.
+//! @param[in] destination The memory to receive the sectors.
+//! @param[in] startSector The index of the first sector to read.
+//! @param[in] sectorCount The count of contiguous sectors to read.
+//! @return The count of sectors read.
+uint32_t VirtioBlockDevice::read(void *destination, uint64_t startSector,
+                                 uint32_t sectorCount)
+{
+    uint64_t sectorLimit = getSectorCount();
+
+    if ((isValid() == false) || (startSector >= sectorLimit))
+        return 0;
+
+    if ((sectorLimit - startSector) < sectorCount)
+    {
+        sectorCount = static_cast<uint32_t>(sectorLimit - startSector);
+    }
+
+    uintptr_t target = reinterpret_cast<uintptr_t>(destination);
+    uint32_t requestSizes[MaxBatchSize];
+    uint32_t sectorsRead = 0;
+
+    while (sectorsRead < sectorCount)
+    {
+        uint16_t requestCount = queueBatch(target + (static_cast<uintptr_t>(sectorsRead) << _sectorSizePow2),
+                                           startSector + sectorsRead,
+                                           sectorCount - sectorsRead, requestSizes);
+
+        if (waitForBatch(requestCount) == false)
+        {
+            // The device still owns the descriptors, so it can't be used.
+            reset();
+            break;
+        }
+
+        // Only count sectors up to the first request which failed.
+        for (uint16_t i = 0; i < requestCount; ++i)
+        {
+            if (requestStatuses[i] != RequestStatusOk)
+                return sectorsRead;
+
+            sectorsRead += requestSizes[i];
+        }
+    }
+
+    return sectorsRead;
+}
+
+//! @brief Resets the device, if in use, and marks the object as unusable.
+void VirtioBlockDevice::reset()
+{
+    if (_queueSize != 0)
+    {
+        WriteToPort8(_ioBase + DeviceStatus, 0);
+    }
+
+    _queueSize = 0;
+}
+
+//! @brief Places a batch of read requests in the available ring and
+//! notifies the device.
+//! @param[in] destination The physical address of the memory to fill.
+//! @param[in] startSector The first sector to read.
+//! @param[in] sectorCount The count of sectors left to read.
+//! @param[out] requestSizes Receives the count of sectors each request reads.
+//! @return The count of requests queued.
+uint16_t VirtioBlockDevice::queueBatch(uintptr_t destination, uint64_t startSector,
+                                       uint32_t sectorCount, uint32_t *requestSizes)
+{
+    VirtqDescriptor *descriptors = getDescriptors();
+    VirtqAvailable *available = getAvailableRing(_queueSize);
+    const uint8_t deviceSectorShift = _sectorSizePow2 - DeviceSectorSizePow2;
+    uint16_t requestCount = 0;
+
+    while ((sectorCount > 0) && (requestCount < _maxBatchSize))
+    {
+        uint32_t count = (sectorCount < _maxSectorsPerRequest) ? sectorCount :
+                                                                 _maxSectorsPerRequest;
+        uint16_t head = static_cast<uint16_t>(requestCount * DescriptorsPerRequest);
+        VirtqDescriptor *chain = descriptors + head;
+
+        requestHeaders[requestCount].Type = RequestTypeIn;
+        requestHeaders[requestCount].Priority = 0;
+        requestHeaders[requestCount].Sector = startSector << deviceSectorShift;
+        requestStatuses[requestCount] = RequestStatusPending;
+
+        chain[0].Address = getPhysicalAddress(requestHeaders + requestCount);
+        chain[0].Length = sizeof(BlockRequestHeader);
+        chain[0].Flags = DescriptorNext;
+        chain[0].Next = head + 1;
+
+        chain[1].Address = destination;
+        chain[1].Length = count << _sectorSizePow2;
+        chain[1].Flags = DescriptorNext | DescriptorWrite;
+        chain[1].Next = head + 2;
+
+        chain[2].Address = getPhysicalAddress(requestStatuses + requestCount);
+        chain[2].Length = 1;
+        chain[2].Flags = DescriptorWrite;
+        chain[2].Next = 0;
+
+        available->Ring[(_nextAvailable + requestCount) & (_queueSize - 1)] = head;
+        requestSizes[requestCount] = count;
+
+        destination += static_cast<uintptr_t>(count) << _sectorSizePow2;
+        startSector += count;
+        sectorCount -= count;
+        ++requestCount;
+    }
+
+    // Publish the descriptors before the index and the index before the
+    // notification, which x86 stores do in program order.
+    memoryBarrier();
+    _nextAvailable = static_cast<uint16_t>(_nextAvailable + requestCount);
+    available->Index = _nextAvailable;
+    memoryBarrier();
+    WriteToPort16(_ioBase + QueueNotify, 0);
+
+    return requestCount;
+}
+
+//! @brief Waits for the device to use all requests in a batch.
+//! @retval true Every request was completed, successfully or not.
+//! @retval false The device stopped responding.
+bool VirtioBlockDevice::waitForBatch(uint16_t requestCount)
+{
+    volatile VirtqUsed *used = getUsedRing(_queueSize);
+    uint16_t lastUsed = static_cast<uint16_t>(_nextAvailable - requestCount);
+    uint32_t idleCount = 0;
+
+    while (used->Index != _nextAvailable)
+    {
+        if (used->Index != lastUsed)
+        {
+            lastUsed = used->Index;
+            idleCount = 0;
+        }
+        else if (++idleCount >= PollLimit)
+        {
+            return false;
+        }
+
+        // Reading the interrupt status paces the loop with an I/O access.
+        ReadFromPort8(_ioBase + InterruptStatus);
+    }
+
+    memoryBarrier();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
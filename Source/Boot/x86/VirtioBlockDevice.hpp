@@ -0,0 +1,97 @@
+//! @file VirtioBlockDevice.hpp
+//! @brief The declaration of an object which reads from a legacy virtio
+//! block device, as provided by QEMU/KVM.
+//! @author GiantRobotLemur@na-se.co.uk
+//! @date 2024
+//! @copyright This file is part of the Helix operating system project which is
+//! released under GPL 3 license. See LICENSE file at the repository root or go
+//! to https://github.com/GiantRobotLemur/Helix for full license details.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BOOT_VIRTIO_BLOCK_DEVICE_HPP__
+#define __BOOT_VIRTIO_BLOCK_DEVICE_HPP__
+
+////////////////////////////////////////////////////////////////////////////////
+// Dependent Header Files
+////////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Pci.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Class Declarations
+////////////////////////////////////////////////////////////////////////////////
+//! @brief An object which reads from a virtio block device through the
+//! legacy I/O port interface of a legacy or transitional PCI function.
+//! @details
+//! A read is split into requests which each transfer directly into the
+//! destination. A batch of requests is placed in the split virtqueue at
+//! once and the device is notified once per batch, so a multi-megabyte
+//! read only costs a few exits to the hypervisor.
+//!
+//! The device always addresses 512-byte sectors, but the object reads in
+//! units of whatever sector size it is initialised with, so that it can
+//! stand in for a CD/DVD drive holding the same image.
+class VirtioBlockDevice
+{
+public:
+    // Public Constants
+    //! @brief The PCI vendor of virtio devices.
+    static constexpr uint16_t VendorId = 0x1AF4;
+
+    //! @brief The PCI device of a legacy or transitional block device.
+    static constexpr uint16_t LegacyBlockDeviceId = 0x1001;
+
+    //! @brief The largest queue the object can use.
+    static constexpr uint16_t MaxQueueSize = 256;
+
+    // Construction/Destruction
+    //! @brief Constructs an object which must be initialised before use.
+    constexpr VirtioBlockDevice() :
+        _capacity(0),
+        _maxSectorsPerRequest(0),
+        _ioBase(0),
+        _queueSize(0),
+        _nextAvailable(0),
+        _maxBatchSize(0),
+        _sectorSizePow2(0)
+    {
+    }
+
+    // Accessors
+    bool isValid() const;
+    uint8_t getSectorSizePow2() const;
+    uint64_t getSectorCount() const;
+
+    // Operations
+    bool initialise(const PciAddress &address, uint8_t sectorSizePow2);
+    uint32_t read(void *destination, uint64_t startSector, uint32_t sectorCount);
+    void reset();
+
+private:
+    // Internal Functions
+    uint16_t queueBatch(uintptr_t destination, uint64_t startSector,
+                        uint32_t sectorCount, uint32_t *requestSizes);
+    bool waitForBatch(uint16_t requestCount);
+
+    // Internal Fields
+    uint64_t _capacity;
+    uint32_t _maxSectorsPerRequest;
+    uint16_t _ioBase;
+    uint16_t _queueSize;
+    uint16_t _nextAvailable;
+    uint16_t _maxBatchSize;
+    uint8_t _sectorSizePow2;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Templates
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // Header guard
+////////////////////////////////////////////////////////////////////////////////